@@ -12,10 +12,62 @@ activeTest = {
 
 parameters = {
 	main = {
-		-- if math is nil or these are set to some value less
-		-- than zero, we use cstdlib's random() for both seeds
-		initRandomSeed = (math ~= nil and math.random()) or -1,
-		evalRandomSeed = (math ~= nil and math.random()) or -1,
+		-- seed from which every init- and eval-RNG seed is derived
+		-- (an integer in [0, 2^24)); if less than zero, one is picked
+		-- through cstdlib's random() and printed at startup so that
+		-- the run can be reproduced (a sharded run, see --shard,
+		-- needs one set here so that all shards use the same)
+		masterRNGSeed = -1,
+
+		-- number of worker threads that policies are learned
+		-- and evaluated on (0 means one per hardware thread)
+		numThreads = 1,
+
+		-- checkpoint each policy's learning progress every this many
+		-- episodes (0 disables checkpointing); after an interrupted run
+		-- pass --resume to continue (bit-exactly) from the checkpoints,
+		-- which needs masterRNGSeed set to the seed of that run
+		checkpointInterval = 0,
+
+		-- "off", "advise" (transparent huge pages) or "explicit" (the
+		-- reserved hugetlbfs pool, falling back to "advise"): back Q-
+		-- tables and policies of 2MB or more by huge pages, which cuts
+		-- dTLB misses on the random accesses of large tasks
+		hugePages = "off",
+
+		-- give Q-tables and policies rows only for the non-terminal
+		-- states reachable from where each learner starts (any state
+		-- if it randomizes its initial states, or if the task's state-
+		-- ID's only approximate its dynamics); all other states share
+		-- one row, which evaluation trials starting there act from; in
+		-- the "any state" cases (always for HillClimber) this leaves
+		-- out only the terminal states, which is printed at startup;
+		-- what is learned does not change (random initial action-
+		-- values follow the state-ID, not the row)
+		pruneStates = false,
+
+		-- memory (in MB) the experiment may use, 0 for no limit; the
+		-- footprint of all Q-tables, policies and reward traces is
+		-- estimated up front and if it does not fit, learners store
+		-- their action-values as "bf16" (unless already quantized; it
+		-- then always rounds stochastically) or "hashed" instead, and
+		-- fewer threads are used if checkpoint snapshots would not fit;
+		-- the decision is printed at startup (a shard plans for its own
+		-- policies only, so shards can decide differently than another
+		-- shard or an unsharded run; --merge then rejects them)
+		memoryBudget = 0,
+
+		-- learn this many policies (up to 16) together in each job, one
+		-- learner per lane (QLearning only, other learners run them in
+		-- turn); the results are identical to learning them one by one,
+		-- and it can pay off when Q-tables are much larger than the
+		-- caches
+		numLanes = 1,
+		-- how the lanes are scheduled: "lockstep" steps all episodes
+		-- together, "interleaved" advances each learner's episode by
+		-- one step in turn after prefetching its next Q-table row, so
+		-- the other lanes' steps hide that row's cache miss
+		laneScheduling = "lockstep",
 
 		test = activeTest,
 		data = "../data/",
@@ -37,6 +89,23 @@ parameters = {
 
 			minAlpha = 0.001,
 			minEpsilon = 0.001,
+
+			-- "dense" allocates action-values for every state up front,
+			-- "hashed" only stores those of visited states (for tasks
+			-- with very large |S|, eg. HillClimber at high resolution);
+			-- unvisited states read as defaultActionValue and hashed
+			-- tables do not support random initial action-values
+			--
+			-- "fp16", "bf16" and "int16" store every action-value in two
+			-- bytes instead of four (updates are still computed in fp32);
+			-- rounding is "nearest" or "stochastic" (the latter keeps small
+			-- updates to large values from being lost), int16 covers the
+			-- range [-quantizedRange, quantizedRange] in uniform steps and
+			-- fp16 saturates at +-65504
+			storage = "dense",
+			defaultActionValue = 0.0,
+			rounding = "nearest",
+			quantizedRange = 4096.0,
 		},
 	},
 
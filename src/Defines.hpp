@@ -6,6 +6,14 @@
 // #define RELAX_LOG_LEARNER
 // #define RELAX_LOG_LEARNER_EXT
 // #define RELAX_POWERSET_TEST
+// #define RELAX_RNG_BENCHMARK
+// #define RELAX_QTABLE_BENCHMARK
+// #define RELAX_QSTORAGE_BENCHMARK
+// #define RELAX_HUGEPAGE_BENCHMARK
+// #define RELAX_TASK_BENCHMARK
+// #define RELAX_INTERLEAVE_BENCHMARK
+// #define RELAX_HOGWILD_BENCHMARK
+// #define RELAX_ACTORLEARNER_BENCHMARK
 // #define RELAX_RNG_SHARED_SEEDS
 // #define RELAX_LOG_PARAMETERS
 // if enabled, serialize each policy's PI- and Q-arrays
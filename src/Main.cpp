@@ -1,17 +1,40 @@
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <cstdio>
+#include <fstream>
+#include <list>
+#include <map>
+#include <new>
+#include <sstream>
 
 #include <lua5.1/lua.hpp>
 
 #include "Defines.hpp"
 #include "Types.hpp"
+#include "learners/MemoryPlanner.hpp"
+#include "util/Arena.hpp"
+#include "util/BinaryFile.hpp"
 #include "util/LuaParser.hpp"
+#include "util/Checkpoint.hpp"
+#include "util/PageAllocator.hpp"
+#include "util/PageTemplates.hpp"
 #include "util/RandomNumberSequenceGen.hpp"
+#include "util/RandomNumberStreams.hpp"
+#include "util/RewardTraces.hpp"
 #include "util/PowerSet.hpp"
+#include "util/StateSpaceGraph.hpp"
+#include "util/ThreadPool.hpp"
+#include "util/IThreadPoolJob.hpp"
 
 using namespace RELAX;
 
+typedef Graphs::StateSpaceGraph<TState, TAction> TStateSpaceGraph;
+typedef std::map<unsigned int, Learners::StateIndex*> TStateIndexMap;
+
+// start-ID standing for "episodes may start in any state"
+static const unsigned int ALL_START_STATES = 0xFFFFFFFF;
+
 
 
 void UnitTest() {
@@ -31,52 +54,319 @@ void UnitTest() {
 
 
 
+// initializes one learner's Q and its policy's PI (either randomly
+// or deterministically, according to task-parameters); every pair
+// has its own init-RNG and random values are hashed per state from
+// a key drawn from it, so pairs can be initialized concurrently and
+// the result does not depend on the number of threads
+struct InitializeJob: public IThreadPoolJob {
+public:
+	InitializeJob(Policy* policy, Learner* learner, TRNG* initRNG, bool randomActionValues, bool randomStateActions):
+		mPolicy(policy), mLearner(learner), mInitRNG(initRNG), mRandomActionValues(randomActionValues), mRandomStateActions(randomStateActions) {
+	}
+
+	void Execute() {
+		mLearner->Initialize(mInitRNG, mRandomActionValues);
+		mPolicy->Initialize(mInitRNG, mRandomStateActions);
+	}
+
+	// tables start out as untouched zero pages, only randomizing
+	// them costs time
+	unsigned long GetCost() const {
+		return ((mRandomActionValues? (TState::GetMaxID() + 1UL) * (TAction::GetMaxID() + 1): 0) + (mRandomStateActions? (TState::GetMaxID() + 1UL): 0));
+	}
+
+private:
+	Policy* mPolicy;
+	Learner* mLearner;
+	TRNG* mInitRNG;
+
+	const bool mRandomActionValues;
+	const bool mRandomStateActions;
+};
+
+// prints how much memory the process has resident; the proportional
+// figure charges pages shared between tables (untouched zero pages
+// or template pages) only once
+void PrintResidentMemory(const char* phase) {
+	PageAllocator::ResidentMemory memory;
+
+	if (!PageAllocator::GetResidentMemory(&memory)) {
+		return;
+	}
+
+	const char* format = "[%s] resident memory %s: %.2f MB (proportional: %.2f MB, huge pages: %.2f MB)\n";
+	printf(format, __FUNCTION__, phase, memory.rssKB / 1024.0, memory.pssKB / 1024.0, memory.anonHugePagesKB / 1024.0);
+}
+
+
+
+// returns the index of the non-terminal states reachable from the state
+// with ID <startID> (or from any state, if ALL_START_STATES, which leaves
+// out only the terminal states); indices are built once per start-ID and
+// kept in <stateIndices>
+const Learners::StateIndex* GetReachableStateIndex(const TStateSpaceGraph& graph, unsigned int startID, TStateIndexMap& stateIndices) {
+	const TStateIndexMap::const_iterator it = stateIndices.find(startID);
+
+	if (it != stateIndices.end()) {
+		return (it->second);
+	}
+
+	std::vector<unsigned int> startIDs;
+	std::vector<bool> states;
+
+	if (startID == ALL_START_STATES) {
+		for (unsigned int n = 0; n <= TState::GetMaxID(); n++) {
+			startIDs.push_back(n);
+		}
+	} else {
+		startIDs.push_back(startID);
+	}
+
+	graph.GetReachableStates(startIDs, states);
+
+	Learners::StateIndex* index = new Learners::StateIndex();
+	index->Assign(states);
+
+	stateIndices[startID] = index;
+	return index;
+}
+
+
+
+// all policies and learners (the objects themselves as well as their
+// Q-tables, PI-tables and reward traces) are constructed in place in
+// <arena>, which is sized for all of them up front and allocated once
+//
+// if <templates> is non-NULL, learners that randomize their Q-tables
+// with the same key share one copy-on-write copy of it
+//
+// if <pruneStates> is true, each learner's Q-table and its policy's
+// PI-table only hold the non-terminal states reachable from where the
+// learner starts its episodes (every state if it randomizes them); the
+// indices are kept in <stateIndices>; for tasks whose state-space graph
+// is not exact (TState::EXACT_TRANSITIONS is false) every learner has
+// to be treated as starting anywhere, which only prunes terminal states
+//
+// before anything is allocated the memory of the whole experiment is
+// estimated and, if it exceeds <memoryBudget> (in bytes, zero if there
+// is none), the learners' storage mode and <numThreads> are lowered
+// until it fits (see MemoryPlanner); returns false if nothing does
+//
+// <pruneStates> is cleared if the state-space graph does not fit the
+// budget either, and <params> are the learners' parameters as planned
+// (what a shard records, see MergeBaseLineTestShards); a shard only
+// plans for its own policies, so the budget can make shards of one
+// experiment store (and learn) differently than an unsharded run
+//
+// <chosenPolicies> are the policies firstChosenPolicy, ... of the whole
+// experiment (see GetShardRange), which are given the same initial
+// states as in an unsharded run
 bool InitializeBaseLineTest(
 	const LuaTable* learnersTable,
 	const LuaTable* policiesTable,
 	TTask& task,
-	std::vector<Policy>& randomPolicies,
-	std::vector<Policy>& chosenPolicies,
-	std::vector<Learner>& randomLearners,
-	std::vector<Learner>& chosenLearners,
-	std::vector<INumberSequenceGen*>& randomInitRNGs,
-	std::vector<INumberSequenceGen*>& chosenInitRNGs,
-	std::vector<INumberSequenceGen*>& randomEvalRNGs,
-	std::vector<INumberSequenceGen*>& chosenEvalRNGs,
+	Arena& arena,
+	PageTemplates* templates,
+	TStateIndexMap& stateIndices,
+	bool& pruneStates,
+	size_t memoryBudget,
+	unsigned int checkpointInterval,
+	std::vector<Policy*>& randomPolicies,
+	std::vector<Policy*>& chosenPolicies,
+	std::vector<Learner*>& randomLearners,
+	std::vector<Learner*>& chosenLearners,
+	std::vector<TRNG*>& randomInitRNGs,
+	std::vector<TRNG*>& chosenInitRNGs,
+	std::vector<TRNG*>& randomEvalRNGs,
+	std::vector<TRNG*>& chosenEvalRNGs,
+	const RandomNumberStreams& rngStreams,
+	unsigned int firstChosenPolicy,
+	unsigned int& numThreads,
+	Learners::TDLearnerParameters& params,
 	bool weakBaseLine
 ) {
 	printf("[%s]\n", __FUNCTION__);
 
+	std::vector<InitializeJob*> jobs;
+
 	std::vector<TState> chosenStates;
 	std::vector<TState> v;
 
 	TState state;
-	MTRandomNumberSequenceGen chosenRNG(random());
+	TRNG chosenRNG(rngStreams.GetStreamSeed(RandomNumberStreams::STREAM_GROUP_TASK, 0, RandomNumberStreams::STREAM_ROLE_INIT));
 
 	if (task.GetChosenStates(chosenStates, &chosenRNG) == 0) {
 		printf("[%s] task \"%s\" has not defined any chosen predictor states!\n", __FUNCTION__, TTask::GetName());
 		return false;
 	}
 
+	if (!params.Initialize(learnersTable->GetTblVal("params"))) {
+		printf("[%s] invalid learner parameters\n", __FUNCTION__);
+		return false;
+	}
+
+	std::vector<TState> randomInitialStates(randomPolicies.size());
+	std::vector<TState> chosenInitialStates(chosenPolicies.size());
+	std::vector<const Learners::StateIndex*> randomStateIndices(randomPolicies.size(), NULL);
+	std::vector<const Learners::StateIndex*> chosenStateIndices(chosenPolicies.size(), NULL);
+
+	for (unsigned int n = 0; n < randomPolicies.size(); n++) {
+		state = state.Randomize(randomInitRNGs[n]);
+		randomInitialStates[n] = state;
+	}
+	// all chosen policies draw their initial states from one sequence,
+	// so skip the draws of those before this shard's
+	for (unsigned int n = 0; n < firstChosenPolicy; n++) {
+		chosenRNG.NextInt();
+	}
+	for (unsigned int n = 0; n < chosenPolicies.size(); n++) {
+		chosenInitialStates[n] = chosenStates[chosenRNG.NextInt() % chosenStates.size()];
+	}
+
+	// the graph is only needed (and freed again) before the tables
+	// are allocated, but must itself fit
+	if (pruneStates && memoryBudget != 0 && TStateSpaceGraph::EstimateSize() > memoryBudget) {
+		printf("[%s] state-space graph (%.2f MB) exceeds the memory budget, not pruning states\n", __FUNCTION__, TStateSpaceGraph::EstimateSize() / (1024.0 * 1024.0));
+		pruneStates = false;
+	}
+
+	if (pruneStates) {
+		const TStateSpaceGraph graph;
+
+		// if the graph is only an approximation of the task, learners
+		// could leave the states reachable (in it) from their initial
+		// state, so only the states unreachable from anywhere are pruned
+		const bool exact = TState::EXACT_TRANSITIONS;
+
+		for (unsigned int n = 0; n < randomPolicies.size(); n++) {
+			randomStateIndices[n] = GetReachableStateIndex(graph, ((weakBaseLine && exact)? randomInitialStates[n].GetID(): ALL_START_STATES), stateIndices);
+		}
+		for (unsigned int n = 0; n < chosenPolicies.size(); n++) {
+			chosenStateIndices[n] = GetReachableStateIndex(graph, (exact? chosenInitialStates[n].GetID(): ALL_START_STATES), stateIndices);
+		}
+
+		for (TStateIndexMap::const_iterator it = stateIndices.begin(); it != stateIndices.end(); ++it) {
+			const char* format = "[%s] states reachable from %s %u: %u of %u\n";
+			const char* startName = ((it->first) == ALL_START_STATES)? "any state": "state";
+
+			printf(format, __FUNCTION__, startName, (((it->first) == ALL_START_STATES)? 0: (it->first)), (it->second)->GetNumIndexedStates(), (it->second)->GetNumStates());
+		}
+
+		if (stateIndices.size() == 1 && (stateIndices.begin())->first == ALL_START_STATES) {
+			const char* reason = exact? "all learners randomize their initial states": "its state-ID's only approximate its dynamics";
+			printf("[%s] pruneStates only removes the terminal states of task \"%s\" (%s)\n", __FUNCTION__, TTask::GetName(), reason);
+		}
+	}
+
+	{
+		Learners::MemoryPlanner planner(memoryBudget);
+
+		// a learner stores at most one new hashed row per update
+		const unsigned long maxLearningEpisodes = static_cast<unsigned long>(policiesTable->GetFltVal("maxLearningEpisodes", 0.0f));
+		const unsigned int maxUpdates = std::min(maxLearningEpisodes * params.GetMaxActions(), 0xFFFFFFFFUL);
+
+		// every policy's learning checkpoint is a snapshot of its Q-table,
+		// and the writer can hold one more while the last is being saved
+		planner.SetTablesPerThread((checkpointInterval != 0)? 2: 0);
+
+		if (task.GetUseRandomInitialActionValues()) {
+			planner.DisableMode(Learners::ActionValueStorage::STORAGE_HASHED);
+		}
+
+		for (TStateIndexMap::const_iterator it = stateIndices.begin(); it != stateIndices.end(); ++it) {
+			planner.AddFixedSize((it->second)->GetSize());
+		}
+
+		for (unsigned int n = 0; n < (randomPolicies.size() + chosenPolicies.size()); n++) {
+			const Learners::StateIndex* index = (n < randomPolicies.size())? randomStateIndices[n]: chosenStateIndices[n - randomPolicies.size()];
+
+			size_t tableSizes[Learners::ActionValueStorage::NUM_STORAGE_MODES];
+
+			for (unsigned int mode = 0; mode < Learners::ActionValueStorage::NUM_STORAGE_MODES; mode++) {
+				tableSizes[mode] = Learner::CalcSize(mode, index, maxUpdates);
+			}
+
+			planner.AddFixedSize(sizeof(Policy) + sizeof(Learner));
+			planner.AddPolicy(Policy::CalcSize(policiesTable, index));
+			planner.AddTable(tableSizes);
+		}
+
+		const bool planned = planner.Plan(params.GetStorageMode(), numThreads);
+
+		planner.Print();
+
+		if (!planned) {
+			return false;
+		}
+
+		// with nearest rounding, updates smaller than half a step of the
+		// 16-bit codes are lost and learning can stall (as bf16 does on
+		// SingleCorridorMaze), so a quantized mode picked to fit the
+		// budget always rounds stochastically
+		if (planner.GetStorageMode() != params.GetStorageMode() && planner.GetStorageMode() >= Learners::ActionValueStorage::STORAGE_FP16) {
+			if (params.GetQuantizedRounding() != Learners::QuantizedActionValueTable::ROUNDING_STOCHASTIC) {
+				printf("[%s] using stochastic rounding for \"%s\" storage\n", __FUNCTION__, Learners::ActionValueStorage::GetModeName(planner.GetStorageMode()));
+			}
+
+			params.SetQuantizedRounding(Learners::QuantizedActionValueTable::ROUNDING_STOCHASTIC);
+		}
+
+		params.SetStorageMode(planner.GetStorageMode());
+		numThreads = planner.GetNumThreads();
+	}
+
+	for (unsigned int n = 0; n < randomPolicies.size(); n++) {
+		arena.Reserve(sizeof(Policy));
+		arena.Reserve(sizeof(Learner));
+
+		Policy::ReserveArena(arena, policiesTable, randomStateIndices[n]);
+		Learner::ReserveArena(arena, params, randomStateIndices[n]);
+	}
+	for (unsigned int n = 0; n < chosenPolicies.size(); n++) {
+		arena.Reserve(sizeof(Policy));
+		arena.Reserve(sizeof(Learner));
+
+		Policy::ReserveArena(arena, policiesTable, chosenStateIndices[n]);
+		Learner::ReserveArena(arena, params, chosenStateIndices[n]);
+	}
+
+	const unsigned int numPolicies = randomPolicies.size() + chosenPolicies.size();
+
+	if (!arena.Allocate()) {
+		return false;
+	}
+
+	printf("[%s] arena: %.2f MB for %u policies and learners\n", __FUNCTION__, arena.GetCapacity() / (1024.0 * 1024.0), numPolicies);
+
 	for (unsigned int n = 0; n < randomPolicies.size(); n++) {
-		Learners::TDLearnerParameters params;
-		params.Initialize(learnersTable->GetTblVal("params"));
 		params.SetRandomizeInitialStates(!weakBaseLine);
 
-		state = state.Randomize(randomInitRNGs[n]);
+		void* policySlab = arena.Take(sizeof(Policy));
+		void* learnerSlab = arena.Take(sizeof(Learner));
+
+		if (policySlab == NULL || learnerSlab == NULL) {
+			printf("[%s] arena has no room left for random policy %u\n", __FUNCTION__, n);
+
+			for (unsigned int k = 0; k < jobs.size(); k++) {
+				delete jobs[k];
+			}
+
+			return false;
+		}
 
-		Learner learner(params);
-		learner.SetInitialState(state);
-		learner.SetNumberSequenceGen(randomEvalRNGs[n]);
+		randomPolicies[n] = new (policySlab) Policy(policiesTable);
+		randomLearners[n] = new (learnerSlab) Learner(params);
 
-		randomPolicies[n] = Policy(policiesTable);
-		randomLearners[n] = learner;
+		randomPolicies[n]->SetArena(&arena);
+		randomLearners[n]->SetArena(&arena);
+		randomLearners[n]->SetTemplates(templates);
+		randomPolicies[n]->SetStateIndex(randomStateIndices[n]);
+		randomLearners[n]->SetStateIndex(randomStateIndices[n]);
+		randomLearners[n]->SetInitialState(randomInitialStates[n]);
+		randomLearners[n]->SetNumberSequenceGen(randomEvalRNGs[n]);
 
-		// initialize each learner's Q and each policy's PI
-		// (either randomly or deterministically, according
-		// to task-parameters)
-		randomLearners[n].Initialize(randomInitRNGs[n], task.GetUseRandomInitialActionValues());
-		randomPolicies[n].Initialize(randomInitRNGs[n], task.GetUseRandomInitialStateActions());
+		jobs.push_back(new InitializeJob(randomPolicies[n], randomLearners[n], randomInitRNGs[n], task.GetUseRandomInitialActionValues(), task.GetUseRandomInitialStateActions()));
 	}
 
 	printf("\n");
@@ -85,27 +375,228 @@ bool InitializeBaseLineTest(
 		// we do NOT want randomization of the initial states when
 		// learning predictor-policies (because they are specially
 		// chosen) regardless of whether test is weak or strong
-		Learners::TDLearnerParameters params;
-		params.Initialize(learnersTable->GetTblVal("params"));
 		params.SetRandomizeInitialStates(false);
 
-		state = chosenStates[chosenRNG.NextInt() % chosenStates.size()];
-
 		// predictor-policies start being learned from predictor states
-		Learner learner(params);
-		learner.SetInitialState(state);
-		learner.SetNumberSequenceGen(chosenEvalRNGs[n]);
+		void* policySlab = arena.Take(sizeof(Policy));
+		void* learnerSlab = arena.Take(sizeof(Learner));
+
+		if (policySlab == NULL || learnerSlab == NULL) {
+			printf("[%s] arena has no room left for chosen policy %u\n", __FUNCTION__, n);
+
+			for (unsigned int k = 0; k < jobs.size(); k++) {
+				delete jobs[k];
+			}
+
+			return false;
+		}
+
+		chosenPolicies[n] = new (policySlab) Policy(policiesTable);
+		chosenLearners[n] = new (learnerSlab) Learner(params);
+
+		chosenPolicies[n]->SetArena(&arena);
+		chosenLearners[n]->SetArena(&arena);
+		chosenLearners[n]->SetTemplates(templates);
+		chosenPolicies[n]->SetStateIndex(chosenStateIndices[n]);
+		chosenLearners[n]->SetStateIndex(chosenStateIndices[n]);
+		chosenLearners[n]->SetInitialState(chosenInitialStates[n]);
+		chosenLearners[n]->SetNumberSequenceGen(chosenEvalRNGs[n]);
+
+		jobs.push_back(new InitializeJob(chosenPolicies[n], chosenLearners[n], chosenInitRNGs[n], task.GetUseRandomInitialActionValues(), task.GetUseRandomInitialStateActions()));
+	}
+
+	ThreadPool threadPool(numThreads);
 
-		chosenPolicies[n] = Policy(policiesTable);
-		chosenLearners[n] = learner;
+	for (unsigned int n = 0; n < jobs.size(); n++) {
+		threadPool.AddJob(jobs[n]);
+	}
+
+	threadPool.Execute();
+
+	size_t actionValuesSize = 0;
+	size_t stateActionsSize = 0;
+
+	for (unsigned int n = 0; n < randomPolicies.size(); n++) {
+		actionValuesSize += randomLearners[n]->GetSize();
+		stateActionsSize += randomPolicies[n]->GetSize();
+	}
+	for (unsigned int n = 0; n < chosenPolicies.size(); n++) {
+		actionValuesSize += chosenLearners[n]->GetSize();
+		stateActionsSize += chosenPolicies[n]->GetSize();
+	}
 
-		chosenLearners[n].Initialize(chosenInitRNGs[n], task.GetUseRandomInitialActionValues());
-		chosenPolicies[n].Initialize(chosenInitRNGs[n], task.GetUseRandomInitialStateActions());
+	printf("[%s] Q-tables: %.2f MB, PI-tables: %.2f MB\n", __FUNCTION__, actionValuesSize / (1024.0 * 1024.0), stateActionsSize / (1024.0 * 1024.0));
+
+	if (PageAllocator::GetNumFallbacks() != 0) {
+		printf("[%s] %u tables could not get the requested huge pages\n", __FUNCTION__, PageAllocator::GetNumFallbacks());
+	}
+	if (templates != NULL && templates->GetNumMappings() != 0) {
+		printf("[%s] %u Q-tables share %u templates\n", __FUNCTION__, templates->GetNumMappings(), templates->GetNumTemplates());
+	}
+
+	PrintResidentMemory("after initialization");
+
+	for (unsigned int n = 0; n < jobs.size(); n++) {
+		delete jobs[n];
 	}
 
 	return true;
 }
 
+// destroys what InitializeBaseLineTest constructed; the memory itself
+// is returned when the arena is released
+void DestroyBaseLineTest(
+	std::vector<Policy*>& randomPolicies,
+	std::vector<Policy*>& chosenPolicies,
+	std::vector<Learner*>& randomLearners,
+	std::vector<Learner*>& chosenLearners
+) {
+	for (unsigned int n = 0; n < randomPolicies.size(); n++) {
+		if (randomPolicies[n] != NULL) { randomPolicies[n]->~Policy(); randomPolicies[n] = NULL; }
+		if (randomLearners[n] != NULL) { randomLearners[n]->~Learner(); randomLearners[n] = NULL; }
+	}
+	for (unsigned int n = 0; n < chosenPolicies.size(); n++) {
+		if (chosenPolicies[n] != NULL) { chosenPolicies[n]->~Policy(); chosenPolicies[n] = NULL; }
+		if (chosenLearners[n] != NULL) { chosenLearners[n]->~Learner(); chosenLearners[n] = NULL; }
+	}
+}
+
+
+
+// learns and evaluates a group of (random or chosen) policies, the
+// policies firstPolicyIdx, ..., firstPolicyIdx + N - 1; each job only
+// touches its own policies, learners and evaluation RNG's so any number
+// of them can be executed concurrently
+//
+// a group of more than one policy is learned in lockstep (one learner
+// per lane, see TDPolicy::LearnLockstep) or with the learners' steps
+// interleaved (see TDPolicy::LearnInterleaved), both of which give the
+// same results as learning its policies one after the other
+struct BaseLineTestJob: public IThreadPoolJob {
+public:
+	BaseLineTestJob(
+		const std::vector<Policy*>& policies,
+		const std::vector<Learner*>& learners,
+		const std::vector<TRNG*>& evalRNGs,
+		const char* testBaseName,
+		const char* testTypeName,
+		unsigned int firstPolicyIdx,
+		const std::vector<std::string>& resumeFileNames,
+		bool interleaved
+	): mPolicies(policies), mLearners(learners), mEvalRNGs(evalRNGs), mTestBaseName(testBaseName), mTestTypeName(testTypeName), mFirstPolicyIdx(firstPolicyIdx), mResumeFileNames(resumeFileNames), mInterleaved(interleaved) {
+		assert(mPolicies.size() == mLearners.size());
+		assert(mPolicies.size() == mEvalRNGs.size());
+		assert(mPolicies.size() <= Learner::MAX_LANES);
+	}
+
+	void Execute() {
+		const char* preTrialStr = "[%s] learning and evaluating %s%s policy %u (%u trial-rounds)\n";
+		const char* pstTrialStr = "[%s] learned and evaluated %s%s policy %u (avg. trial-reward %.2f)\n\n";
+		const char* resTrialStr = "[%s] resuming %s%s policy %u after learning-episode %u\n";
+
+		for (unsigned int n = 0; n < mPolicies.size(); n++) {
+			// a missing checkpoint just means the policy starts over
+			if (!mResumeFileNames[n].empty() && mPolicies[n]->Resume(*mLearners[n], mResumeFileNames[n])) {
+				printf(resTrialStr, __FUNCTION__, mTestBaseName, mTestTypeName, mFirstPolicyIdx + n, mPolicies[n]->GetNumLearnedEpisodes());
+			}
+
+			printf(preTrialStr, __FUNCTION__, mTestBaseName, mTestTypeName, mFirstPolicyIdx + n, mPolicies[n]->GetMaxEvaluationTrials());
+		}
+
+		if (mPolicies.size() == 1) {
+			mPolicies[0]->Learn(*mLearners[0]);
+		} else if (mInterleaved) {
+			Policy::LearnInterleaved(&mPolicies[0], &mLearners[0], mPolicies.size());
+		} else {
+			Policy::LearnLockstep(&mPolicies[0], &mLearners[0], mPolicies.size());
+		}
+
+		for (unsigned int n = 0; n < mPolicies.size(); n++) {
+			mPolicies[n]->Evaluate(mEvalRNGs[n]);
+
+			printf(pstTrialStr, __FUNCTION__, mTestBaseName, mTestTypeName, mFirstPolicyIdx + n, 0.0f /*mPolicy->GetTrialEpisodeRewardAvg()*/);
+		}
+	}
+
+	// upper bound on the number of actions this job executes
+	unsigned long GetCost() const {
+		unsigned long cost = 0;
+
+		for (unsigned int n = 0; n < mPolicies.size(); n++) {
+			const unsigned long learnCost = static_cast<unsigned long>(mPolicies[n]->GetMaxLearningEpisodes()) * mLearners[n]->GetParameters().GetMaxActions();
+			const unsigned long trialCost = static_cast<unsigned long>(mPolicies[n]->GetMaxEvaluationTrials()) * mPolicies[n]->GetMaxEpisodeActions();
+
+			cost += (learnCost + trialCost);
+		}
+
+		return cost;
+	}
+
+private:
+	std::vector<Policy*> mPolicies;
+	std::vector<Learner*> mLearners;
+	std::vector<TRNG*> mEvalRNGs;
+
+	const char* mTestBaseName;
+	const char* mTestTypeName;
+
+	unsigned int mFirstPolicyIdx;
+
+	// empty unless resuming from a checkpoint
+	const std::vector<std::string> mResumeFileNames;
+
+	const bool mInterleaved;
+};
+
+
+
+std::string GetCheckpointFileName(const std::string& dataDir, const char* testBaseName, const char* testTypeName, unsigned int policyIdx) {
+	std::stringstream fileName;
+	fileName << dataDir << "CKPT" << testTypeName << "-" << TTask::GetName() << "-" << policyIdx << "-" << testBaseName << ".dat";
+	return (fileName.str());
+}
+
+
+
+// adds the jobs learning and evaluating <policies> (of type <testTypeName>)
+// to <jobs>, each job taking up to <numLanes> consecutive policies
+// (learned in lockstep, or interleaved if <interleaved> is true); the
+// policies are numbered from <firstPolicyIdx> in the whole experiment
+void AddBaseLineTestJobs(
+	std::vector<BaseLineTestJob*>& jobs,
+	std::vector<Policy*>& policies,
+	std::vector<Learner*>& learners,
+	std::vector<TRNG*>& evalRNGs,
+	CheckpointWriter& checkpointWriter,
+	const std::string& dataDir,
+	const char* testBaseName,
+	const char* testTypeName,
+	unsigned int firstPolicyIdx,
+	unsigned int checkpointInterval,
+	unsigned int numLanes,
+	bool interleaved,
+	bool resume
+) {
+	for (unsigned int n = 0; n < policies.size(); n += numLanes) {
+		const unsigned int numGroupPolicies = std::min(numLanes, static_cast<unsigned int>(policies.size()) - n);
+
+		std::vector<std::string> resumeFileNames(numGroupPolicies);
+
+		for (unsigned int k = 0; k < numGroupPolicies; k++) {
+			const std::string checkpointFileName = GetCheckpointFileName(dataDir, testBaseName, testTypeName, firstPolicyIdx + n + k);
+
+			policies[n + k]->SetCheckpointing(&checkpointWriter, checkpointFileName, checkpointInterval);
+			resumeFileNames[k] = (resume? checkpointFileName: "");
+		}
+
+		const std::vector<Policy*> groupPolicies(policies.begin() + n, policies.begin() + n + numGroupPolicies);
+		const std::vector<Learner*> groupLearners(learners.begin() + n, learners.begin() + n + numGroupPolicies);
+		const std::vector<TRNG*> groupEvalRNGs(evalRNGs.begin() + n, evalRNGs.begin() + n + numGroupPolicies);
+
+		jobs.push_back(new BaseLineTestJob(groupPolicies, groupLearners, groupEvalRNGs, testBaseName, testTypeName, firstPolicyIdx + n, resumeFileNames, interleaved));
+	}
+}
+
 
 
 // weak baseline: each policy P is learned on ONE state (the
@@ -118,56 +609,153 @@ bool InitializeBaseLineTest(
 // evalulated many times; each round evaluating P uses a
 // different (random) starting state
 //
+// all policies are learned and evaluated independently, so
+// they are spread over <numThreads> workers (the results do
+// not depend on the order in which the workers run them)
+//
+// if <checkpointInterval> is non-zero, each policy's learning
+// progress is checkpointed every that many episodes to <dataDir>;
+// with <resume> set, policies continue from those checkpoints
+//
+// if <numLanes> is larger than one, that many policies are learned
+// together by each job, in lockstep or (if <interleaved> is true) with
+// their learners' steps interleaved (see BaseLineTestJob)
+//
+// the random (chosen) policies are numbered from <firstRandomPolicy>
+// (<firstChosenPolicy>) in checkpoints and output, see GetShardRange
+//
 void ExecuteBaseLineTest(
-	std::vector<Policy>& randomPolicies,
-	std::vector<Policy>& chosenPolicies,
-	std::vector<Learner>& randomLearners,
-	std::vector<Learner>& chosenLearners,
-	std::vector<INumberSequenceGen*>& randomEvalRNGs,
-	std::vector<INumberSequenceGen*>& chosenEvalRNGs,
-	bool weakBaseLine
+	std::vector<Policy*>& randomPolicies,
+	std::vector<Policy*>& chosenPolicies,
+	std::vector<Learner*>& randomLearners,
+	std::vector<Learner*>& chosenLearners,
+	std::vector<TRNG*>& randomEvalRNGs,
+	std::vector<TRNG*>& chosenEvalRNGs,
+	unsigned int firstRandomPolicy,
+	unsigned int firstChosenPolicy,
+	unsigned int numThreads,
+	bool weakBaseLine,
+	const std::string& dataDir,
+	unsigned int checkpointInterval,
+	unsigned int numLanes,
+	bool interleaved,
+	bool resume
 ) {
-	printf("[%s]\n", __FUNCTION__);
+	printf("[%s] (threads: %u, checkpoint-interval: %u, lanes: %u (%s), resume: %d)\n", __FUNCTION__, numThreads, checkpointInterval, numLanes, (interleaved? "interleaved": "lockstep"), resume);
 
-	const char* preTrialStr = "[%s] learning and evaluating %s%s policy %u (%u trial-rounds)\n";
-	const char* pstTrialStr = "[%s] learned and evaluated %s%s policy %u (avg. trial-reward %.2f)\n\n";
 	const char* testBaseName = weakBaseLine? "WEAK": "STRONG";
 
+	ThreadPool threadPool(numThreads);
+	CheckpointWriter checkpointWriter(TTask::GetName());
+	std::vector<BaseLineTestJob*> jobs;
+
 	// learn and evaluate the RANDOM policies
-	for (unsigned int n = 0; n < randomPolicies.size(); n++) {
-		Policy& policy = randomPolicies[n];
-		Learner& learner = randomLearners[n];
+	AddBaseLineTestJobs(jobs, randomPolicies, randomLearners, randomEvalRNGs, checkpointWriter, dataDir, testBaseName, "-RANDOM", firstRandomPolicy, checkpointInterval, numLanes, interleaved, resume);
+	// learn and evaluate the CHOSEN (predictor) policies
+	AddBaseLineTestJobs(jobs, chosenPolicies, chosenLearners, chosenEvalRNGs, checkpointWriter, dataDir, testBaseName, "-CHOSEN", firstChosenPolicy, checkpointInterval, numLanes, interleaved, resume);
 
-		printf(preTrialStr, __FUNCTION__, testBaseName, "-RANDOM", n, policy.GetMaxEvaluationTrials());
+	for (unsigned int n = 0; n < jobs.size(); n++) {
+		threadPool.AddJob(jobs[n]);
+	}
+
+	threadPool.Execute();
+	checkpointWriter.Flush();
+
+	printf("[%s] executed %u jobs (%u stolen)\n", __FUNCTION__, static_cast<unsigned int>(jobs.size()), threadPool.GetNumStolenJobs());
+	printf("[%s] wrote %u checkpoints (%u superseded)\n", __FUNCTION__, checkpointWriter.GetNumWritten(), checkpointWriter.GetNumDropped());
+
+	PrintResidentMemory("after learning");
+
+	{
+		unsigned int numSinkUpdates = 0;
 
-		// learn and evaluate the n-th random policy
-		policy.Learn(learner);
-		policy.Evaluate(randomEvalRNGs[n]);
+		for (unsigned int n = 0; n < randomLearners.size(); n++) { numSinkUpdates += randomLearners[n]->GetNumSinkUpdates(); }
+		for (unsigned int n = 0; n < chosenLearners.size(); n++) { numSinkUpdates += chosenLearners[n]->GetNumSinkUpdates(); }
 
-		printf(pstTrialStr, __FUNCTION__, testBaseName, "-RANDOM", n, 0.0f /*policy.GetTrialEpisodeRewardAvg()*/);
+		// only possible with pruned states, if the task's transitions
+		// between state-ID's are not exact (see StateSpaceGraph)
+		if (numSinkUpdates != 0) {
+			printf("[%s] dropped %u updates to pruned states\n", __FUNCTION__, numSinkUpdates);
+		}
 	}
 
-	// learn and evaluate the CHOSEN (predictor) policies
+	// the writer goes out of scope, policies must not refer to it
+	for (unsigned int n = 0; n < randomPolicies.size(); n++) {
+		randomPolicies[n]->SetCheckpointing(NULL, "", 0);
+	}
 	for (unsigned int n = 0; n < chosenPolicies.size(); n++) {
-		Policy& policy = chosenPolicies[n];
-		Learner& learner = chosenLearners[n];
+		chosenPolicies[n]->SetCheckpointing(NULL, "", 0);
+	}
 
-		printf(preTrialStr, __FUNCTION__, testBaseName, "-CHOSEN", n, policy.GetMaxEvaluationTrials());
+	for (unsigned int n = 0; n < jobs.size(); n++) {
+		delete jobs[n];
+	}
+}
 
-		// learn and evaluate the n-th chosen policy
-		policy.Learn(learner);
-		policy.Evaluate(chosenEvalRNGs[n]);
 
-		printf(pstTrialStr, __FUNCTION__, testBaseName, "-CHOSEN", n, 0.0f /*policy.GetTrialEpisodeRewardAvg()*/);
+
+// turns the summed reward traces of <numRandomPolicies> random and
+// <numChosenPolicies> chosen policies into averages and writes them out
+// (shared by SerializeBaseLineTestData and MergeBaseLineTestShards, so
+// merged shards give exactly the files an unsharded run writes)
+void WriteBaseLineTestAverages(
+	std::vector<float>& randomLearnerAvgTrainTrace,
+	std::vector<float>& chosenLearnerAvgTrainTrace,
+	std::vector<float>& randomLearnerAvgTrialTrace,
+	std::vector<float>& chosenLearnerAvgTrialTrace,
+	size_t numRandomPolicies,
+	size_t numChosenPolicies
+) {
+	std::fstream f0; f0.open("random-train-avg.dat", std::ios::out);
+	std::fstream f1; f1.open("chosen-train-avg.dat", std::ios::out);
+	std::fstream f2; f2.open("random-trial-avg.dat", std::ios::out);
+	std::fstream f3; f3.open("chosen-trial-avg.dat", std::ios::out);
+
+	for (unsigned int k = 0; k < randomLearnerAvgTrainTrace.size(); k++) {
+		randomLearnerAvgTrainTrace[k] /= numRandomPolicies;
+		chosenLearnerAvgTrainTrace[k] /= numChosenPolicies;
+	}
+	for (unsigned int k = 0; k < randomLearnerAvgTrialTrace.size(); k++) {
+		randomLearnerAvgTrialTrace[k] /= numRandomPolicies;
+		chosenLearnerAvgTrialTrace[k] /= numChosenPolicies;
 	}
-}
 
+	// output an "averaged" execution trace for all random and chosen
+	// policies, statistics for both the training- and testing-phase
+	//
+	// note the results:
+	//   random-train has much higher variance even after averaging
+	//   than chosen-train (because its learning episodes can start
+	//   from any state)
+	//
+	//   random-train obtains higher rewards than chosen-train: the
+	//   chosen policies always start in state "0", which is furthest
+	//   (1000 actions) away from goal and each non-terminal action
+	//   has reward -1 --> episode reward can be -1 * 999 + 1000 at
+	//   most once policy is optimal
+	//
+	//   chosen-trial reward is consistently higher than random-trial
+	//   (this means the random policies are not optimal and need more
+	//   learning episodes)
+	for (unsigned int i = 0; i < randomLearnerAvgTrainTrace.size(); i++) {
+		f0 << i << "\t" << randomLearnerAvgTrainTrace[i] << "\n";
+		f1 << i << "\t" << chosenLearnerAvgTrainTrace[i] << "\n";
+	}
+	for (unsigned int i = 0; i < randomLearnerAvgTrialTrace.size(); i++) {
+		f2 << i << "\t" << randomLearnerAvgTrialTrace[i] << "\n";
+		f3 << i << "\t" << chosenLearnerAvgTrialTrace[i] << "\n";
+	}
 
+	f0.close();
+	f1.close();
+	f2.close();
+	f3.close();
+}
 
 void SerializeBaseLineTestData(
 	const LuaTable* mainTable,
-	std::vector<Policy>& randomPolicies,
-	std::vector<Policy>& chosenPolicies,
+	std::vector<Policy*>& randomPolicies,
+	std::vector<Policy*>& chosenPolicies,
 	bool weakBaseLine
 ) {
 	const std::string dataDir = mainTable->GetStrVal("data", "./");
@@ -176,23 +764,23 @@ void SerializeBaseLineTestData(
 
 	assert(!dataDir.empty() && dataDir[dataDir.size() - 1] == '/');
 	assert(!randomPolicies.empty() && !chosenPolicies.empty());
-	assert(randomPolicies[0].GetMaxEvaluationTrials() == chosenPolicies[0].GetMaxEvaluationTrials());
-	assert(randomPolicies[0].GetMaxLearningEpisodes() == chosenPolicies[0].GetMaxLearningEpisodes());
+	assert(randomPolicies[0]->GetMaxEvaluationTrials() == chosenPolicies[0]->GetMaxEvaluationTrials());
+	assert(randomPolicies[0]->GetMaxLearningEpisodes() == chosenPolicies[0]->GetMaxLearningEpisodes());
 
-	std::vector<float> randomLearnerAvgTrainTrace(randomPolicies[0].GetMaxLearningEpisodes(), 0.0f);
-	std::vector<float> chosenLearnerAvgTrainTrace(chosenPolicies[0].GetMaxLearningEpisodes(), 0.0f);
-	std::vector<float> randomLearnerAvgTrialTrace(randomPolicies[0].GetMaxEvaluationTrials(), 0.0f);
-	std::vector<float> chosenLearnerAvgTrialTrace(chosenPolicies[0].GetMaxEvaluationTrials(), 0.0f);
+	std::vector<float> randomLearnerAvgTrainTrace(randomPolicies[0]->GetMaxLearningEpisodes(), 0.0f);
+	std::vector<float> chosenLearnerAvgTrainTrace(chosenPolicies[0]->GetMaxLearningEpisodes(), 0.0f);
+	std::vector<float> randomLearnerAvgTrialTrace(randomPolicies[0]->GetMaxEvaluationTrials(), 0.0f);
+	std::vector<float> chosenLearnerAvgTrialTrace(chosenPolicies[0]->GetMaxEvaluationTrials(), 0.0f);
 
 	std::stringstream learnerDataFileName;
 	std::stringstream policyDataFileName;
 
 	for (unsigned int n = 0; n < randomPolicies.size(); n++) {
-		for (unsigned int k = 0; k < randomPolicies[n].GetMaxLearningEpisodes(); k++) {
-			randomLearnerAvgTrainTrace[k] += randomPolicies[n].GetTrainEpisodeReward(k);
+		for (unsigned int k = 0; k < randomPolicies[n]->GetMaxLearningEpisodes(); k++) {
+			randomLearnerAvgTrainTrace[k] += randomPolicies[n]->GetTrainEpisodeReward(k);
 		}
-		for (unsigned int k = 0; k < randomPolicies[n].GetMaxEvaluationTrials(); k++) {
-			randomLearnerAvgTrialTrace[k] += randomPolicies[n].GetTrialEpisodeReward(k);
+		for (unsigned int k = 0; k < randomPolicies[n]->GetMaxEvaluationTrials(); k++) {
+			randomLearnerAvgTrialTrace[k] += randomPolicies[n]->GetTrialEpisodeReward(k);
 		}
 
 		#ifdef RELAX_SERIALIZE_POLICY_DATA
@@ -201,8 +789,8 @@ void SerializeBaseLineTestData(
 		learnerDataFileName << dataDir << "Q-RANDOM-" << taskName << "-" << n << "-" << testName << ".dat";
 		policyDataFileName << dataDir << "PI-RANDOM-" << taskName << "-" << n << "-" << testName << ".dat";
 
-		randomLearners[n].Serialize(learnerDataFileName.str());
-		randomPolicies[n].Serialize(policyDataFileName.str());
+		randomLearners[n]->Serialize(learnerDataFileName.str());
+		randomPolicies[n]->Serialize(policyDataFileName.str());
 		#endif
 
 		#ifdef RELAX_SERIALIZE_LEARNER_TRACES
@@ -211,17 +799,17 @@ void SerializeBaseLineTestData(
 
 		// we just serialize the average trace over all
 		// policies (not each individual policy trace)
-		// randomLearners[n].SerializeEpisodeTraces(learnerDataFileName.str());
+		// randomLearners[n]->SerializeEpisodeTraces(learnerDataFileName.str());
 		#endif
 	}
 
 
 	for (unsigned int n = 0; n < chosenPolicies.size(); n++) {
-		for (unsigned int k = 0; k < chosenPolicies[n].GetMaxLearningEpisodes(); k++) {
-			chosenLearnerAvgTrainTrace[k] += chosenPolicies[n].GetTrainEpisodeReward(k);
+		for (unsigned int k = 0; k < chosenPolicies[n]->GetMaxLearningEpisodes(); k++) {
+			chosenLearnerAvgTrainTrace[k] += chosenPolicies[n]->GetTrainEpisodeReward(k);
 		}
-		for (unsigned int k = 0; k < chosenPolicies[n].GetMaxEvaluationTrials(); k++) {
-			chosenLearnerAvgTrialTrace[k] += chosenPolicies[n].GetTrialEpisodeReward(k);
+		for (unsigned int k = 0; k < chosenPolicies[n]->GetMaxEvaluationTrials(); k++) {
+			chosenLearnerAvgTrialTrace[k] += chosenPolicies[n]->GetTrialEpisodeReward(k);
 		}
 
 		#ifdef RELAX_SERIALIZE_POLICY_DATA
@@ -230,8 +818,8 @@ void SerializeBaseLineTestData(
 		learnerDataFileName << dataDir << "Q-CHOSEN-" << taskName << "-" << n << "-" << testName << ".dat";
 		policyDataFileName << dataDir << "PI-CHOSEN-" << taskName << "-" << n << "-" << testName << ".dat";
 
-		chosenLearners[n].Serialize(learnerDataFileName.str());
-		chosenPolicies[n].Serialize(policyDataFileName.str());
+		chosenLearners[n]->Serialize(learnerDataFileName.str());
+		chosenPolicies[n]->Serialize(policyDataFileName.str());
 		#endif
 
 		#ifdef RELAX_SERIALIZE_LEARNER_TRACES
@@ -240,72 +828,342 @@ void SerializeBaseLineTestData(
 
 		// we just serialize the average trace over all
 		// policies (not each individual policy trace)
-		// chosenLearners[n].SerializeEpisodeTraces(learnerDataFileName.str());
+		// chosenLearners[n]->SerializeEpisodeTraces(learnerDataFileName.str());
 		#endif
 	}
 
 
-	{
-		std::fstream f0; f0.open("random-train-avg.dat", std::ios::out);
-		std::fstream f1; f1.open("chosen-train-avg.dat", std::ios::out);
-		std::fstream f2; f2.open("random-trial-avg.dat", std::ios::out);
-		std::fstream f3; f3.open("chosen-trial-avg.dat", std::ios::out);
-
-		for (unsigned int k = 0; k < randomPolicies[0].GetMaxLearningEpisodes(); k++) {
-			randomLearnerAvgTrainTrace[k] /= randomPolicies.size();
-			chosenLearnerAvgTrainTrace[k] /= chosenPolicies.size();
-		}
-		for (unsigned int k = 0; k < randomPolicies[0].GetMaxEvaluationTrials(); k++) {
-			randomLearnerAvgTrialTrace[k] /= randomPolicies.size();
-			chosenLearnerAvgTrialTrace[k] /= chosenPolicies.size();
-		}
-
-		// output an "averaged" execution trace for all random and chosen
-		// policies, statistics for both the training- and testing-phase
-		//
-		// note the results:
-		//   random-train has much higher variance even after averaging
-		//   than chosen-train (because its learning episodes can start
-		//   from any state)
-		//
-		//   random-train obtains higher rewards than chosen-train: the
-		//   chosen policies always start in state "0", which is furthest
-		//   (1000 actions) away from goal and each non-terminal action
-		//   has reward -1 --> episode reward can be -1 * 999 + 1000 at
-		//   most once policy is optimal
-		//
-		//   chosen-trial reward is consistently higher than random-trial
-		//   (this means the random policies are not optimal and need more
-		//   learning episodes)
-		for (unsigned int i = 0; i < randomPolicies[0].GetMaxLearningEpisodes(); i++) {
-			f0 << i << "\t" << randomLearnerAvgTrainTrace[i] << "\n";
-			f1 << i << "\t" << chosenLearnerAvgTrainTrace[i] << "\n";
-		}
-		for (unsigned int i = 0; i < randomPolicies[0].GetMaxEvaluationTrials(); i++) {
-			f2 << i << "\t" << randomLearnerAvgTrialTrace[i] << "\n";
-			f3 << i << "\t" << chosenLearnerAvgTrialTrace[i] << "\n";
-		}
-
-		f0.close();
-		f1.close();
-		f2.close();
-		f3.close();
+	WriteBaseLineTestAverages(
+		randomLearnerAvgTrainTrace,
+		chosenLearnerAvgTrainTrace,
+		randomLearnerAvgTrialTrace,
+		chosenLearnerAvgTrialTrace,
+		randomPolicies.size(),
+		chosenPolicies.size());
+}
+
+
+
+
+// splits <numPolicies> policies into <numShards> contiguous ranges
+// (of sizes that differ by at most one) and returns the first policy
+// and number of policies of shard <shardIdx>; every policy's RNG's
+// and initial state follow from its index alone, so each shard learns
+// its policies exactly as an unsharded run would if it stores them the
+// same way (which MergeBaseLineTestShards checks)
+void GetShardRange(unsigned int numPolicies, unsigned int shardIdx, unsigned int numShards, unsigned int* firstPolicy, unsigned int* numShardPolicies) {
+	const unsigned int first = (static_cast<unsigned long>(numPolicies) * (shardIdx + 0)) / numShards;
+	const unsigned int last  = (static_cast<unsigned long>(numPolicies) * (shardIdx + 1)) / numShards;
+
+	*firstPolicy = first;
+	*numShardPolicies = last - first;
+}
+
+// parses "<i>/<n>" (shard i of n, counting from zero)
+bool ParseShardSpec(const char* spec, unsigned int* shardIdx, unsigned int* numShards) {
+	char tail = 0;
+
+	if (sscanf(spec, "%u/%u%c", shardIdx, numShards, &tail) != 2)
+		return false;
+
+	return (*numShards != 0 && *shardIdx < *numShards);
+}
+
+std::string GetShardFileName(const std::string& dataDir, const std::string& testName, unsigned int shardIdx, unsigned int numShards) {
+	std::stringstream fileName;
+	fileName << dataDir << "SHARD-" << TTask::GetName() << "-" << shardIdx << "-" << numShards << "-" << testName << ".dat";
+	return (fileName.str());
+}
+
+uint64_t HashParameters(const LuaTable* table, uint64_t hash);
+
+// hashes the values of <keys> in <table>, each with its key and <kind>
+// (f, s, b or t for float, string, bool and table) so that equal values
+// under different keys or of different kinds do not collide
+template<typename TKey> uint64_t HashParameterValues(const LuaTable* table, const std::list<TKey>& keys, char kind, uint64_t hash) {
+	for (typename std::list<TKey>::const_iterator it = keys.begin(); it != keys.end(); ++it) {
+		std::stringstream keyStream;
+		keyStream << *it;
+
+		const std::string key = keyStream.str();
+
+		hash = BinaryFile::Checksum(key.c_str(), key.size() + 1, hash);
+		hash = BinaryFile::Checksum(&kind, sizeof(kind), hash);
+
+		switch (kind) {
+			case 'f': {
+				const float value = table->GetFltVal(*it, 0.0f);
+				hash = BinaryFile::Checksum(&value, sizeof(value), hash);
+			} break;
+			case 's': {
+				const std::string value = table->GetStrVal(*it, "");
+				hash = BinaryFile::Checksum(value.c_str(), value.size() + 1, hash);
+			} break;
+			case 'b': {
+				const bool value = table->GetBoolVal(*it, false);
+				hash = BinaryFile::Checksum(&value, sizeof(value), hash);
+			} break;
+			case 't': {
+				hash = HashParameters(table->GetTblVal(*it), hash);
+			} break;
+		}
+	}
+
+	return hash;
+}
+
+// FNV-1a (see BinaryFile::Checksum) over every string- and integer-keyed
+// value of <table> and its subtables in key order, which identifies the
+// parameters of an experiment (values under table keys are skipped)
+uint64_t HashParameters(const LuaTable* table, uint64_t hash) {
+	const char kinds[] = {'f', 's', 'b', 't'};
+
+	std::list<std::string> strKeys[4];
+	std::list<int> intKeys[4];
+
+	table->GetStrFltKeys(&strKeys[0]); table->GetIntFltKeys(&intKeys[0]);
+	table->GetStrStrKeys(&strKeys[1]); table->GetIntStrKeys(&intKeys[1]);
+	table->GetStrBoolKeys(&strKeys[2]); table->GetIntBoolKeys(&intKeys[2]);
+	table->GetStrTblKeys(&strKeys[3]); table->GetIntTblKeys(&intKeys[3]);
+
+	for (unsigned int k = 0; k < 4; k++) {
+		hash = HashParameterValues(table, strKeys[k], kinds[k], hash);
+		hash = HashParameterValues(table, intKeys[k], kinds[k], hash);
+	}
+
+	return hash;
+}
+
+// instead of SerializeBaseLineTestData, a shard writes the complete
+// reward traces of its policies (see RewardTraces) for the merge step
+bool SerializeBaseLineTestShard(
+	const LuaTable* mainTable,
+	const LuaTable* policiesTable,
+	std::vector<Policy*>& randomPolicies,
+	std::vector<Policy*>& chosenPolicies,
+	unsigned int numRandomPolicies,
+	unsigned int numChosenPolicies,
+	unsigned int firstRandomPolicy,
+	unsigned int firstChosenPolicy,
+	unsigned int shardIdx,
+	unsigned int numShards,
+	unsigned int masterRNGSeed,
+	uint64_t parametersHash,
+	const Learners::TDLearnerParameters& learnerParams,
+	bool pruneStates,
+	bool weakBaseLine
+) {
+	const std::string dataDir = mainTable->GetStrVal("data", "./");
+	const std::string testName = (weakBaseLine? "WEAK": "STRONG");
+	const std::string fileName = GetShardFileName(dataDir, testName, shardIdx, numShards);
+
+	RewardTraces traces;
+	RewardTraces::Info& info = traces.GetInfo();
+
+	info.shardIdx = shardIdx;
+	info.numShards = numShards;
+	info.numRandomPolicies = numRandomPolicies;
+	info.numChosenPolicies = numChosenPolicies;
+	info.firstRandomPolicy = firstRandomPolicy;
+	info.numShardRandomPolicies = randomPolicies.size();
+	info.firstChosenPolicy = firstChosenPolicy;
+	info.numShardChosenPolicies = chosenPolicies.size();
+	info.numLearningEpisodes = static_cast<unsigned int>(policiesTable->GetFltVal("maxLearningEpisodes", 0.0f));
+	info.numEvaluationTrials = static_cast<unsigned int>(policiesTable->GetFltVal("maxEvaluationTrials", 0.0f));
+	info.weakBaseLine = weakBaseLine;
+	info.masterRNGSeed = masterRNGSeed;
+	info.parametersHash = parametersHash;
+	info.pruneStates = pruneStates;
+	info.storageMode = learnerParams.GetStorageMode();
+	info.quantizedRounding = learnerParams.GetQuantizedRounding();
+
+	traces.Resize();
+
+	for (unsigned int n = 0; n < randomPolicies.size(); n++) {
+		float* trace = traces.GetRandomTrace(n);
+
+		for (unsigned int k = 0; k < info.numLearningEpisodes; k++) { trace[k] = randomPolicies[n]->GetTrainEpisodeReward(k); }
+		for (unsigned int k = 0; k < info.numEvaluationTrials; k++) { trace[info.numLearningEpisodes + k] = randomPolicies[n]->GetTrialEpisodeReward(k); }
 	}
+	for (unsigned int n = 0; n < chosenPolicies.size(); n++) {
+		float* trace = traces.GetChosenTrace(n);
+
+		for (unsigned int k = 0; k < info.numLearningEpisodes; k++) { trace[k] = chosenPolicies[n]->GetTrainEpisodeReward(k); }
+		for (unsigned int k = 0; k < info.numEvaluationTrials; k++) { trace[info.numLearningEpisodes + k] = chosenPolicies[n]->GetTrialEpisodeReward(k); }
+	}
+
+	if (!traces.Save(fileName, TTask::GetName())) {
+		printf("[%s] failed to write shard traces \"%s\"\n", __FUNCTION__, fileName.c_str());
+		return false;
+	}
+
+	printf("[%s] wrote shard %u/%u to \"%s\" (merge all %u shards with --merge)\n", __FUNCTION__, shardIdx, numShards, fileName.c_str(), numShards);
+	return true;
 }
 
+// the merge step: reads the traces every shard of one experiment wrote
+// (in any order) and writes the same averaged traces as an unsharded run
+// of it, summing the policies' traces in the same order
+bool MergeBaseLineTestShards(const std::vector<std::string>& fileNames) {
+	if (fileNames.empty()) {
+		printf("[%s] no shard files given\n", __FUNCTION__);
+		return false;
+	}
+
+	std::vector<RewardTraces> shards(fileNames.size());
+
+	for (unsigned int n = 0; n < fileNames.size(); n++) {
+		if (!shards[n].Load(fileNames[n], TTask::GetName())) {
+			printf("[%s] failed to read shard traces \"%s\"\n", __FUNCTION__, fileNames[n].c_str());
+			return false;
+		}
+	}
+
+	const RewardTraces::Info& info = shards[0].GetInfo();
+
+	if (info.numRandomPolicies == 0 || info.numChosenPolicies == 0 || fileNames.size() != info.numShards) {
+		printf("[%s] expected %u shards with at least one random and chosen policy, got %u\n", __FUNCTION__, info.numShards, static_cast<unsigned int>(fileNames.size()));
+		return false;
+	}
+
+	// the traces of every policy, in the order of the whole experiment
+	std::vector<const float*> randomTraces(info.numRandomPolicies, NULL);
+	std::vector<const float*> chosenTraces(info.numChosenPolicies, NULL);
+
+	for (unsigned int n = 0; n < shards.size(); n++) {
+		const RewardTraces::Info& shardInfo = shards[n].GetInfo();
+
+		// shards of the same experiment run with another seed (or other
+		// parameters) would pass every check below, but learn different
+		// policies than an unsharded run
+		if (shardInfo.masterRNGSeed != info.masterRNGSeed) {
+			printf("[%s] \"%s\" was run with master seed %u, \"%s\" with %u\n", __FUNCTION__, fileNames[n].c_str(), shardInfo.masterRNGSeed, fileNames[0].c_str(), info.masterRNGSeed);
+			return false;
+		}
+		if (shardInfo.parametersHash != info.parametersHash) {
+			printf("[%s] \"%s\" was run with different parameters than \"%s\"\n", __FUNCTION__, fileNames[n].c_str(), fileNames[0].c_str());
+			return false;
+		}
+		// each shard plans its own memory budget, so even with the same
+		// parameters shards can store their Q-tables differently
+		if (shardInfo.pruneStates != info.pruneStates || shardInfo.storageMode != info.storageMode || shardInfo.quantizedRounding != info.quantizedRounding) {
+			const char* format = "[%s] \"%s\" stored its Q-tables differently (storage \"%s\", rounding %u, pruned %u) than \"%s\" (storage \"%s\", rounding %u, pruned %u)\n";
+			const char* shardModeName = Learners::ActionValueStorage::GetModeName(shardInfo.storageMode);
+			const char* modeName = Learners::ActionValueStorage::GetModeName(info.storageMode);
+
+			printf(format, __FUNCTION__, fileNames[n].c_str(), shardModeName, shardInfo.quantizedRounding, shardInfo.pruneStates, fileNames[0].c_str(), modeName, info.quantizedRounding, info.pruneStates);
+			return false;
+		}
+
+		bool matches = true;
+		matches = matches && (shardInfo.numShards == info.numShards);
+		matches = matches && (shardInfo.numRandomPolicies == info.numRandomPolicies);
+		matches = matches && (shardInfo.numChosenPolicies == info.numChosenPolicies);
+		matches = matches && (shardInfo.numLearningEpisodes == info.numLearningEpisodes);
+		matches = matches && (shardInfo.numEvaluationTrials == info.numEvaluationTrials);
+		matches = matches && (shardInfo.weakBaseLine == info.weakBaseLine);
+		matches = matches && ((shardInfo.firstRandomPolicy + shardInfo.numShardRandomPolicies) <= info.numRandomPolicies);
+		matches = matches && ((shardInfo.firstChosenPolicy + shardInfo.numShardChosenPolicies) <= info.numChosenPolicies);
+
+		if (!matches) {
+			printf("[%s] \"%s\" belongs to a different experiment\n", __FUNCTION__, fileNames[n].c_str());
+			return false;
+		}
+
+		for (unsigned int k = 0; k < shardInfo.numShardRandomPolicies; k++) {
+			if (randomTraces[shardInfo.firstRandomPolicy + k] != NULL) {
+				printf("[%s] \"%s\": random policy %u is in more than one shard\n", __FUNCTION__, fileNames[n].c_str(), shardInfo.firstRandomPolicy + k);
+				return false;
+			}
+
+			randomTraces[shardInfo.firstRandomPolicy + k] = shards[n].GetRandomTrace(k);
+		}
+		for (unsigned int k = 0; k < shardInfo.numShardChosenPolicies; k++) {
+			if (chosenTraces[shardInfo.firstChosenPolicy + k] != NULL) {
+				printf("[%s] \"%s\": chosen policy %u is in more than one shard\n", __FUNCTION__, fileNames[n].c_str(), shardInfo.firstChosenPolicy + k);
+				return false;
+			}
+
+			chosenTraces[shardInfo.firstChosenPolicy + k] = shards[n].GetChosenTrace(k);
+		}
+	}
+
+	const unsigned int numRandomMissing = std::count(randomTraces.begin(), randomTraces.end(), static_cast<const float*>(NULL));
+	const unsigned int numChosenMissing = std::count(chosenTraces.begin(), chosenTraces.end(), static_cast<const float*>(NULL));
+
+	if (numRandomMissing != 0 || numChosenMissing != 0) {
+		printf("[%s] missing %u random and %u chosen policies\n", __FUNCTION__, numRandomMissing, numChosenMissing);
+		return false;
+	}
+
+	std::vector<float> randomLearnerAvgTrainTrace(info.numLearningEpisodes, 0.0f);
+	std::vector<float> chosenLearnerAvgTrainTrace(info.numLearningEpisodes, 0.0f);
+	std::vector<float> randomLearnerAvgTrialTrace(info.numEvaluationTrials, 0.0f);
+	std::vector<float> chosenLearnerAvgTrialTrace(info.numEvaluationTrials, 0.0f);
+
+	for (unsigned int n = 0; n < randomTraces.size(); n++) {
+		for (unsigned int k = 0; k < info.numLearningEpisodes; k++) { randomLearnerAvgTrainTrace[k] += randomTraces[n][k]; }
+		for (unsigned int k = 0; k < info.numEvaluationTrials; k++) { randomLearnerAvgTrialTrace[k] += randomTraces[n][info.numLearningEpisodes + k]; }
+	}
+	for (unsigned int n = 0; n < chosenTraces.size(); n++) {
+		for (unsigned int k = 0; k < info.numLearningEpisodes; k++) { chosenLearnerAvgTrainTrace[k] += chosenTraces[n][k]; }
+		for (unsigned int k = 0; k < info.numEvaluationTrials; k++) { chosenLearnerAvgTrialTrace[k] += chosenTraces[n][info.numLearningEpisodes + k]; }
+	}
+
+	WriteBaseLineTestAverages(
+		randomLearnerAvgTrainTrace,
+		chosenLearnerAvgTrainTrace,
+		randomLearnerAvgTrialTrace,
+		chosenLearnerAvgTrialTrace,
+		randomTraces.size(),
+		chosenTraces.size());
+
+	printf("[%s] merged %u shards (%u random and %u chosen policies)\n", __FUNCTION__, info.numShards, info.numRandomPolicies, info.numChosenPolicies);
+	return true;
+}
 
 
 
 
 
 int main(int argc, char** argv) {
+	// only used to pick a master seed if none was given
 	srandom(time(NULL));
 
 	lua_State* luaState = NULL;
 	LuaParser* luaParser = NULL;
 
-	if (argc != 2) {
-		printf("[%s] usage: %s <parameters.lua>\n", __FUNCTION__, argv[0]);
+	// the merge step of a sharded run, see MergeBaseLineTestShards
+	if (argc >= 2 && std::string(argv[1]) == "--merge") {
+		const std::vector<std::string> fileNames(argv + 2, argv + argc);
+		return (MergeBaseLineTestShards(fileNames)? EXIT_SUCCESS: EXIT_FAILURE);
+	}
+
+	// continue from the checkpoints of an earlier (interrupted) run
+	// with the same parameters and master seed
+	bool resume = false;
+	// only run shard <shardIdx> of <numShards> (see GetShardRange), the
+	// shards may run as separate processes on any number of machines
+	unsigned int shardIdx = 0;
+	unsigned int numShards = 1;
+
+	bool validArgs = (argc >= 2);
+
+	for (int n = 2; n < argc && validArgs; n++) {
+		const std::string arg = argv[n];
+
+		if (arg == "--resume") {
+			resume = true;
+		} else if (arg == "--shard" && (n + 1) < argc) {
+			validArgs = ParseShardSpec(argv[++n], &shardIdx, &numShards);
+		} else {
+			validArgs = false;
+		}
+	}
+
+	if (!validArgs) {
+		printf("[%s] usage: %s <parameters.lua> [--resume] [--shard <i>/<n>]\n", __FUNCTION__, argv[0]);
+		printf("[%s]        %s --merge <shard-file> ...\n", __FUNCTION__, argv[0]);
 		return EXIT_FAILURE;
 	}
 
@@ -343,68 +1201,149 @@ int main(int argc, char** argv) {
 	if (policiesTable == NULL) { printf("[%s] policiesTable: %p\n", __FUNCTION__, policiesTable); delete luaParser; return EXIT_FAILURE; }
 	if (   tasksTable == NULL) { printf("[%s]    tasksTable: %p\n", __FUNCTION__,    tasksTable); delete luaParser; return EXIT_FAILURE; }
 
-	const        float fInitRNGSeed = mainTable->GetFltVal("initRNGSeed", -1.0f);
-	const        float fEvalRNGSeed = mainTable->GetFltVal("evalRNGSeed", -1.0f);
-	const unsigned int iInitRNGSeed = (fInitRNGSeed < 0.0f)? random(): (fInitRNGSeed * (1 << 31));
-	const unsigned int iEvalRNGSeed = (fEvalRNGSeed < 0.0f)? random(): (fEvalRNGSeed * (1 << 31));
+	// every RNG in the experiment derives its seed from this one, so
+	// re-running with the printed master seed reproduces a run exactly
+	// (regardless of the number of threads); the seed must be integral
+	// and less than 2^24 to survive the round-trip through a LuaTable
+	const        float fMasterRNGSeed = mainTable->GetFltVal("masterRNGSeed", -1.0f);
+	const unsigned int iMasterRNGSeed = (fMasterRNGSeed < 0.0f)? (random() & 0xFFFFFF): static_cast<unsigned int>(fMasterRNGSeed);
+
+	// shards drawing their own seeds would each run a different experiment
+	if (numShards > 1 && fMasterRNGSeed < 0.0f) {
+		printf("[%s] --shard needs main.masterRNGSeed to be set (>= 0), the same for every shard\n", __FUNCTION__);
+		lua_close(luaState);
+		delete luaParser;
+		return EXIT_FAILURE;
+	}
+	// checkpoints hold the learners' state but not their initial states
+	// or evaluation RNG's, which a new seed would derive differently
+	if (resume && fMasterRNGSeed < 0.0f) {
+		printf("[%s] --resume needs main.masterRNGSeed to be set (>= 0), the same as for the interrupted run\n", __FUNCTION__);
+		lua_close(luaState);
+		delete luaParser;
+		return EXIT_FAILURE;
+	}
+
+	const RandomNumberStreams rngStreams(iMasterRNGSeed);
+
+	// zero means "use one thread per hardware core"
+	const unsigned int cfgNumThreads = static_cast<unsigned int>(mainTable->GetFltVal("numThreads", 1.0f));
+	// may be lowered by InitializeBaseLineTest to fit the memory budget
+	unsigned int numThreads = (cfgNumThreads == 0)? ThreadPool::GetDefaultNumThreads(): cfgNumThreads;
+
+	// zero means "never checkpoint"
+	const unsigned int checkpointInterval = static_cast<unsigned int>(mainTable->GetFltVal("checkpointInterval", 0.0f));
+	const std::string dataDir = mainTable->GetStrVal("data", "./");
+
+	// large Q-tables and policies are backed by 2MB pages if enabled
+	PageAllocator::SetHugePageMode(PageAllocator::GetHugePageModeFromName(mainTable->GetStrVal("hugePages", "off")));
+
+	// drop unreachable and terminal states from Q-tables and policies
+	// (may be turned off again by InitializeBaseLineTest)
+	bool pruneStates = mainTable->GetBoolVal("pruneStates", false);
+
+	// learn this many policies per job together (at most MAX_LANES),
+	// either in lockstep or with their learners' steps interleaved
+	const unsigned int cfgNumLanes = static_cast<unsigned int>(mainTable->GetFltVal("numLanes", 1.0f));
+	const unsigned int numLanes = std::max(1U, std::min(cfgNumLanes, static_cast<unsigned int>(Learner::MAX_LANES)));
+	const bool interleaved = (mainTable->GetStrVal("laneScheduling", "lockstep") == "interleaved");
+
+	// in MB, zero means "no limit"
+	const float memoryBudgetMB = mainTable->GetFltVal("memoryBudget", 0.0f);
+	const size_t memoryBudget = static_cast<size_t>(memoryBudgetMB * 1024.0 * 1024.0);
 
 	const bool weakBaseLine = testTable->GetBoolVal("weakBaseLine", true);
 	const unsigned int numRandomPolicies = static_cast<unsigned int>(testTable->GetFltVal("numRandomPolicies", 1)); // Nr
 	const unsigned int numChosenPolicies = static_cast<unsigned int>(testTable->GetFltVal("numChosenPolicies", 1)); // Np
 
+	// the policies this shard runs (all of them unless sharded)
+	unsigned int firstRandomPolicy = 0, numShardRandomPolicies = 0;
+	unsigned int firstChosenPolicy = 0, numShardChosenPolicies = 0;
+
+	GetShardRange(numRandomPolicies, shardIdx, numShards, &firstRandomPolicy, &numShardRandomPolicies);
+	GetShardRange(numChosenPolicies, shardIdx, numShards, &firstChosenPolicy, &numShardChosenPolicies);
+
 
 	printf("[%s]\n", __FUNCTION__);
-	printf("  initRNGSeed(f): %f, evalRNGSeed(f): %f\n", fInitRNGSeed, fEvalRNGSeed);
-	printf("  initRNGSeed(i): %u, evalRNGSeed(i): %u\n", iInitRNGSeed, iEvalRNGSeed);
+	printf("  masterRNGSeed(f): %f\n", fMasterRNGSeed);
+	printf("  masterRNGSeed(i): %u\n", iMasterRNGSeed);
 	printf("\n");
-	printf("  weakBaseLine:      %d\n",      weakBaseLine);
-	printf("  numRandomPolicies: %u\n", numRandomPolicies);
-	printf("  numChosenPolicies: %u\n", numChosenPolicies);
+	printf("  numThreads:         %u\n", numThreads);
+	printf("  checkpointInterval: %u\n", checkpointInterval);
+	printf("  hugePages:          %s\n", PageAllocator::GetHugePageModeName(PageAllocator::GetHugePageMode()));
+	printf("  pruneStates:        %d\n", pruneStates);
+	printf("  memoryBudget:       %.2f MB\n", memoryBudgetMB);
+	printf("  numLanes:           %u\n", numLanes);
+	printf("  laneScheduling:     %s\n", (interleaved? "interleaved": "lockstep"));
+	printf("  resume:             %d\n", resume);
+	printf("  weakBaseLine:       %d\n", weakBaseLine);
+	printf("  numRandomPolicies:  %u\n", numRandomPolicies);
+	printf("  numChosenPolicies:  %u\n", numChosenPolicies);
+	printf("  shard:              %u/%u (random policies [%u, %u), chosen policies [%u, %u))\n", shardIdx, numShards, firstRandomPolicy, firstRandomPolicy + numShardRandomPolicies, firstChosenPolicy, firstChosenPolicy + numShardChosenPolicies);
 	printf("\n");
 
 
-	std::vector<Policy> randomPolicies;
-	std::vector<Policy> chosenPolicies;
-	std::vector<Learner> randomLearners;
-	std::vector<Learner> chosenLearners;
+	// holds every policy and learner, see InitializeBaseLineTest
+	Arena arena;
+
+	// with shared seeds all learners draw the same key for their random
+	// action-values, so their Q-tables can start out as one shared copy
+	PageTemplates templates;
+
+	#ifdef RELAX_RNG_SHARED_SEEDS
+	PageTemplates* sharedTemplates = &templates;
+	#else
+	PageTemplates* sharedTemplates = NULL;
+	#endif
+
+	// shared by the learners (and policies) that start from the same
+	// states, only built if pruneStates is set
+	TStateIndexMap stateIndices;
+
+	// of every learner, once fitted to the memory budget
+	Learners::TDLearnerParameters learnerParams;
+
+	std::vector<Policy*> randomPolicies(numShardRandomPolicies, NULL);
+	std::vector<Policy*> chosenPolicies(numShardChosenPolicies, NULL);
+	std::vector<Learner*> randomLearners(numShardRandomPolicies, NULL);
+	std::vector<Learner*> chosenLearners(numShardChosenPolicies, NULL);
 
 	// RNG's used to initialize PI and Q for each policy and learner, etc.
 	//
 	// if seeds are shared, then ALL initRNG's use the same seed N and ALL
 	// evalRNG's use the same seed M (N and M need not be distinct values)
 	// 
-	std::vector<INumberSequenceGen*> randomInitRNGs;
-	std::vector<INumberSequenceGen*> chosenInitRNGs;
-	std::vector<INumberSequenceGen*> randomEvalRNGs;
-	std::vector<INumberSequenceGen*> chosenEvalRNGs;
+	std::vector<TRNG*> randomInitRNGs;
+	std::vector<TRNG*> chosenInitRNGs;
+	std::vector<TRNG*> randomEvalRNGs;
+	std::vector<TRNG*> chosenEvalRNGs;
 
 	{
-		// NOTE: somewhat wasteful wrt. copying in InitializeBaseLineTest
-		randomPolicies.resize(numRandomPolicies);
-		chosenPolicies.resize(numChosenPolicies);
-		randomLearners.resize(numRandomPolicies);
-		chosenLearners.resize(numChosenPolicies);
-
 		#ifdef RELAX_RNG_SHARED_SEEDS
 		// give all init- and eval-RNG's the same initial seed (for debugging purposes)
 		// this means every learner instance starts at the same random state, etc., so
 		// the learned policies will be identical --> not generally useful
+		const unsigned int sharedInitRNGSeed = rngStreams.GetStreamSeed(RandomNumberStreams::STREAM_GROUP_RANDOM, 0, RandomNumberStreams::STREAM_ROLE_INIT);
+		const unsigned int sharedEvalRNGSeed = rngStreams.GetStreamSeed(RandomNumberStreams::STREAM_GROUP_RANDOM, 0, RandomNumberStreams::STREAM_ROLE_EVAL);
+
 		for (unsigned int n = 0; n < randomPolicies.size(); n++) {
-			randomInitRNGs.push_back(new MTRandomNumberSequenceGen(iInitRNGSeed));
-			randomEvalRNGs.push_back(new MTRandomNumberSequenceGen(iEvalRNGSeed));
+			randomInitRNGs.push_back(new TRNG(sharedInitRNGSeed));
+			randomEvalRNGs.push_back(new TRNG(sharedEvalRNGSeed));
 		}
 		for (unsigned int n = 0; n < chosenPolicies.size(); n++) {
-			chosenInitRNGs.push_back(new MTRandomNumberSequenceGen(iInitRNGSeed));
-			chosenEvalRNGs.push_back(new MTRandomNumberSequenceGen(iEvalRNGSeed));
+			chosenInitRNGs.push_back(new TRNG(sharedInitRNGSeed));
+			chosenEvalRNGs.push_back(new TRNG(sharedEvalRNGSeed));
 		}
 		#else
+		// each (policy, role) pair gets its own independent stream,
+		// identified by the policy's index in the whole experiment
 		for (unsigned int n = 0; n < randomPolicies.size(); n++) {
-			randomInitRNGs.push_back(new MTRandomNumberSequenceGen(random()));
-			randomEvalRNGs.push_back(new MTRandomNumberSequenceGen(random()));
+			randomInitRNGs.push_back(rngStreams.NewStreamGen<TRNG>(RandomNumberStreams::STREAM_GROUP_RANDOM, firstRandomPolicy + n, RandomNumberStreams::STREAM_ROLE_INIT));
+			randomEvalRNGs.push_back(rngStreams.NewStreamGen<TRNG>(RandomNumberStreams::STREAM_GROUP_RANDOM, firstRandomPolicy + n, RandomNumberStreams::STREAM_ROLE_EVAL));
 		}
 		for (unsigned int n = 0; n < chosenPolicies.size(); n++) {
-			chosenInitRNGs.push_back(new MTRandomNumberSequenceGen(random()));
-			chosenEvalRNGs.push_back(new MTRandomNumberSequenceGen(random()));
+			chosenInitRNGs.push_back(rngStreams.NewStreamGen<TRNG>(RandomNumberStreams::STREAM_GROUP_CHOSEN, firstChosenPolicy + n, RandomNumberStreams::STREAM_ROLE_INIT));
+			chosenEvalRNGs.push_back(rngStreams.NewStreamGen<TRNG>(RandomNumberStreams::STREAM_GROUP_CHOSEN, firstChosenPolicy + n, RandomNumberStreams::STREAM_ROLE_EVAL));
 		}
 		#endif
 	}
@@ -425,6 +1364,12 @@ int main(int argc, char** argv) {
 		learnersTable,
 		policiesTable,
 		task,
+		arena,
+		sharedTemplates,
+		stateIndices,
+		pruneStates,
+		memoryBudget,
+		checkpointInterval,
 		randomPolicies,
 		chosenPolicies,
 		randomLearners,
@@ -433,6 +1378,10 @@ int main(int argc, char** argv) {
 		chosenInitRNGs,
 		randomEvalRNGs,
 		chosenEvalRNGs,
+		rngStreams,
+		firstChosenPolicy,
+		numThreads,
+		learnerParams,
 		weakBaseLine
 	)) {
 		ExecuteBaseLineTest(
@@ -442,14 +1391,48 @@ int main(int argc, char** argv) {
 			chosenLearners,
 			randomEvalRNGs,
 			chosenEvalRNGs,
-			weakBaseLine
+			firstRandomPolicy,
+			firstChosenPolicy,
+			numThreads,
+			weakBaseLine,
+			dataDir,
+			checkpointInterval,
+			numLanes,
+			interleaved,
+			resume
 		);
 
-		SerializeBaseLineTestData(
-			mainTable,
-			randomPolicies,
-			chosenPolicies,
-			weakBaseLine);
+		if (numShards == 1) {
+			SerializeBaseLineTestData(
+				mainTable,
+				randomPolicies,
+				chosenPolicies,
+				weakBaseLine);
+		} else {
+			SerializeBaseLineTestShard(
+				mainTable,
+				policiesTable,
+				randomPolicies,
+				chosenPolicies,
+				numRandomPolicies,
+				numChosenPolicies,
+				firstRandomPolicy,
+				firstChosenPolicy,
+				shardIdx,
+				numShards,
+				iMasterRNGSeed,
+				HashParameters(tasksTable, HashParameters(policiesTable, HashParameters(learnersTable, BinaryFile::Checksum(NULL, 0)))),
+				learnerParams,
+				pruneStates,
+				weakBaseLine);
+		}
+	}
+
+	DestroyBaseLineTest(randomPolicies, chosenPolicies, randomLearners, chosenLearners);
+	arena.Release();
+
+	for (TStateIndexMap::iterator it = stateIndices.begin(); it != stateIndices.end(); ++it) {
+		delete (it->second);
 	}
 
 	for (unsigned int n = 0; n < randomPolicies.size(); n++) {
@@ -5,6 +5,7 @@
 #include "learners/TDPolicy.hpp"
 #include "learners/QLearning.hpp"
 #include "tasks/SingleCorridorMaze.hpp"
+#include "util/RandomNumberSequenceGen.hpp"
 
 namespace RELAX {
 	// typedef Tasks::Dummy TTask;
@@ -14,13 +15,19 @@ namespace RELAX {
 	typedef TTask::State TState;
 	typedef TTask::Action TAction;
 
+	// generator used by all learners, policies and tasks
+	// typedef MTRandomNumberSequenceGen TRNG;
+	// typedef PCGRandomNumberSequenceGen TRNG;
+	// typedef XS256RandomNumberSequenceGen TRNG;
+	typedef XS128x4RandomNumberSequenceGen TRNG;
 
-	typedef Learners::QLearning<TState, TAction> Learner;
-	// typedef Learners::SARSA<TState, TAction> Learner;
+
+	typedef Learners::QLearning<TState, TAction, TRNG> Learner;
+	// typedef Learners::SARSA<TState, TAction, TRNG> Learner;
 
 	// NOTE: TDPolicy::Learn only accepts TDLearnerBase instances!
-	typedef Learners::TDPolicy<TState, TAction> Policy;
-	// typedef Learners::GAPolicy<TState, TAction> Policy;
+	typedef Learners::TDPolicy<TState, TAction, TRNG> Policy;
+	// typedef Learners::GAPolicy<TState, TAction, TRNG> Policy;
 };
 
 #endif
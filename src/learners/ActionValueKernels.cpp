@@ -0,0 +1,98 @@
+#include "ActionValueKernels.hpp"
+
+#ifdef RELAX_ACTIONVALUEKERNELS_SSE
+#include <immintrin.h>
+#endif
+
+using namespace RELAX::Learners;
+
+const int ActionValueKernels::gLaneMasks[16] = {
+	-1, -1, -1, -1, -1, -1, -1, -1,
+	 0,  0,  0,  0,  0,  0,  0,  0,
+};
+
+unsigned int ActionValueKernels::gKernel = ActionValueKernels::SelectKernel();
+
+
+
+#ifdef RELAX_ACTIONVALUEKERNELS_SSE
+__attribute__((target("avx2")))
+unsigned int ActionValueKernels::ArgMaxAVX2(const float* values, unsigned int numValues, float* maxValue) {
+	const __m256 fill = _mm256_set1_ps(-std::numeric_limits<float>::max());
+	__m256 vmax = fill;
+	__m256 v;
+
+	unsigned int n = 0;
+
+	// whole groups of eight, then one masked group for the remainder
+	// (rows are only padded to a multiple of four, so the last group
+	// must not read more than four values past <numValues>)
+	for (n = 0; (n + 8) <= numValues; n += 8) {
+		vmax = _mm256_max_ps(vmax, _mm256_loadu_ps(values + n));
+	}
+	if (n < numValues) {
+		const __m256 mask = _mm256_loadu_ps(reinterpret_cast<const float*>(gLaneMasks + (8 - (numValues - n))));
+
+		if ((numValues - n) > 4) {
+			v = _mm256_loadu_ps(values + n);
+		} else {
+			v = _mm256_castps128_ps256(_mm_loadu_ps(values + n));
+		}
+
+		vmax = _mm256_max_ps(vmax, _mm256_blendv_ps(fill, v, mask));
+	}
+
+	const __m128 hmax = HorizontalMaxSSE(_mm_max_ps(_mm256_castps256_ps128(vmax), _mm256_extractf128_ps(vmax, 1)));
+
+	*maxValue = _mm_cvtss_f32(hmax);
+
+	// the first occurrence is found four lanes at a time, which also
+	// never reads past the padded row
+	return (FindFirstSSE(values, numValues, hmax));
+}
+#endif
+
+
+
+bool ActionValueKernels::SetKernel(unsigned int kernel) {
+	if (!IsKernelSupported(kernel)) {
+		return false;
+	}
+
+	gKernel = kernel;
+	return true;
+}
+
+bool ActionValueKernels::IsKernelSupported(unsigned int kernel) {
+	switch (kernel) {
+		case KERNEL_SCALAR: { return true; }
+		#ifdef RELAX_ACTIONVALUEKERNELS_SSE
+		case KERNEL_SSE: { return true; }
+		case KERNEL_AVX2: {
+			// may run before main (through the initializer of gKernel)
+			__builtin_cpu_init();
+			return (__builtin_cpu_supports("avx2"));
+		}
+		#endif
+		default: { return false; }
+	}
+}
+
+const char* ActionValueKernels::GetKernelName(unsigned int kernel) {
+	switch (kernel) {
+		case KERNEL_SCALAR: { return "scalar"; }
+		case KERNEL_SSE: { return "SSE"; }
+		case KERNEL_AVX2: { return "AVX2"; }
+		default: { return "unknown"; }
+	}
+}
+
+unsigned int ActionValueKernels::SelectKernel() {
+	for (unsigned int kernel = NUM_KERNELS - 1; kernel > KERNEL_SCALAR; kernel--) {
+		if (IsKernelSupported(kernel)) {
+			return kernel;
+		}
+	}
+
+	return KERNEL_SCALAR;
+}
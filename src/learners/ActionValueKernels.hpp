@@ -0,0 +1,213 @@
+#ifndef RELAX_ACTIONVALUEKERNELS_HDR
+#define RELAX_ACTIONVALUEKERNELS_HDR
+
+#include <cassert>
+#include <limits>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define RELAX_ACTIONVALUEKERNELS_SSE
+#include <emmintrin.h>
+#endif
+
+namespace RELAX {
+	namespace Learners {
+		// max / argmax over the action-values of one state (or of many
+		// states at once); all kernels return the index of the FIRST
+		// maximal value, which is what the scalar "if (v > max)" loop
+		// that they replace did
+		//
+		// NOTE:
+		//     values are read in groups of SIMD_WIDTH, so every row must
+		//     be readable up to its padded length (as are the rows of an
+		//     ActionValueTable); lanes beyond <numValues> are masked out
+		//     and never returned
+		// NOTE:
+		//     the maximum is taken over (-FLT_MAX, values...), so a row
+		//     that contains only -FLT_MAX / -INF entries yields index 0;
+		//     NaN's are not supported
+		class ActionValueKernels {
+		public:
+			enum {
+				KERNEL_SCALAR = 0,
+				KERNEL_SSE    = 1, // 4 lanes, baseline on x86-64
+				KERNEL_AVX2   = 2, // 8 lanes
+				NUM_KERNELS   = 3,
+			};
+			enum {
+				// rows are read in groups of this many values
+				SIMD_WIDTH = 4,
+
+				// rows shorter than this are faster to scan with the
+				// scalar loop than to reduce across SIMD lanes, and
+				// AVX2 only overtakes SSE for rows of at least
+				// AVX2_MIN_VALUES (see ActionValueTableBench)
+				SSE_MIN_VALUES  =  4,
+				AVX2_MIN_VALUES = 16,
+			};
+
+			// picks the fastest kernel for <numValues> among those
+			// allowed by the current kernel setting (the best one
+			// the CPU supports, unless changed through SetKernel)
+			static unsigned int ArgMax(const float* values, unsigned int numValues, float* maxValue) {
+				assert(numValues > 0);
+
+				#ifdef RELAX_ACTIONVALUEKERNELS_SSE
+				if (gKernel == KERNEL_AVX2 && numValues >= AVX2_MIN_VALUES) {
+					return (ArgMaxAVX2(values, numValues, maxValue));
+				}
+				if (gKernel != KERNEL_SCALAR && numValues >= SSE_MIN_VALUES) {
+					return (ArgMaxSSE(values, numValues, maxValue));
+				}
+				#endif
+
+				return (ArgMaxScalar(values, numValues, maxValue));
+			}
+
+			// same as ArgMax, but for rows whose length NUM_VALUES is
+			// known at compile-time (<numValues> is then ignored); rows
+			// of 2 and 3 values use unrolled scalar kernels, rows of 4
+			// the single-register SSE kernel, and NUM_VALUES = 0 the
+			// run-time path
+			template<unsigned int NUM_VALUES> static unsigned int ArgMaxN(const float* values, unsigned int numValues, float* maxValue) {
+				assert(NUM_VALUES == 0 || NUM_VALUES == numValues);
+				return (ArgMax(values, ((NUM_VALUES != 0)? NUM_VALUES: numValues), maxValue));
+			}
+
+			// fully unrolled scalar kernel; each step compiles to one
+			// compare and two conditional moves instead of a branch
+			template<unsigned int NUM_VALUES> static unsigned int ArgMaxUnrolled(const float* values, float* maxValue) {
+				float v = -std::numeric_limits<float>::max();
+				unsigned int a = 0;
+
+				for (unsigned int n = 0; n < NUM_VALUES; n++) {
+					const bool b = (values[n] > v);
+
+					v = b? values[n]: v;
+					a = b? n: a;
+				}
+
+				*maxValue = v;
+				return a;
+			}
+
+			static unsigned int ArgMaxScalar(const float* values, unsigned int numValues, float* maxValue) {
+				float v = -std::numeric_limits<float>::max();
+				unsigned int a = 0;
+
+				for (unsigned int n = 0; n < numValues; n++) {
+					if (values[n] > v) {
+						v = values[n];
+						a = n;
+					}
+				}
+
+				*maxValue = v;
+				return a;
+			}
+
+			#ifdef RELAX_ACTIONVALUEKERNELS_SSE
+			static unsigned int ArgMaxSSE(const float* values, unsigned int numValues, float* maxValue) {
+				const __m128 fill = _mm_set1_ps(-std::numeric_limits<float>::max());
+
+				if (numValues <= 4) {
+					// common case: the whole row fits in one register
+					const __m128 v = LoadMaskedSSE(values, numValues, fill);
+					const __m128 vmax = HorizontalMaxSSE(_mm_max_ps(v, fill));
+
+					const unsigned int k = FindFirstSSE(v, vmax, numValues);
+
+					*maxValue = _mm_cvtss_f32(vmax);
+					return ((k < 4)? k: 0);
+				}
+
+				__m128 vmax = fill;
+
+				// pass 1: lane-wise maximum, then reduce across lanes
+				for (unsigned int n = 0; n < numValues; n += 4) {
+					vmax = _mm_max_ps(vmax, LoadMaskedSSE(values + n, numValues - n, fill));
+				}
+
+				vmax = HorizontalMaxSSE(vmax);
+				*maxValue = _mm_cvtss_f32(vmax);
+
+				// pass 2: first lane that holds the maximum
+				return (FindFirstSSE(values, numValues, vmax));
+			}
+
+			static unsigned int ArgMaxAVX2(const float* values, unsigned int numValues, float* maxValue);
+			#endif
+
+			// selects the kernel used by ArgMax; returns false (and
+			// leaves the current one in place) if <kernel> is not
+			// supported by this build or CPU
+			static bool SetKernel(unsigned int kernel);
+			static bool IsKernelSupported(unsigned int kernel);
+			static unsigned int GetKernel() { return gKernel; }
+			static const char* GetKernelName(unsigned int kernel);
+
+		private:
+			#ifdef RELAX_ACTIONVALUEKERNELS_SSE
+			// loads four values, replacing those at index <numValid> and
+			// beyond by <fill>
+			static __m128 LoadMaskedSSE(const float* values, unsigned int numValid, __m128 fill) {
+				const __m128 v = _mm_loadu_ps(values);
+
+				if (numValid >= 4) {
+					return v;
+				}
+
+				const __m128 mask = _mm_loadu_ps(reinterpret_cast<const float*>(gLaneMasks + (8 - numValid)));
+				return (_mm_or_ps(_mm_and_ps(mask, v), _mm_andnot_ps(mask, fill)));
+			}
+
+			// broadcasts the largest of the four lanes of <v>
+			static __m128 HorizontalMaxSSE(__m128 v) {
+				v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+				v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+				return v;
+			}
+
+			// index of the first of the <numValid> leading lanes of <v>
+			// equal to <vmax>, or 4 if there is none (lanes past the row
+			// can only "equal" the maximum when it is the fill-value)
+			static unsigned int FindFirstSSE(__m128 v, __m128 vmax, unsigned int numValid) {
+				const unsigned int validBits = (numValid >= 4)? 0xF: ((1U << numValid) - 1);
+				const unsigned int bits = _mm_movemask_ps(_mm_cmpeq_ps(v, vmax)) & validBits;
+
+				return ((bits != 0)? __builtin_ctz(bits): 4);
+			}
+
+			// index of the first value in the row equal to <vmax>, or 0
+			static unsigned int FindFirstSSE(const float* values, unsigned int numValues, __m128 vmax) {
+				for (unsigned int n = 0; n < numValues; n += 4) {
+					const unsigned int k = FindFirstSSE(_mm_loadu_ps(values + n), vmax, numValues - n);
+
+					if (k < 4) {
+						return (n + k);
+					}
+				}
+
+				return 0;
+			}
+			#endif
+
+			static unsigned int SelectKernel();
+
+			// eight all-ones lanes followed by eight all-zeroes lanes;
+			// the mask enabling the first k lanes starts at (8 - k)
+			static const int gLaneMasks[16];
+			static unsigned int gKernel;
+		};
+
+		template<> inline unsigned int ActionValueKernels::ArgMaxN<2>(const float* values, unsigned int, float* maxValue) { return (ArgMaxUnrolled<2>(values, maxValue)); }
+		template<> inline unsigned int ActionValueKernels::ArgMaxN<3>(const float* values, unsigned int, float* maxValue) { return (ArgMaxUnrolled<3>(values, maxValue)); }
+		#ifdef RELAX_ACTIONVALUEKERNELS_SSE
+		// four values fill exactly one SSE register
+		template<> inline unsigned int ActionValueKernels::ArgMaxN<4>(const float* values, unsigned int, float* maxValue) { return (ArgMaxSSE(values, 4, maxValue)); }
+		#else
+		template<> inline unsigned int ActionValueKernels::ArgMaxN<4>(const float* values, unsigned int, float* maxValue) { return (ArgMaxUnrolled<4>(values, maxValue)); }
+		#endif
+	}
+}
+
+#endif
@@ -0,0 +1,273 @@
+#ifndef RELAX_ACTIONVALUESTORAGE_HDR
+#define RELAX_ACTIONVALUESTORAGE_HDR
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "ActionValueTable.hpp"
+#include "HashedActionValueTable.hpp"
+#include "QuantizedActionValueTable.hpp"
+
+namespace RELAX {
+	namespace Learners {
+		// the action-value storage used by TDLearnerBase; forwards
+		// each access to a dense ActionValueTable (one row per state,
+		// allocated up front), a HashedActionValueTable (rows for the
+		// visited states only) or a QuantizedActionValueTable (dense,
+		// 16 bits per value) depending on the storage mode, which must
+		// be chosen before the first Resize
+		class ActionValueStorage {
+		public:
+			enum {
+				STORAGE_DENSE  = 0,
+				STORAGE_HASHED = 1,
+				STORAGE_FP16   = 2,
+				STORAGE_BF16   = 3,
+				STORAGE_INT16  = 4,
+				NUM_STORAGE_MODES = 5,
+			};
+
+			ActionValueStorage(): mMode(STORAGE_DENSE) {}
+
+			void SetMode(unsigned int mode) { assert(IsEmpty()); mMode = mode; }
+			unsigned int GetMode() const { return mMode; }
+			bool IsQuantized() const { return (mMode >= STORAGE_FP16); }
+
+			// only used by hashed storage, for states that were never set
+			void SetDefaultValue(float v) { mHashedTable.SetDefaultValue(v); }
+			// only used by the quantized modes (<range> by int16 only);
+			// must follow SetMode
+			void SetQuantization(unsigned int rounding, float range) {
+				if (IsQuantized()) {
+					mQuantizedTable.SetCodec(QuantizedActionValueTable::CODEC_FP16 + (mMode - STORAGE_FP16), rounding, range);
+				}
+			}
+
+			// dense and quantized tables are carved from <arena> (see
+			// ActionValueTable::SetArena), hashed tables grow on demand
+			// so they keep allocating their own row pools
+			void SetArena(Arena* arena) {
+				mDenseTable.SetArena(arena);
+				mQuantizedTable.SetArena(arena);
+			}
+
+			// only dense tables are mapped from (shared) templates by
+			// Randomize, the others always fill their own pages
+			void SetTemplates(PageTemplates* templates) { mDenseTable.SetTemplates(templates); }
+
+			static void ReserveArena(Arena& arena, unsigned int mode, unsigned int numRows, unsigned int numCols) {
+				switch (mode) {
+					case STORAGE_DENSE: { ActionValueTable::ReserveArena(arena, numRows, numCols); } break;
+					case STORAGE_HASHED: {} break;
+					default: { QuantizedActionValueTable::ReserveArena(arena, numRows, numCols); } break;
+				}
+			}
+
+			// size in bytes of a table in <mode>; hashed tables are sized
+			// for at most <maxStoredRows> stored rows (an upper bound)
+			static size_t CalcSize(unsigned int mode, unsigned int numRows, unsigned int numCols, unsigned int maxStoredRows) {
+				switch (mode) {
+					case STORAGE_DENSE: { return (ActionValueTable::CalcSize(numRows, numCols) + numRows * sizeof(ActionValueTable::RowMax)); } break;
+					case STORAGE_HASHED: { return (HashedActionValueTable::CalcMaxSize(std::min(numRows, maxStoredRows), numCols)); } break;
+					default: {} break;
+				}
+
+				return (QuantizedActionValueTable::CalcSize(numRows, numCols));
+			}
+
+			void Resize(unsigned int numRows, unsigned int numCols) {
+				switch (mMode) {
+					case STORAGE_DENSE: { mDenseTable.Resize(numRows, numCols); } break;
+					case STORAGE_HASHED: { mHashedTable.Resize(numRows, numCols); } break;
+					default: { mQuantizedTable.Resize(numRows, numCols); } break;
+				}
+			}
+			void Clear() {
+				mDenseTable.Clear();
+				mHashedTable.Clear();
+				mQuantizedTable.Clear();
+			}
+
+			bool Save(const std::string& fileName, const std::string& taskName) const {
+				switch (mMode) {
+					case STORAGE_DENSE: { return (mDenseTable.Save(fileName, taskName)); } break;
+					case STORAGE_HASHED: { return (mHashedTable.Save(fileName, taskName)); } break;
+					default: {} break;
+				}
+
+				return (mQuantizedTable.Save(fileName, taskName));
+			}
+			bool Load(const std::string& fileName, const std::string& taskName, bool verify) {
+				switch (mMode) {
+					case STORAGE_DENSE: { return (mDenseTable.Load(fileName, taskName, verify)); } break;
+					case STORAGE_HASHED: { return (mHashedTable.Load(fileName, taskName, verify)); } break;
+					default: {} break;
+				}
+
+				return (mQuantizedTable.Load(fileName, taskName, verify));
+			}
+
+			void SaveState(std::vector<char>& values, std::vector<char>& rowMaxima) const {
+				switch (mMode) {
+					case STORAGE_DENSE: { mDenseTable.SaveState(values, rowMaxima); } break;
+					case STORAGE_HASHED: { mHashedTable.SaveState(values, rowMaxima); } break;
+					default: { mQuantizedTable.SaveState(values, rowMaxima); } break;
+				}
+			}
+			bool LoadState(unsigned int numRows, unsigned int numCols, const std::vector<char>& values, const std::vector<char>& rowMaxima) {
+				switch (mMode) {
+					case STORAGE_DENSE: { return (mDenseTable.LoadState(numRows, numCols, values, rowMaxima)); } break;
+					case STORAGE_HASHED: { return (mHashedTable.LoadState(numRows, numCols, values, rowMaxima)); } break;
+					default: {} break;
+				}
+
+				return (mQuantizedTable.LoadState(numRows, numCols, values, rowMaxima));
+			}
+
+			// not for hashed storage (which has no rows to fill)
+			void Randomize(uint64_t key, const StateIndex* index = NULL) {
+				assert(mMode != STORAGE_HASHED);
+
+				if (mMode == STORAGE_DENSE) {
+					mDenseTable.Randomize(key, index);
+				} else {
+					mQuantizedTable.Randomize(key, index);
+				}
+			}
+
+			// NOTE:
+			//     the mode test is the only overhead on top of the tables'
+			//     own accessors; it is the same for every call so it costs
+			//     next to nothing once predicted
+			void Prefetch(unsigned int row) const {
+				switch (mMode) {
+					case STORAGE_DENSE: { mDenseTable.Prefetch(row); } break;
+					case STORAGE_HASHED: { mHashedTable.Prefetch(row); } break;
+					default: { mQuantizedTable.Prefetch(row); } break;
+				}
+			}
+
+			template<unsigned int NUM_COLS> float GetValue(unsigned int row, unsigned int col) const {
+				if (mMode == STORAGE_DENSE)
+					return (mDenseTable.GetValue<NUM_COLS>(row, col));
+				if (mMode == STORAGE_HASHED)
+					return (mHashedTable.GetValue<NUM_COLS>(row, col));
+
+				return (mQuantizedTable.GetValue<NUM_COLS>(row, col));
+			}
+			template<unsigned int NUM_COLS> void SetValue(unsigned int row, unsigned int col, float v) {
+				if (mMode == STORAGE_DENSE) {
+					mDenseTable.SetValue<NUM_COLS>(row, col, v);
+				} else if (mMode == STORAGE_HASHED) {
+					mHashedTable.SetValue<NUM_COLS>(row, col, v);
+				} else {
+					mQuantizedTable.SetValue<NUM_COLS>(row, col, v);
+				}
+			}
+
+			template<unsigned int NUM_COLS> float GetMaxValue(unsigned int row, unsigned int* col) const {
+				if (mMode == STORAGE_DENSE)
+					return (mDenseTable.GetMaxValue(row, col));
+				if (mMode == STORAGE_HASHED)
+					return (mHashedTable.GetMaxValue(row, col));
+
+				return (mQuantizedTable.GetMaxValue<NUM_COLS>(row, col));
+			}
+			// dense storage only (see ActionValueTable::GetSharedValue);
+			// hashed tables insert rows on first write, which two threads
+			// cannot do at once
+			template<unsigned int NUM_COLS> float GetSharedValue(unsigned int row, unsigned int col) const {
+				assert(mMode == STORAGE_DENSE);
+				return (mDenseTable.GetSharedValue<NUM_COLS>(row, col));
+			}
+			template<unsigned int NUM_COLS> void SetSharedValue(unsigned int row, unsigned int col, float v) {
+				assert(mMode == STORAGE_DENSE);
+				mDenseTable.SetSharedValue<NUM_COLS>(row, col, v);
+			}
+			template<unsigned int NUM_COLS> float GetSharedMaxValue(unsigned int row, unsigned int* col) const {
+				assert(mMode == STORAGE_DENSE);
+				return (mDenseTable.GetSharedMaxValue<NUM_COLS>(row, col));
+			}
+			void UpdateRowMaxima() {
+				assert(mMode == STORAGE_DENSE);
+				mDenseTable.UpdateRowMaxima();
+			}
+
+			void GetMaxCols(unsigned int* cols) const {
+				switch (mMode) {
+					case STORAGE_DENSE: { mDenseTable.GetMaxCols(cols); } break;
+					case STORAGE_HASHED: { mHashedTable.GetMaxCols(cols); } break;
+					default: { mQuantizedTable.GetMaxCols(cols); } break;
+				}
+			}
+			// calls visitor(row, col) for every row whose argmax column can
+			// differ from 0 (all of them, except for hashed storage)
+			template<typename TVisitor> void VisitMaxCols(TVisitor& visitor) const {
+				switch (mMode) {
+					case STORAGE_DENSE: { mDenseTable.VisitMaxCols(visitor); } break;
+					case STORAGE_HASHED: { mHashedTable.VisitMaxCols(visitor); } break;
+					default: { mQuantizedTable.VisitMaxCols(visitor); } break;
+				}
+			}
+
+			unsigned int GetNumRows() const {
+				switch (mMode) {
+					case STORAGE_DENSE: { return (mDenseTable.GetNumRows()); } break;
+					case STORAGE_HASHED: { return (mHashedTable.GetNumRows()); } break;
+					default: {} break;
+				}
+
+				return (mQuantizedTable.GetNumRows());
+			}
+			unsigned int GetNumCols() const {
+				switch (mMode) {
+					case STORAGE_DENSE: { return (mDenseTable.GetNumCols()); } break;
+					case STORAGE_HASHED: { return (mHashedTable.GetNumCols()); } break;
+					default: {} break;
+				}
+
+				return (mQuantizedTable.GetNumCols());
+			}
+			// rows that actually hold values (all of them unless hashed)
+			unsigned int GetNumStoredRows() const { return ((mMode == STORAGE_HASHED)? mHashedTable.GetNumStoredRows(): GetNumRows()); }
+
+			bool IsEmpty() const { return (mDenseTable.IsEmpty() && mHashedTable.IsEmpty() && mQuantizedTable.IsEmpty()); }
+
+			// size in bytes claimed by the table in use
+			size_t GetSize() const {
+				switch (mMode) {
+					case STORAGE_DENSE: { return (mDenseTable.GetSize()); } break;
+					case STORAGE_HASHED: { return (mHashedTable.GetSize()); } break;
+					default: {} break;
+				}
+
+				return (mQuantizedTable.GetSize());
+			}
+
+			// returns NUM_STORAGE_MODES if <name> is not a mode's name
+			static unsigned int GetModeFromName(const std::string& name) {
+				for (unsigned int mode = 0; mode < NUM_STORAGE_MODES; mode++) {
+					if (name == GetModeName(mode)) {
+						return mode;
+					}
+				}
+
+				return NUM_STORAGE_MODES;
+			}
+			static const char* GetModeName(unsigned int mode) {
+				static const char* names[NUM_STORAGE_MODES] = {"dense", "hashed", "fp16", "bf16", "int16"};
+				return ((mode < NUM_STORAGE_MODES)? names[mode]: names[STORAGE_DENSE]);
+			}
+
+		private:
+			ActionValueTable mDenseTable;
+			HashedActionValueTable mHashedTable;
+			QuantizedActionValueTable mQuantizedTable;
+
+			unsigned int mMode;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,341 @@
+#include <cstdio>
+#include "../Defines.hpp"
+
+// compares the quantized action-value storage modes (fp16, bf16 and
+// int16, each with nearest and stochastic rounding) against the fp32
+// (dense) path:
+//
+//   - update throughput of Q-learning style updates on tables of
+//     increasing size (the learner's access pattern, through the
+//     same ActionValueStorage the learners use)
+//   - learning-curve fidelity on SingleCorridorMaze and HillClimber
+//     (the same learner, seeds and parameters in every mode)
+//   - the representation error of each codec on the action-values
+//     learned by the fp32 path
+//
+// build with
+//
+//   g++ -O2 -DRELAX_QSTORAGE_BENCHMARK -o qstoragebench  learners/*.cpp tasks/*.cpp util/*.cpp  -llua5.1 -lboost_thread -lboost_system -lpthread
+//
+#ifdef RELAX_QSTORAGE_BENCHMARK
+#include <cmath>
+#include <vector>
+#include <lua5.1/lua.hpp>
+
+#include "ActionValueStorage.hpp"
+#include "QLearning.hpp"
+#include "TDPolicy.hpp"
+#include "../tasks/HillClimber.hpp"
+#include "../tasks/SingleCorridorMaze.hpp"
+#include "../util/LuaParser.hpp"
+#include "../util/RandomNumberSequenceGen.hpp"
+#include "../util/Timer.hpp"
+
+using namespace RELAX;
+
+typedef XS128x4RandomNumberSequenceGen TRNG;
+typedef Learners::QuantizedActionValueTable QTable;
+
+static const unsigned int NUM_UPDATES = 20000000;
+static const unsigned int NUM_BENCH_ACTIONS = 3;
+
+static const unsigned int NUM_CURVE_WINDOWS = 10;
+
+// the second fp32 run only differs from the first by its seed and
+// shows how far apart two equally good learning curves already are
+struct StorageConfig {
+	unsigned int mode;
+	unsigned int rounding;
+	unsigned int seed;
+};
+
+static const StorageConfig STORAGE_CONFIGS[] = {
+	{Learners::ActionValueStorage::STORAGE_DENSE, QTable::ROUNDING_NEAREST,    1},
+	{Learners::ActionValueStorage::STORAGE_DENSE, QTable::ROUNDING_NEAREST,    3},
+	{Learners::ActionValueStorage::STORAGE_FP16,  QTable::ROUNDING_NEAREST,    1},
+	{Learners::ActionValueStorage::STORAGE_FP16,  QTable::ROUNDING_STOCHASTIC, 1},
+	{Learners::ActionValueStorage::STORAGE_BF16,  QTable::ROUNDING_NEAREST,    1},
+	{Learners::ActionValueStorage::STORAGE_BF16,  QTable::ROUNDING_STOCHASTIC, 1},
+	{Learners::ActionValueStorage::STORAGE_INT16, QTable::ROUNDING_NEAREST,    1},
+	{Learners::ActionValueStorage::STORAGE_INT16, QTable::ROUNDING_STOCHASTIC, 1},
+};
+static const unsigned int NUM_STORAGE_CONFIGS = sizeof(STORAGE_CONFIGS) / sizeof(STORAGE_CONFIGS[0]);
+
+static const char* GetRoundingName(unsigned int rounding) {
+	return ((rounding == QTable::ROUNDING_STOCHASTIC)? "stochastic": "nearest");
+}
+
+
+
+static void BenchUpdates(unsigned int numStates, float range) {
+	// mostly-local walk with occasional jumps (see ActionValueTableBench)
+	std::vector<unsigned int> ints(NUM_UPDATES * 2);
+	std::vector<unsigned int> states(NUM_UPDATES + 1, 0);
+	std::vector<unsigned int> actions(NUM_UPDATES);
+
+	TRNG rng(1234);
+	rng.FillInts(&ints[0], ints.size());
+
+	for (unsigned int n = 0; n < NUM_UPDATES; n++) {
+		const unsigned int r = ints[n * 2 + 0];
+
+		states[n + 1] = ((r & 15) == 0)? ((r >> 4) % numStates): ((states[n] + numStates + ((r >> 4) % 3) - 1) % numStates);
+		actions[n] = ints[n * 2 + 1] % NUM_BENCH_ACTIONS;
+	}
+
+	printf("[%s] %9u states:\n", __FUNCTION__, numStates);
+
+	for (unsigned int c = 0; c < NUM_STORAGE_CONFIGS; c++) {
+		if (STORAGE_CONFIGS[c].seed != STORAGE_CONFIGS[0].seed)
+			continue;
+
+		Learners::ActionValueStorage q;
+
+		q.SetMode(STORAGE_CONFIGS[c].mode);
+		q.SetQuantization(STORAGE_CONFIGS[c].rounding, range);
+		q.Resize(numStates, NUM_BENCH_ACTIONS);
+
+		Timer timer;
+
+		for (unsigned int n = 0; n < NUM_UPDATES; n++) {
+			const unsigned int s = states[n];
+			const unsigned int ss = states[n + 1];
+			const unsigned int a = actions[n];
+			const float qsa = q.GetValue<NUM_BENCH_ACTIONS>(s, a);
+
+			unsigned int col = 0;
+			const float v = q.GetMaxValue<NUM_BENCH_ACTIONS>(ss, &col);
+
+			q.SetValue<NUM_BENCH_ACTIONS>(s, a, qsa + 0.1f * ((((ss & 7) == 0)? 1.0f: -0.01f) + 0.99f * v - qsa));
+		}
+
+		const double secs = timer.GetElapsedSecs();
+
+		printf("    %-6s %-10s %8.2f M updates/sec, %8.2f MB (checksum %f)\n",
+			Learners::ActionValueStorage::GetModeName(STORAGE_CONFIGS[c].mode),
+			GetRoundingName(STORAGE_CONFIGS[c].rounding),
+			(NUM_UPDATES / secs) * 1e-6,
+			q.GetSize() / (1024.0 * 1024.0),
+			q.GetValue<NUM_BENCH_ACTIONS>(0, 0));
+	}
+}
+
+
+
+// exposes the learned action-values for the accuracy report
+template<typename TState, typename TAction> class BenchLearner: public Learners::QLearning<TState, TAction, TRNG> {
+public:
+	BenchLearner(const Learners::TDLearnerParameters& params): Learners::QLearning<TState, TAction, TRNG>(params) {}
+
+	float GetValue(unsigned int stateID, unsigned int actionID) const { return (this->mActionValues.template GetValue<0>(stateID, actionID)); }
+};
+
+struct LearningResult {
+	std::vector<float> trainRewards;
+	std::vector<unsigned int> actionIDs;
+	std::vector<float> actionValues; // fp32 reference only
+
+	float trialReward;
+	double secs;
+	size_t tableSize;
+};
+
+template<typename TTask> static LearningResult Learn(const LuaTable* policyTable, Learners::TDLearnerParameters params, const StorageConfig& config, bool keepValues) {
+	typedef typename TTask::State TState;
+	typedef typename TTask::Action TAction;
+
+	LearningResult result;
+	TRNG initRNG(config.seed), evalRNG(config.seed + 1);
+
+	params.SetStorageMode(config.mode);
+	params.SetQuantizedRounding(config.rounding);
+
+	BenchLearner<TState, TAction> learner(params);
+	Learners::TDPolicy<TState, TAction, TRNG> policy(policyTable);
+
+	learner.SetInitialState(TState());
+	learner.SetNumberSequenceGen(&evalRNG);
+	learner.Initialize(&initRNG, false);
+	policy.Initialize(&initRNG, false);
+
+	Timer timer;
+	policy.Learn(learner);
+	result.secs = timer.GetElapsedSecs();
+	result.trialReward = policy.Evaluate(&evalRNG) / policy.GetMaxEvaluationTrials();
+	result.tableSize = learner.GetSize();
+
+	for (unsigned int n = 0; n < policy.GetMaxLearningEpisodes(); n++) {
+		result.trainRewards.push_back(policy.GetTrainEpisodeReward(n));
+	}
+
+	learner.GetBestActionIDs(result.actionIDs);
+
+	if (keepValues) {
+		for (unsigned int s = 0; s <= TState::GetMaxID(); s++) {
+			for (unsigned int a = 0; a <= TAction::GetMaxID(); a++) {
+				result.actionValues.push_back(learner.GetValue(s, a));
+			}
+		}
+	}
+
+	return result;
+}
+
+// representation error of each codec (nearest rounding) on the values
+// learned through the fp32 path, and the fraction of states whose best
+// action is unchanged by it
+static void ReportAccuracy(const LearningResult& ref, unsigned int numActions, float range) {
+	const char* codecNames[] = {"fp16", "bf16", "int16"};
+
+	for (unsigned int codec = QTable::CODEC_FP16; codec <= QTable::CODEC_INT16; codec++) {
+		QTable table;
+		table.SetCodec(codec, QTable::ROUNDING_NEAREST, range);
+
+		double sumAbsErr = 0.0;
+		double maxAbsErr = 0.0;
+		double maxRelErr = 0.0;
+
+		unsigned int numSameActions = 0;
+
+		for (unsigned int s = 0; s < ref.actionIDs.size(); s++) {
+			const float* values = &ref.actionValues[s * numActions];
+
+			float maxValue = table.RoundTrip(values[0]);
+			unsigned int maxCol = 0;
+
+			for (unsigned int a = 0; a < numActions; a++) {
+				const float q = table.RoundTrip(values[a]);
+				const double err = std::fabs(double(q) - double(values[a]));
+
+				sumAbsErr += err;
+				maxAbsErr = std::max(maxAbsErr, err);
+
+				if (std::fabs(values[a]) > 1e-3f) {
+					maxRelErr = std::max(maxRelErr, err / std::fabs(values[a]));
+				}
+				if (q > maxValue) {
+					maxValue = q;
+					maxCol = a;
+				}
+			}
+
+			numSameActions += (maxCol == ref.actionIDs[s]);
+		}
+
+		printf("    %-6s abs. error (mean %.6f, max %.6f), max. rel. error %.6f, argmax preserved for %.2f%% of states\n",
+			codecNames[codec],
+			sumAbsErr / ref.actionValues.size(),
+			maxAbsErr,
+			maxRelErr,
+			(100.0 * numSameActions) / ref.actionIDs.size());
+	}
+}
+
+template<typename TTask> static void BenchLearning(const LuaTable* policyTable, const Learners::TDLearnerParameters& params) {
+	typedef typename TTask::Action TAction;
+
+	printf("[%s] %s\n", __FUNCTION__, TTask::GetName());
+
+	const LearningResult ref = Learn<TTask>(policyTable, params, STORAGE_CONFIGS[0], true);
+	const unsigned int numEpisodes = ref.trainRewards.size();
+	const unsigned int numWindowEpisodes = std::max(numEpisodes / NUM_CURVE_WINDOWS, 1U);
+
+	for (unsigned int c = 0; c < NUM_STORAGE_CONFIGS; c++) {
+		const LearningResult res = (c == 0)? ref: Learn<TTask>(policyTable, params, STORAGE_CONFIGS[c], false);
+
+		// fidelity: how far the learning curve (the average episode
+		// reward over each tenth of the run) is from the fp32 one, as
+		// a fraction of the latter's magnitude, the average reward over
+		// the last tenth, and how many states end up with the same best
+		// action (individual episodes diverge after the first differing
+		// action choice, so comparing those directly says little)
+		double sumAbsDiff = 0.0;
+		double sumAbsRef = 0.0;
+		double tailReward = 0.0;
+
+		unsigned int numSameActions = 0;
+
+		for (unsigned int w = 0; w < NUM_CURVE_WINDOWS; w++) {
+			double resReward = 0.0;
+			double refReward = 0.0;
+
+			for (unsigned int n = w * numWindowEpisodes; n < std::min((w + 1) * numWindowEpisodes, numEpisodes); n++) {
+				resReward += res.trainRewards[n];
+				refReward += ref.trainRewards[n];
+			}
+
+			sumAbsDiff += std::fabs(resReward - refReward);
+			sumAbsRef += std::fabs(refReward);
+			tailReward = resReward;
+		}
+		for (unsigned int n = 0; n < res.actionIDs.size(); n++) {
+			numSameActions += (res.actionIDs[n] == ref.actionIDs[n]);
+		}
+
+		printf("    %-6s %-10s (seed %u) %7.3fs, %9.2f KB | curve dev. %6.2f%%, tail reward %10.2f, trial reward %10.2f, same action %6.2f%%\n",
+			Learners::ActionValueStorage::GetModeName(STORAGE_CONFIGS[c].mode),
+			GetRoundingName(STORAGE_CONFIGS[c].rounding),
+			STORAGE_CONFIGS[c].seed,
+			res.secs,
+			res.tableSize / 1024.0,
+			(100.0 * sumAbsDiff) / std::max(sumAbsRef, 1e-6),
+			tailReward / numWindowEpisodes,
+			res.trialReward,
+			(100.0 * numSameActions) / res.actionIDs.size());
+	}
+
+	ReportAccuracy(ref, TAction::GetMaxID() + 1, params.GetQuantizedRange());
+}
+
+
+
+int main() {
+	const char* luaSource =
+		"return {"
+		"  SingleCorridorMaze = {numRows = 1, numCols = 1000},"
+		"  HillClimber = {"
+		"    Terrain = {gravity = 9.81 * 0.01, friction = 0.9, stepSize = 0.01, frequencyScale = 1.0, amplitudeScale = 2.0},"
+		"    Vehicle = {mass = 1.0, force = 0.05, vmin = -3.14159, vmax = 3.14159},"
+		"    positionMult = 100.0, velocityMult = 10.0,"
+		"  },"
+		"  policies = {maxEvaluationTrials = 100, maxLearningEpisodes = 1000, maxEpisodeActions = 1000},"
+		"}";
+
+	lua_State* luaState = lua_open();
+	LuaParser luaParser(luaState);
+
+	if (!luaParser.Execute(luaSource, false)) {
+		printf("[%s] error: %s\n", __FUNCTION__, (luaParser.GetError()).c_str());
+		return 1;
+	}
+
+	const LuaTable* rootTable = luaParser.GetRootTbl();
+
+	Tasks::SingleCorridorMaze::GetInstance().Initialize(rootTable->GetTblVal("SingleCorridorMaze"));
+	Tasks::HillClimber::GetInstance().Initialize(rootTable->GetTblVal("HillClimber"));
+
+	// the action-values of both tasks stay within [-2048, 2048]
+	Learners::TDLearnerParameters params;
+	params.SetMaxActions(10000);
+	params.SetAlpha(0.1f);
+	params.SetGamma(0.999f);
+	params.SetEpsilon(0.333f);
+	params.SetAlphaDecay(1.0f);
+	params.SetEpsilonDecay(0.995f);
+	params.SetMinAlpha(0.001f);
+	params.SetMinEpsilon(0.001f);
+	params.SetRandomizeInitialStates(true);
+	params.SetQuantizedRange(2048.0f);
+
+	for (unsigned int numStates = (1 << 12); numStates <= (1 << 24); numStates <<= 4) {
+		BenchUpdates(numStates, params.GetQuantizedRange());
+	}
+
+	BenchLearning<Tasks::SingleCorridorMaze>(rootTable->GetTblVal("policies"), params);
+	BenchLearning<Tasks::HillClimber>(rootTable->GetTblVal("policies"), params);
+
+	lua_close(luaState);
+	return 0;
+}
+
+#endif
@@ -0,0 +1,238 @@
+#include <cstdio>
+#include <cstring>
+
+#include "ActionValueTable.hpp"
+#include "../util/BinaryFile.hpp"
+
+using namespace RELAX::Learners;
+
+ActionValueTable& ActionValueTable::operator = (const ActionValueTable& t) {
+	if (this == &t) {
+		return *this;
+	}
+
+	if (t.IsEmpty()) {
+		Clear();
+		return *this;
+	}
+
+	Resize(t.mNumRows, t.mNumCols);
+	memcpy(mValues, t.mValues, GetSize());
+	memcpy(mRowMaxima, t.mRowMaxima, mNumRows * sizeof(RowMax));
+
+	return *this;
+}
+
+
+
+void ActionValueTable::Resize(unsigned int numRows, unsigned int numCols) {
+	Clear();
+
+	mNumRows = numRows;
+	mNumCols = numCols;
+	mRowStride = CalcRowStride(numCols);
+
+	// both blocks are zero-filled (fresh pages are lazily faulted in),
+	// which is already the right content: every row is all-zero, so
+	// its first column is the maximum ({0.0f, 0} is an all-zero RowMax)
+	mValues = static_cast<float*>(mValuesBlock.Allocate(GetSize()));
+	mRowMaxima = static_cast<RowMax*>(mRowMaximaBlock.Allocate(mNumRows * sizeof(RowMax)));
+
+	assert(mValues != NULL);
+	assert(mRowMaxima != NULL);
+}
+
+void ActionValueTable::Clear() {
+	if (mMappedData != NULL) {
+		BinaryFile::Unmap(mMappedData, mMappedSize);
+	} else {
+		mValuesBlock.Free();
+		mRowMaximaBlock.Free();
+	}
+
+	mValues = NULL;
+	mRowMaxima = NULL;
+	mMappedData = NULL;
+	mMappedSize = 0;
+	mNumRows = 0;
+	mNumCols = 0;
+	mRowStride = 0;
+}
+
+
+
+bool ActionValueTable::Save(const std::string& fileName, const std::string& taskName) const {
+	assert(!IsEmpty());
+
+	BinaryFile::Header header;
+	BinaryFile::InitHeader(&header, BinaryFile::CONTENT_ACTION_VALUES, BinaryFile::DTYPE_FLOAT32, BinaryFile::LAYOUT_PADDED_ROWS, taskName);
+
+	header.numStates = mNumRows;
+	header.numActions = mNumCols;
+	header.rowStride = mRowStride;
+	header.numSections = 2;
+
+	const void* sections[2] = {mValues, mRowMaxima};
+	const uint64_t sectionSizes[2] = {GetSize(), mNumRows * sizeof(RowMax)};
+
+	return (BinaryFile::Write(fileName, &header, sections, sectionSizes));
+}
+
+bool ActionValueTable::Load(const std::string& fileName, const std::string& taskName, bool verify) {
+	BinaryFile::Header header;
+
+	void* data = NULL;
+	size_t size = 0;
+
+	if (!BinaryFile::Map(fileName, &header, &data, &size, verify)) {
+		return false;
+	}
+
+	if (!BinaryFile::CheckContent(fileName, header, BinaryFile::CONTENT_ACTION_VALUES, BinaryFile::DTYPE_FLOAT32, BinaryFile::LAYOUT_PADDED_ROWS, taskName)) {
+		BinaryFile::Unmap(data, size);
+		return false;
+	}
+
+	const bool validLayout =
+		(header.numSections == 2) &&
+		(header.rowStride == CalcRowStride(header.numActions)) &&
+		(header.sectionSizes[0] == CalcSize(header.numStates, header.numActions)) &&
+		(header.sectionSizes[1] == header.numStates * sizeof(RowMax));
+
+	if (!validLayout) {
+		printf("[ActionValueTable::%s] \"%s\": unexpected table layout\n", __FUNCTION__, fileName.c_str());
+		BinaryFile::Unmap(data, size);
+		return false;
+	}
+
+	Clear();
+
+	// sections are 64-byte aligned within the (page-aligned) mapping;
+	// the cached row maxima are stored too, so nothing is recomputed
+	mValues = reinterpret_cast<float*>(static_cast<char*>(data) + header.sectionOffsets[0]);
+	mRowMaxima = reinterpret_cast<RowMax*>(static_cast<char*>(data) + header.sectionOffsets[1]);
+	mMappedData = data;
+	mMappedSize = size;
+
+	mNumRows = header.numStates;
+	mNumCols = header.numActions;
+	mRowStride = header.rowStride;
+	return true;
+}
+
+
+void ActionValueTable::SaveState(std::vector<char>& values, std::vector<char>& rowMaxima) const {
+	values.resize(GetSize());
+	rowMaxima.resize(mNumRows * sizeof(RowMax));
+
+	memcpy(&values[0], mValues, values.size());
+	memcpy(&rowMaxima[0], mRowMaxima, rowMaxima.size());
+}
+
+bool ActionValueTable::LoadState(unsigned int numRows, unsigned int numCols, const std::vector<char>& values, const std::vector<char>& rowMaxima) {
+	if (values.size() != CalcSize(numRows, numCols) || rowMaxima.size() != numRows * sizeof(RowMax)) {
+		return false;
+	}
+
+	Resize(numRows, numCols);
+
+	memcpy(mValues, &values[0], values.size());
+	memcpy(mRowMaxima, &rowMaxima[0], rowMaxima.size());
+	return true;
+}
+
+
+
+void ActionValueTable::Pack(float* values) const {
+	if (mRowStride == mNumCols) {
+		memcpy(values, mValues, GetSize());
+		return;
+	}
+
+	for (unsigned int n = 0; n < mNumRows; n++) {
+		memcpy(values + n * mNumCols, mValues + n * mRowStride, mNumCols * sizeof(float));
+	}
+}
+
+void ActionValueTable::Unpack(const float* values) {
+	if (mRowStride == mNumCols) {
+		memcpy(mValues, values, GetSize());
+		UpdateRowMaxima();
+		return;
+	}
+
+	for (unsigned int n = 0; n < mNumRows; n++) {
+		memcpy(mValues + n * mRowStride, values + n * mNumCols, mNumCols * sizeof(float));
+	}
+
+	UpdateRowMaxima();
+}
+
+void ActionValueTable::Randomize(uint64_t key, const StateIndex* index) {
+	assert(index == NULL || index->GetNumRows() == mNumRows);
+
+	if (RandomizeFromTemplate(key, index)) {
+		return;
+	}
+
+	RandomizeRows(key, index, mValues, mRowMaxima);
+}
+
+bool ActionValueTable::RandomizeFromTemplate(uint64_t key, const StateIndex* index) {
+	if (mTemplates == NULL || IsEmpty()) {
+		return false;
+	}
+
+	// a template holds the padded rows followed by the row maxima, so
+	// it is laid out (and mapped) the same as a BinaryFile's sections
+	const unsigned int numRows = mNumRows;
+	const unsigned int numCols = mNumCols;
+	const size_t size = GetSize() + numRows * sizeof(RowMax);
+
+	// tables of different states have different contents for one key
+	const uint64_t templateKey = (index == NULL)? key: CBRandomNumberSequenceGen::Hash(key, index->GetKey());
+
+	void* data = mTemplates->Map(templateKey, size, RandomTemplateSource(this, key, index));
+
+	if (data == NULL) {
+		return false;
+	}
+
+	Clear();
+
+	mValues = static_cast<float*>(data);
+	mRowMaxima = reinterpret_cast<RowMax*>(static_cast<char*>(data) + CalcSize(numRows, numCols));
+	mMappedData = data;
+	mMappedSize = size;
+
+	mNumRows = numRows;
+	mNumCols = numCols;
+	mRowStride = CalcRowStride(numCols);
+	return true;
+}
+
+void ActionValueTable::RandomizeRows(uint64_t key, const StateIndex* index, float* values, RowMax* rowMaxima) const {
+	for (unsigned int n = 0; n < mNumRows; n++) {
+		float* row = values + n * mRowStride;
+
+		const unsigned int stateID = GetRandomValueID(index, n);
+
+		for (unsigned int k = 0; k < mNumCols; k++) {
+			row[k] = GetRandomValue(key, stateID, k, mNumCols);
+		}
+
+		rowMaxima[n].col = ActionValueKernels::ArgMax(row, mNumCols, &rowMaxima[n].value);
+	}
+}
+
+void ActionValueTable::RandomTemplateSource::Fill(void* data, size_t size) const {
+	assert(size == (mTable->GetSize() + mTable->GetNumRows() * sizeof(RowMax)));
+
+	mTable->RandomizeRows(mKey, mIndex, static_cast<float*>(data), reinterpret_cast<RowMax*>(static_cast<char*>(data) + mTable->GetSize()));
+}
+
+void ActionValueTable::UpdateRowMaxima() {
+	for (unsigned int n = 0; n < mNumRows; n++) {
+		mRowMaxima[n].col = ActionValueKernels::ArgMax(mValues + n * mRowStride, mNumCols, &mRowMaxima[n].value);
+	}
+}
@@ -0,0 +1,286 @@
+#ifndef RELAX_ACTIONVALUETABLE_HDR
+#define RELAX_ACTIONVALUETABLE_HDR
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "ActionValueKernels.hpp"
+#include "StateIndex.hpp"
+#include "../util/Arena.hpp"
+#include "../util/IPageTemplateSource.hpp"
+#include "../util/PageTemplates.hpp"
+#include "../util/RandomNumberStreams.hpp"
+
+namespace RELAX {
+	namespace Learners {
+		// stores the action-values of all states in one contiguous and
+		// cache-line aligned block; each state's row is padded up to a
+		// multiple of SIMD_WIDTH floats so that rows start on a 16-byte
+		// boundary (the padding values are kept at zero and are never
+		// returned as action-values)
+		//
+		// the table also caches the maximum value of each row and the
+		// (first) column holding it; SetValue keeps the cache current
+		// and only rescans a row when its maximum is lowered, so max-
+		// and argmax-queries are O(1) lookups
+		//
+		// a table is either allocated (Resize) or mapped from a file
+		// written by Save (Load); mapped tables use the file's pages
+		// in place, copy-on-write, so loading costs no reads up front
+		// (randomized tables can likewise be mapped from a template
+		// that all tables randomized with the same key share)
+		class ActionValueTable {
+		public:
+			enum {
+				SIMD_WIDTH = ActionValueKernels::SIMD_WIDTH,
+				ALIGNMENT = 64,
+			};
+
+			ActionValueTable(): mValues(NULL), mRowMaxima(NULL), mTemplates(NULL), mMappedData(NULL), mMappedSize(0), mNumRows(0), mNumCols(0), mRowStride(0) {}
+			ActionValueTable(const ActionValueTable& t): mValues(NULL), mRowMaxima(NULL), mTemplates(NULL), mMappedData(NULL), mMappedSize(0), mNumRows(0), mNumCols(0), mRowStride(0) { *this = t; }
+			~ActionValueTable() { Clear(); }
+
+			// safe: operator= performs a (single memcpy) deep-copy
+			ActionValueTable& operator = (const ActionValueTable& t);
+
+			// (re)allocates the table, all values are set to zero (this is
+			// O(1), pages are only faulted in once they are accessed)
+			void Resize(unsigned int numRows, unsigned int numCols);
+			void Clear();
+
+			// makes Resize carve the table from <arena>, which must have
+			// room for it (see ReserveArena) and outlive the table
+			void SetArena(Arena* arena) {
+				mValuesBlock.SetArena(arena);
+				mRowMaximaBlock.SetArena(arena);
+			}
+
+			static void ReserveArena(Arena& arena, unsigned int numRows, unsigned int numCols) {
+				arena.Reserve(CalcSize(numRows, numCols));
+				arena.Reserve(numRows * sizeof(RowMax));
+			}
+
+			// makes Randomize map the table from the template for its key
+			// in <templates> (creating it if this table is the first to use
+			// that key) instead of filling its own pages
+			void SetTemplates(PageTemplates* templates) { mTemplates = templates; }
+
+			// write the table (padded rows and cached row maxima) to a
+			// BinaryFile tagged with <taskName>, or replace this table by
+			// a mapping of one; Load verifies the payload checksum only
+			// if <verify> is true since that reads the entire file
+			bool Save(const std::string& fileName, const std::string& taskName) const;
+			bool Load(const std::string& fileName, const std::string& taskName, bool verify);
+
+			// copy the raw table (padded rows and cached row maxima) to
+			// or from a pair of byte-arrays, as stored in checkpoints
+			void SaveState(std::vector<char>& values, std::vector<char>& rowMaxima) const;
+			bool LoadState(unsigned int numRows, unsigned int numCols, const std::vector<char>& values, const std::vector<char>& rowMaxima);
+
+			// copy all action-values to or from a packed array of
+			// <numRows * numCols> floats (ie. without row-padding)
+			void Pack(float* values) const;
+			void Unpack(const float* values);
+
+			// sets every action-value to a uniform random number in [0, 1)
+			// derived from <key> and its (state-ID, col) index only, such
+			// that the table contents do not depend on the order (or number
+			// of threads) in which tables are initialized, nor on whether
+			// the rows are those of the states in <index> or of all states
+			void Randomize(uint64_t key, const StateIndex* index = NULL);
+
+			// NOTE:
+			//     the accessors taking a NUM_COLS template argument are
+			//     meant for callers that know the number of columns at
+			//     compile-time (it must then equal GetNumCols()), so the
+			//     row offsets and argmax rescans reduce to constants; with
+			//     NUM_COLS = 0 they are the same as the run-time versions
+			template<unsigned int NUM_COLS> float GetValue(unsigned int row, unsigned int col) const {
+				return mValues[GetIndex<NUM_COLS>(row, col)];
+			}
+			template<unsigned int NUM_COLS> void SetValue(unsigned int row, unsigned int col, float v) {
+				mValues[GetIndex<NUM_COLS>(row, col)] = v;
+
+				UpdateRowMax<NUM_COLS>(mRowMaxima[row], mValues + GetIndex<NUM_COLS>(row, 0), mNumCols, col, v);
+			}
+
+			float GetValue(unsigned int row, unsigned int col) const { return (GetValue<0>(row, col)); }
+			void SetValue(unsigned int row, unsigned int col, float v) { SetValue<0>(row, col, v); }
+
+			// returns the largest value in <row> and stores the (first)
+			// column holding it in <col>
+			float GetMaxValue(unsigned int row, unsigned int* col) const {
+				assert(row < mNumRows);
+				*col = mRowMaxima[row].col;
+				return mRowMaxima[row].value;
+			}
+			// hints that <row> (its values and cached maximum) will be
+			// accessed soon, without waiting for it
+			void Prefetch(unsigned int row) const {
+				__builtin_prefetch(mValues + row * mRowStride);
+				__builtin_prefetch(mRowMaxima + row);
+			}
+			// NOTE:
+			//     the Shared accessors are for a table that several threads
+			//     update at once without locking (see HogwildQLearning);
+			//     each value is loaded and stored whole (relaxed atomics,
+			//     plain moves on x86) but concurrent updates of one value
+			//     can overwrite each other, and since the cached row maxima
+			//     are neither used nor kept current, UpdateRowMaxima must
+			//     be called once the threads are done
+			template<unsigned int NUM_COLS> float GetSharedValue(unsigned int row, unsigned int col) const {
+				float v;
+				__atomic_load(mValues + GetIndex<NUM_COLS>(row, col), &v, __ATOMIC_RELAXED);
+				return v;
+			}
+			template<unsigned int NUM_COLS> void SetSharedValue(unsigned int row, unsigned int col, float v) {
+				__atomic_store(mValues + GetIndex<NUM_COLS>(row, col), &v, __ATOMIC_RELAXED);
+			}
+			// scans <row>, returns the same (first) maximum as GetMaxValue
+			template<unsigned int NUM_COLS> float GetSharedMaxValue(unsigned int row, unsigned int* col) const {
+				const unsigned int numCols = (NUM_COLS != 0)? NUM_COLS: mNumCols;
+
+				float maxValue = GetSharedValue<NUM_COLS>(row, 0);
+				*col = 0;
+
+				for (unsigned int n = 1; n < numCols; n++) {
+					const float v = GetSharedValue<NUM_COLS>(row, n);
+
+					if (v > maxValue) {
+						maxValue = v;
+						*col = n;
+					}
+				}
+
+				return maxValue;
+			}
+
+			// recomputes the cached maxima of all rows
+			void UpdateRowMaxima();
+			// stores the argmax column of every row in <cols>
+			void GetMaxCols(unsigned int* cols) const {
+				for (unsigned int n = 0; n < mNumRows; n++) {
+					cols[n] = mRowMaxima[n].col;
+				}
+			}
+			// calls visitor(row, col) with the argmax column of every row
+			template<typename TVisitor> void VisitMaxCols(TVisitor& visitor) const {
+				for (unsigned int n = 0; n < mNumRows; n++) {
+					visitor(n, mRowMaxima[n].col);
+				}
+			}
+
+			// NOTE:
+			//     there is deliberately no non-const access to the rows,
+			//     all writes must go through SetValue or Unpack to keep
+			//     the cached row maxima valid
+			const float* GetRow(unsigned int row) const { assert(row < mNumRows); return (mValues + row * mRowStride); }
+			const float* GetData() const { return mValues; }
+
+			unsigned int GetNumRows() const { return mNumRows; }
+			unsigned int GetNumCols() const { return mNumCols; }
+			unsigned int GetRowStride() const { return mRowStride; }
+
+			bool IsEmpty() const { return (mValues == NULL); }
+			bool IsMapped() const { return (mMappedData != NULL); }
+
+			// size in bytes of the allocated block (including padding)
+			size_t GetSize() const { return (CalcSize(mNumRows, mNumCols)); }
+
+			static unsigned int CalcRowStride(unsigned int numCols) { return (((numCols + SIMD_WIDTH - 1) / SIMD_WIDTH) * SIMD_WIDTH); }
+			static size_t CalcSize(unsigned int numRows, unsigned int numCols) { return (static_cast<size_t>(numRows) * CalcRowStride(numCols) * sizeof(float)); }
+
+			// the value Randomize stores at column <col> of the row of state
+			// <stateID>, 24 random bits (shared with the quantized table)
+			static float GetRandomValue(uint64_t key, unsigned int stateID, unsigned int col, unsigned int numCols) {
+				return ((CBRandomNumberSequenceGen::Hash(key, static_cast<uint64_t>(stateID) * numCols + col) >> 40) * (1.0f / 16777216.0f));
+			}
+			static unsigned int GetRandomValueID(const StateIndex* index, unsigned int row) {
+				return ((index == NULL)? row: index->GetStateID(row));
+			}
+
+			struct RowMax {
+				RowMax(float v = 0.0f): value(v), col(0) {}
+
+				float value;
+				unsigned int col;
+			};
+
+			// brings the cached maximum <rowMax> of <row> up to date after
+			// its column <col> was set to <v> (shared with the hashed table)
+			template<unsigned int NUM_COLS> static void UpdateRowMax(RowMax& rowMax, const float* row, unsigned int numCols, unsigned int col, float v) {
+				if (col == rowMax.col) {
+					// raising (or keeping) the maximum cannot make another
+					// column the first maximal one, lowering it might
+					if (v >= rowMax.value) {
+						rowMax.value = v;
+					} else {
+						rowMax.col = ActionValueKernels::ArgMaxN<NUM_COLS>(row, numCols, &rowMax.value);
+					}
+				} else {
+					if (v > rowMax.value || (v == rowMax.value && col < rowMax.col)) {
+						rowMax.value = v;
+						rowMax.col = col;
+					}
+				}
+			}
+
+		private:
+			// writes the contents Randomize gives this table to a template
+			struct RandomTemplateSource: public IPageTemplateSource {
+			public:
+				RandomTemplateSource(const ActionValueTable* table, uint64_t key, const StateIndex* index): mTable(table), mKey(key), mIndex(index) {}
+
+				void Fill(void* data, size_t size) const;
+
+			private:
+				const ActionValueTable* mTable;
+				const uint64_t mKey;
+				const StateIndex* mIndex;
+			};
+
+			// fills <values> and <rowMaxima> (laid out like this table's)
+			void RandomizeRows(uint64_t key, const StateIndex* index, float* values, RowMax* rowMaxima) const;
+			// maps the table from its template for <key>; returns false
+			// if it has no templates or none could be mapped
+			bool RandomizeFromTemplate(uint64_t key, const StateIndex* index);
+
+			template<unsigned int NUM_COLS> unsigned int GetIndex(unsigned int row, unsigned int col) const {
+				assert(NUM_COLS == 0 || NUM_COLS == mNumCols);
+				assert(row < mNumRows);
+				assert(col < mNumCols);
+
+				if (NUM_COLS != 0) {
+					return (row * CalcRowStride(NUM_COLS) + col);
+				}
+
+				return (row * mRowStride + col);
+			}
+
+			float* mValues;
+
+			// cached maximum (and its column) of each row
+			RowMax* mRowMaxima;
+
+			// memory behind mValues and mRowMaxima unless mapped
+			ArenaBlock mValuesBlock;
+			ArenaBlock mRowMaximaBlock;
+
+			PageTemplates* mTemplates;
+
+			// non-NULL if mValues and mRowMaxima point into a file mapping
+			// (of a BinaryFile or of a template)
+			void* mMappedData;
+			size_t mMappedSize;
+
+			unsigned int mNumRows;   // number of states
+			unsigned int mNumCols;   // number of actions
+			unsigned int mRowStride; // number of floats per row
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,228 @@
+#include <cstdio>
+#include "../Defines.hpp"
+
+// compares the throughput of Q-learning style updates (one max over
+// the successor state's row plus one read-modify-write) on a table
+// stored as one vector per state against the same updates on a flat
+// ActionValueTable (whose max is a cached lookup), and the speed of
+// each argmax kernel for several action-set sizes; build with
+//
+//   g++ -O2 -DRELAX_QTABLE_BENCHMARK -o qtablebench  learners/ActionValue*.cpp util/RandomNumberSequenceGen.cpp
+//
+#ifdef RELAX_QTABLE_BENCHMARK
+#include <limits>
+#include <vector>
+
+#include "ActionValueTable.hpp"
+#include "../util/RandomNumberSequenceGen.hpp"
+#include "../util/Timer.hpp"
+
+using namespace RELAX;
+
+static const unsigned int NUM_UPDATES = 50000000;
+static const unsigned int NUM_ACTIONS = 3;
+
+static const float ALPHA = 0.1f;
+static const float GAMMA = 0.99f;
+
+// per-update (state, action, successor) triples are generated up front
+// so both layouts see exactly the same access pattern and neither pays
+// for the RNG inside the timed loop
+struct Transitions {
+	Transitions(unsigned int numStates, unsigned int numUpdates) {
+		XS128x4RandomNumberSequenceGen rng(1234);
+		std::vector<unsigned int> ints(numUpdates * 2);
+
+		rng.FillInts(&ints[0], ints.size());
+
+		states.resize(numUpdates + 1);
+		actions.resize(numUpdates);
+
+		// successors are mostly local (like a walk through the maze)
+		// with an occasional jump, which keeps some spatial locality
+		// without turning the benchmark into a sequential scan
+		states[0] = 0;
+
+		for (unsigned int n = 0; n < numUpdates; n++) {
+			const unsigned int r = ints[n * 2 + 0];
+
+			if ((r & 15) == 0) {
+				states[n + 1] = (r >> 4) % numStates;
+			} else {
+				states[n + 1] = (states[n] + numStates + ((r >> 4) % 3) - 1) % numStates;
+			}
+
+			actions[n] = ints[n * 2 + 1] % NUM_ACTIONS;
+		}
+	}
+
+	std::vector<unsigned int> states;
+	std::vector<unsigned int> actions;
+};
+
+static float BenchNested(const Transitions& t, unsigned int numStates, double* secs) {
+	std::vector< std::vector<float> > q(numStates, std::vector<float>(NUM_ACTIONS, 0.0f));
+	Timer timer;
+
+	for (unsigned int n = 0; n < NUM_UPDATES; n++) {
+		const unsigned int s = t.states[n];
+		const unsigned int ss = t.states[n + 1];
+		const unsigned int a = t.actions[n];
+		const std::vector<float>& row = q[ss];
+
+		float v = -std::numeric_limits<float>::max();
+
+		for (unsigned int k = 0; k < row.size(); k++) {
+			if (row[k] > v) {
+				v = row[k];
+			}
+		}
+
+		q[s][a] += ALPHA * ((((ss & 7) == 0)? 1.0f: -0.01f) + GAMMA * v - q[s][a]);
+	}
+
+	*secs = timer.GetElapsedSecs();
+	return q[0][0];
+}
+
+static float BenchFlat(const Transitions& t, unsigned int numStates, double* secs) {
+	Learners::ActionValueTable q;
+	q.Resize(numStates, NUM_ACTIONS);
+
+	Timer timer;
+
+	for (unsigned int n = 0; n < NUM_UPDATES; n++) {
+		const unsigned int s = t.states[n];
+		const unsigned int ss = t.states[n + 1];
+		const unsigned int a = t.actions[n];
+		const float qsa = q.GetValue<NUM_ACTIONS>(s, a);
+
+		unsigned int col = 0;
+		float v = q.GetMaxValue(ss, &col);
+
+		q.SetValue<NUM_ACTIONS>(s, a, qsa + ALPHA * ((((ss & 7) == 0)? 1.0f: -0.01f) + GAMMA * v - qsa));
+	}
+
+	*secs = timer.GetElapsedSecs();
+	return q.GetValue(0, 0);
+}
+
+template<unsigned int NUM_COLS> static void ScanRows(const Learners::ActionValueTable& q, unsigned int* cols) {
+	float maxValue = 0.0f;
+
+	for (unsigned int n = 0; n < q.GetNumRows(); n++) {
+		cols[n] = Learners::ActionValueKernels::ArgMaxN<NUM_COLS>(q.GetRow(n), q.GetNumCols(), &maxValue);
+	}
+}
+
+static void BenchArgMax(unsigned int numCols) {
+	static const unsigned int NUM_ROWS = 4096;
+	static const unsigned int NUM_PASSES = 5000;
+
+	Learners::ActionValueTable q;
+	XS128x4RandomNumberSequenceGen rng(1234);
+	std::vector<float> values(NUM_ROWS * numCols);
+	std::vector<unsigned int> cols(NUM_ROWS);
+
+	// few distinct values, so ties are common
+	rng.FillFlts(&values[0], values.size());
+
+	for (unsigned int n = 0; n < values.size(); n++) {
+		values[n] = static_cast<int>(values[n] * 4.0f);
+	}
+
+	q.Resize(NUM_ROWS, numCols);
+	q.Unpack(&values[0]);
+
+	typedef unsigned int (*ArgMaxFunc)(const float*, unsigned int, float*);
+
+	#ifdef RELAX_ACTIONVALUEKERNELS_SSE
+	const ArgMaxFunc funcs[] = {
+		&Learners::ActionValueKernels::ArgMaxScalar,
+		&Learners::ActionValueKernels::ArgMaxSSE,
+		&Learners::ActionValueKernels::ArgMaxAVX2,
+	};
+	#else
+	const ArgMaxFunc funcs[] = {
+		&Learners::ActionValueKernels::ArgMaxScalar,
+	};
+	#endif
+
+	printf("[%s] %2u actions:", __FUNCTION__, numCols);
+
+	// each kernel on its own (through a pointer, so none is inlined),
+	// then the width-dependent selection made by ArgMax, the compile-
+	// time specialization for the widths that have one and finally a
+	// copy of the table's cached row maxima
+	const unsigned int numFuncs = sizeof(funcs) / sizeof(funcs[0]);
+	const char* names[] = {"selected", "fixed", "cached"};
+
+	for (unsigned int kernel = 0; kernel < (numFuncs + 3); kernel++) {
+		if (kernel < numFuncs && !Learners::ActionValueKernels::IsKernelSupported(kernel)) {
+			continue;
+		}
+
+		Timer timer;
+		unsigned int sum = 0;
+		float maxValue = 0.0f;
+
+		for (unsigned int n = 0; n < NUM_PASSES; n++) {
+			if (kernel < numFuncs) {
+				for (unsigned int k = 0; k < NUM_ROWS; k++) {
+					cols[k] = funcs[kernel](q.GetRow(k), numCols, &maxValue);
+				}
+			} else if (kernel == numFuncs) {
+				ScanRows<0>(q, &cols[0]);
+			} else if (kernel == (numFuncs + 1)) {
+				switch (numCols) {
+					case 2: { ScanRows<2>(q, &cols[0]); } break;
+					case 3: { ScanRows<3>(q, &cols[0]); } break;
+					case 4: { ScanRows<4>(q, &cols[0]); } break;
+					default: { ScanRows<0>(q, &cols[0]); } break;
+				}
+			} else {
+				q.GetMaxCols(&cols[0]);
+			}
+
+			sum += cols[n % NUM_ROWS];
+		}
+
+		const double secs = timer.GetElapsedSecs();
+		const char* name = (kernel < numFuncs)? Learners::ActionValueKernels::GetKernelName(kernel): names[kernel - numFuncs];
+
+		printf(" %s %7.2f M rows/sec (checksum %u)", name, ((NUM_ROWS * NUM_PASSES) / secs) * 1e-6, sum);
+	}
+
+	printf("\n");
+}
+
+int main() {
+	// HillClimber-sized (~40k states) up to a table that no longer fits
+	// in the last-level cache
+	const unsigned int numStates[] = {40000, 1000000, 10000000};
+
+	for (unsigned int n = 0; n < (sizeof(numStates) / sizeof(numStates[0])); n++) {
+		const Transitions t(numStates[n], NUM_UPDATES);
+
+		double nestedSecs = 0.0;
+		double flatSecs = 0.0;
+
+		const float nestedSum = BenchNested(t, numStates[n], &nestedSecs);
+		const float flatSum = BenchFlat(t, numStates[n], &flatSecs);
+
+		printf("[%s] %8u states: nested %7.2f M updates/sec, flat %7.2f M updates/sec (%.2fx, checksums %f %f)\n",
+			__FUNCTION__, numStates[n],
+			(NUM_UPDATES / nestedSecs) * 1e-6, (NUM_UPDATES / flatSecs) * 1e-6,
+			nestedSecs / flatSecs, nestedSum, flatSum);
+	}
+
+	const unsigned int numCols[] = {2, 3, 4, 8, 16, 32};
+
+	for (unsigned int n = 0; n < (sizeof(numCols) / sizeof(numCols[0])); n++) {
+		BenchArgMax(numCols[n]);
+	}
+
+	return 0;
+}
+
+#endif
@@ -0,0 +1,66 @@
+#include <cstdio>
+#include "../Defines.hpp"
+
+// compares learning one HillClimber configuration (with a fine state
+// discretization) on a single thread through QLearning against 1 to 8
+// actor threads feeding one learner thread in ActorLearnerQLearning:
+//
+//   - wall-clock time for the same total number of episodes
+//   - the learning curve (mean episode reward per tenth of episodes)
+//   - the quality of the greedy policy derived from the table, as its
+//     mean reward from the same random start states
+//   - the queue and staleness metrics of the actor/learner split
+//
+// every actor decays its epsilon once per episode it runs itself, so
+// with N actors each uses the N-th power of the configured decay to
+// follow the single-threaded schedule (the learner decays alpha once
+// per episode of any actor, which already does); build with
+//
+//   g++ -O2 -DRELAX_ACTORLEARNER_BENCHMARK -o actorlearnerbench  learners/*.cpp tasks/*.cpp util/*.cpp  -llua5.1 -lboost_thread -lboost_system -lpthread
+//
+#ifdef RELAX_ACTORLEARNER_BENCHMARK
+#include <lua5.1/lua.hpp>
+
+#include "ActorLearnerQLearning.hpp"
+#include "SharedTableBench.hpp"
+
+typedef Learners::ActorLearnerQLearning<TState, TAction, TRNG> TActorLearner;
+
+int main() {
+	lua_State* luaState = lua_open();
+	LuaParser luaParser(luaState);
+
+	if (!InitializeTask(luaParser))
+		return 1;
+
+	std::vector<float> rewards(NUM_EPISODES);
+	std::vector<unsigned int> actionIDs;
+
+	const double baseSecs = RunBaseLine(rewards, actionIDs);
+
+	for (unsigned int a = 0; a < NUM_THREAD_COUNTS; a++) {
+		const unsigned int numActors = THREAD_COUNTS[a];
+
+		std::vector<TRNG*> rngs(numActors);
+		std::vector<TActorLearner*> actors(numActors);
+
+		CreateLearners(rngs, actors, GetParameters(1, numActors));
+
+		TActorLearner::Metrics metrics;
+		TActorLearner::ExecuteEpisodes(&actors[0], numActors, NUM_EPISODES, &rewards[0], &metrics);
+
+		char name[32];
+		snprintf(name, sizeof(name), "%u actor(s)", numActors);
+
+		actors[0]->GetBestActionIDs(actionIDs);
+		PrintResult(name, metrics.secs, baseSecs, rewards, actionIDs);
+		metrics.Print();
+
+		DestroyLearners(rngs, actors);
+	}
+
+	lua_close(luaState);
+	return 0;
+}
+
+#endif
@@ -0,0 +1,293 @@
+#ifndef RELAX_ACTORLEARNERQLEARNING_HDR
+#define RELAX_ACTORLEARNERQLEARNING_HDR
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <vector>
+
+#include <boost/bind/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "../Defines.hpp"
+#include "SharedTableQLearning.hpp"
+#include "../util/SPSCRing.hpp"
+#include "../util/Timer.hpp"
+
+namespace RELAX {
+	namespace Learners {
+		// Q-learning split into actors and one learner: every actor runs
+		// episodes on its own thread, selecting actions from the shared
+		// action-value table and pushing the (s, a, r, s') transitions
+		// it makes into its own SPSCRing; the learner (the thread calling
+		// ExecuteEpisodes) drains the rings in batches and is the only
+		// one to update the table
+		//
+		// the actors act on a SharedTableQLearning table, each with its own
+		// RNG and epsilon schedule, while alpha and gamma are the owner's
+		// and its alpha decays once per episode the learner has seen end
+		// (in any actor)
+		//
+		// actors read the live table with relaxed atomic loads rather than
+		// a copy, so the values an action was selected from can be a few
+		// updates behind the ones it is learned with (the staleness
+		// in Metrics); results depend on thread timing
+		template<typename TState, typename TAction, typename TRNG = INumberSequenceGen> class ActorLearnerQLearning: public SharedTableQLearning<TState, TAction, TRNG> {
+		public:
+			enum {
+				QUEUE_CAPACITY = 4096,
+				MAX_BATCH_SIZE = 256,
+			};
+
+			// collected by ExecuteEpisodes; queue depths are sampled by
+			// the learner before it drains a ring, staleness is the number
+			// of updates made between an actor reading the table for a
+			// transition and the learner applying it
+			struct Metrics {
+			public:
+				Metrics() { Reset(); }
+
+				void Reset() {
+					secs = 0.0;
+
+					numTransitions = 0;
+					numBatches = 0;
+					numPushStalls = 0;
+
+					numQueueSamples = 0;
+					sumQueueDepth = 0;
+					maxQueueDepth = 0;
+
+					sumStaleness = 0;
+					maxStaleness = 0;
+				}
+
+				void Print() const {
+					const double numSamples = std::max(numQueueSamples, 1UL);
+					const double numUpdates = std::max(numTransitions, 1UL);
+					const double numBatchesDbl = std::max(numBatches, 1UL);
+
+					printf("[ActorLearnerQLearning::Metrics::%s]\n", __FUNCTION__);
+					printf("    throughput:  %.2f M transitions/sec (%lu in %.2f secs)\n", (numTransitions / std::max(secs, 1e-9)) * 1e-6, numTransitions, secs);
+					printf("    batches:     %lu (%.1f transitions per batch)\n", numBatches, numTransitions / numBatchesDbl);
+					printf("    queue depth: %.1f (mean), %u (max), %lu pushes stalled on a full queue\n", sumQueueDepth / numSamples, maxQueueDepth, numPushStalls);
+					printf("    staleness:   %.1f (mean), %u (max) updates\n", sumStaleness / numUpdates, maxStaleness);
+				}
+
+			public:
+				double secs;
+
+				unsigned long numTransitions;
+				unsigned long numBatches;
+				unsigned long numPushStalls;
+
+				unsigned long numQueueSamples;
+				unsigned long sumQueueDepth;
+				unsigned int maxQueueDepth;
+
+				unsigned long sumStaleness;
+				unsigned int maxStaleness;
+			};
+
+			ActorLearnerQLearning() {}
+			ActorLearnerQLearning(const TDLearnerParameters& parameters): SharedTableQLearning<TState, TAction, TRNG>(parameters) {}
+
+			static const char* GetName() { return "ActorLearnerQLearning"; }
+
+			// executes <numEpisodes> episodes in total, one thread per actor
+			// in <actors> (the first must be the owner of the table) taking
+			// the next episode as soon as its last one has ended, while the
+			// calling thread learns from their transitions; the reward of
+			// the n-th episode to start is stored at index n in <rewards>
+			//
+			// the first actor's thread decays its own parameters while the
+			// learner runs, so the learner works on a copy of them taken
+			// before any thread starts and its alpha is handed back to the
+			// owner once all have been joined
+			static void ExecuteEpisodes(ActorLearnerQLearning* const* actors, unsigned int numActors, unsigned int numEpisodes, float* rewards, Metrics* metrics) {
+				ActorLearnerQLearning* owner = actors[0];
+
+				assert(owner->mSharedValues == &owner->mActionValues);
+
+				std::vector< SPSCRing<Transition>* > rings(numActors, NULL);
+				SharedCounters counters;
+
+				TDLearnerParameters learnerParams = owner->mParameters;
+				unsigned int numSinkUpdates = 0;
+
+				counters.nextEpisode = 0;
+				counters.numUpdates = 0;
+				counters.numActorsDone = 0;
+				counters.numPushStalls = 0;
+
+				metrics->Reset();
+
+				Timer timer;
+				boost::thread_group actorThreads;
+
+				for (unsigned int k = 0; k < numActors; k++) {
+					assert(actors[k]->mSharedValues == actors[0]->mSharedValues);
+
+					rings[k] = new SPSCRing<Transition>(QUEUE_CAPACITY);
+					actorThreads.create_thread(boost::bind(&ActorLearnerQLearning::ActorThread, actors[k], rings[k], &counters, numEpisodes, rewards));
+				}
+
+				LearnerThread(owner->mSharedValues, owner->mStateIndex, rings, &counters, &learnerParams, &numSinkUpdates, metrics);
+				actorThreads.join_all();
+
+				metrics->secs = timer.GetElapsedSecs();
+				metrics->numPushStalls = counters.numPushStalls;
+
+				for (unsigned int k = 0; k < numActors; k++) {
+					delete rings[k];
+				}
+
+				owner->mParameters.SetAlpha(learnerParams.GetAlpha());
+				owner->mNumSinkUpdates += numSinkUpdates;
+				owner->mSharedValues->UpdateRowMaxima();
+			}
+
+		private:
+			struct Transition {
+				unsigned int stateID;
+				unsigned int nextStateID;
+				unsigned int actionID;
+				float reward;
+
+				// number of updates the learner had made when the action
+				// was selected, and whether the transition ended its episode
+				unsigned int numUpdates;
+				bool endsEpisode;
+			};
+
+			// updated atomically by all threads in ExecuteEpisodes
+			struct SharedCounters {
+				unsigned int nextEpisode;
+				unsigned int numUpdates;
+				unsigned int numActorsDone;
+				unsigned long numPushStalls;
+			};
+
+			void ActorThread(SPSCRing<Transition>* ring, SharedCounters* counters, unsigned int numEpisodes, float* rewards) {
+				const TDLearnerParameters& params = this->mParameters;
+
+				Transition transition;
+				TState state;
+
+				unsigned long numPushStalls = 0;
+
+				while (true) {
+					const unsigned int n = __atomic_fetch_add(&counters->nextEpisode, 1, __ATOMIC_RELAXED);
+
+					if (n >= numEpisodes)
+						break;
+
+					state = this->mInitialState;
+
+					if (params.GetRandomizeInitialStates())
+						state.Randomize(&this->mRandomNumbers);
+
+					float episodeReward = 0.0f;
+					unsigned int numActions = 0;
+
+					while (!state.IsTerminal()) {
+						if ((numActions++) >= params.GetMaxActions())
+							break;
+
+						transition.numUpdates = __atomic_load_n(&counters->numUpdates, __ATOMIC_RELAXED);
+						transition.stateID = state.GetID();
+						transition.actionID = this->SelectSharedActionID(state.GetID());
+
+						state = state.ApplyAction(TAction(transition.actionID), &transition.reward);
+
+						transition.nextStateID = state.GetID();
+						transition.endsEpisode = (state.IsTerminal() || numActions >= params.GetMaxActions());
+
+						episodeReward += transition.reward;
+
+						while (!ring->Push(transition)) {
+							numPushStalls += 1;
+							boost::this_thread::yield();
+						}
+					}
+
+					this->DecayParameters();
+					rewards[n] = episodeReward;
+				}
+
+				__atomic_fetch_add(&counters->numPushStalls, numPushStalls, __ATOMIC_RELAXED);
+				__atomic_fetch_add(&counters->numActorsDone, 1, __ATOMIC_RELEASE);
+			}
+
+			// touches no actor, only the shared table (through <values> and
+			// <index>) and the learner's own parameters <params>
+			static void LearnerThread(
+				ActionValueStorage* values,
+				const StateIndex* index,
+				const std::vector< SPSCRing<Transition>* >& rings,
+				SharedCounters* counters,
+				TDLearnerParameters* params,
+				unsigned int* numSinkUpdates,
+				Metrics* metrics
+			) {
+				Transition batch[MAX_BATCH_SIZE];
+
+				unsigned int numUpdates = 0;
+
+				while (true) {
+					// read before draining, so whatever an actor pushed
+					// before it was done is drained in this round
+					const bool actorsDone = (__atomic_load_n(&counters->numActorsDone, __ATOMIC_ACQUIRE) == rings.size());
+
+					unsigned int numDrained = 0;
+
+					for (unsigned int k = 0; k < rings.size(); k++) {
+						const unsigned int queueDepth = rings[k]->GetSize();
+
+						metrics->numQueueSamples += 1;
+						metrics->sumQueueDepth += queueDepth;
+						metrics->maxQueueDepth = std::max(metrics->maxQueueDepth, queueDepth);
+
+						const unsigned int batchSize = rings[k]->Pop(batch, MAX_BATCH_SIZE);
+
+						if (batchSize == 0)
+							continue;
+
+						for (unsigned int i = 0; i < batchSize; i++) {
+							const Transition& t = batch[i];
+							const unsigned int staleness = numUpdates - t.numUpdates;
+
+							if (!ActorLearnerQLearning::ApplyUpdate(values, index, t.stateID, t.nextStateID, t.actionID, t.reward, params->GetAlpha(), params->GetGamma()))
+								*numSinkUpdates += 1;
+
+							metrics->sumStaleness += staleness;
+							metrics->maxStaleness = std::max(metrics->maxStaleness, staleness);
+
+							if (t.endsEpisode) {
+								params->SetAlpha(std::max(params->GetAlpha() * params->GetAlphaDecay(), params->GetMinAlpha()));
+							}
+
+							numUpdates += 1;
+						}
+
+						__atomic_store_n(&counters->numUpdates, numUpdates, __ATOMIC_RELAXED);
+
+						metrics->numTransitions += batchSize;
+						metrics->numBatches += 1;
+
+						numDrained += batchSize;
+					}
+
+					if (numDrained != 0)
+						continue;
+					if (actorsDone)
+						break;
+
+					boost::this_thread::yield();
+				}
+			}
+		};
+	}
+}
+
+#endif
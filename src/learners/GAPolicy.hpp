@@ -30,8 +30,8 @@ namespace RELAX {
 			}
 
 			GAPolicy& CrossOver(const GAPolicy& father, const GAPolicy& mother) {
-				const std::vector<TState, TAction>& fatherGenes = father.GetGenes();
-				const std::vector<TState, TAction>& motherGenes = mother.GetGenes();
+				const typename PolicyBase<TState, TAction>::TStateActionTable& fatherGenes = father.GetGenes();
+				const typename PolicyBase<TState, TAction>::TStateActionTable& motherGenes = mother.GetGenes();
 
 				switch (mCrossOverType) {
 					case GA_CROSSOVER_ONE_POINT: {} break;
@@ -44,7 +44,7 @@ namespace RELAX {
 				return *this;
 			}
 
-			const std::vector<TState, TAction>& GetGenes() const { return (this->mStateActions); }
+			const typename PolicyBase<TState, TAction>::TStateActionTable& GetGenes() const { return (this->mStateActions); }
 		};
 	}
 }
@@ -0,0 +1,292 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "HashedActionValueTable.hpp"
+#include "../util/BinaryFile.hpp"
+
+using namespace RELAX::Learners;
+
+HashedActionValueTable::HashedActionValueTable(): mValues(NULL), mRowCapacity(0), mHashShift(32), mDefaultValue(0.0f), mNumRows(0), mNumCols(0), mRowStride(0) {
+}
+
+HashedActionValueTable::HashedActionValueTable(const HashedActionValueTable& t): mValues(NULL), mRowCapacity(0), mHashShift(32), mDefaultValue(0.0f), mNumRows(0), mNumCols(0), mRowStride(0) {
+	*this = t;
+}
+
+HashedActionValueTable& HashedActionValueTable::operator = (const HashedActionValueTable& t) {
+	if (this == &t) {
+		return *this;
+	}
+
+	Clear();
+
+	mDefaultValue = t.mDefaultValue;
+
+	if (t.IsEmpty()) {
+		return *this;
+	}
+
+	mNumRows = t.mNumRows;
+	mNumCols = t.mNumCols;
+	mRowStride = t.mRowStride;
+
+	ReserveRows(t.mRowInfos.size());
+	memcpy(mValues, t.mValues, t.mRowInfos.size() * mRowStride * sizeof(float));
+
+	mRowInfos = t.mRowInfos;
+	mSlots = t.mSlots;
+	mHashShift = t.mHashShift;
+	return *this;
+}
+
+
+
+void HashedActionValueTable::Resize(unsigned int numRows, unsigned int numCols) {
+	Clear();
+
+	mNumRows = numRows;
+	mNumCols = numCols;
+	mRowStride = ActionValueTable::CalcRowStride(numCols);
+
+	ResizeSlots(MIN_NUM_SLOTS);
+}
+
+void HashedActionValueTable::Clear() {
+	free(mValues);
+
+	mValues = NULL;
+	mRowInfos.clear();
+	mSlots.clear();
+
+	mRowCapacity = 0;
+	mHashShift = 32;
+
+	mNumRows = 0;
+	mNumCols = 0;
+	mRowStride = 0;
+}
+
+
+
+bool HashedActionValueTable::Save(const std::string& fileName, const std::string& taskName) const {
+	assert(!IsEmpty());
+
+	BinaryFile::Header header;
+	BinaryFile::InitHeader(&header, BinaryFile::CONTENT_ACTION_VALUES, BinaryFile::DTYPE_FLOAT32, BinaryFile::LAYOUT_HASHED_ROWS, taskName);
+
+	header.numStates = mNumRows;
+	header.numActions = mNumCols;
+	header.rowStride = mRowStride;
+	header.numSections = 3;
+
+	const void* sections[3] = {mValues, (mRowInfos.empty()? NULL: &mRowInfos[0]), &mDefaultValue};
+	const uint64_t sectionSizes[3] = {
+		static_cast<uint64_t>(mRowInfos.size()) * mRowStride * sizeof(float),
+		static_cast<uint64_t>(mRowInfos.size()) * sizeof(RowInfo),
+		sizeof(float),
+	};
+
+	return (BinaryFile::Write(fileName, &header, sections, sectionSizes));
+}
+
+bool HashedActionValueTable::Load(const std::string& fileName, const std::string& taskName, bool verify) {
+	BinaryFile::Header header;
+
+	void* data = NULL;
+	size_t size = 0;
+
+	if (!BinaryFile::Map(fileName, &header, &data, &size, verify)) {
+		return false;
+	}
+
+	bool ok = BinaryFile::CheckContent(fileName, header, BinaryFile::CONTENT_ACTION_VALUES, BinaryFile::DTYPE_FLOAT32, BinaryFile::LAYOUT_HASHED_ROWS, taskName);
+
+	if (ok && (header.numSections != 3 || header.sectionSizes[2] != sizeof(float))) {
+		printf("[HashedActionValueTable::%s] \"%s\": unexpected table layout\n", __FUNCTION__, fileName.c_str());
+		ok = false;
+	}
+
+	if (ok) {
+		const char* base = static_cast<const char*>(data);
+
+		const std::vector<char> values(base + header.sectionOffsets[0], base + header.sectionOffsets[0] + header.sectionSizes[0]);
+		const std::vector<char> rowInfos(base + header.sectionOffsets[1], base + header.sectionOffsets[1] + header.sectionSizes[1]);
+
+		memcpy(&mDefaultValue, base + header.sectionOffsets[2], sizeof(float));
+
+		if (!LoadState(header.numStates, header.numActions, values, rowInfos)) {
+			printf("[HashedActionValueTable::%s] \"%s\": unexpected table layout\n", __FUNCTION__, fileName.c_str());
+			ok = false;
+		}
+	}
+
+	BinaryFile::Unmap(data, size);
+	return ok;
+}
+
+void HashedActionValueTable::SaveState(std::vector<char>& values, std::vector<char>& rowInfos) const {
+	values.resize(mRowInfos.size() * mRowStride * sizeof(float));
+	rowInfos.resize(mRowInfos.size() * sizeof(RowInfo));
+
+	if (mRowInfos.empty())
+		return;
+
+	memcpy(&values[0], mValues, values.size());
+	memcpy(&rowInfos[0], &mRowInfos[0], rowInfos.size());
+}
+
+bool HashedActionValueTable::LoadState(unsigned int numRows, unsigned int numCols, const std::vector<char>& values, const std::vector<char>& rowInfos) {
+	const unsigned int numStoredRows = rowInfos.size() / sizeof(RowInfo);
+	const unsigned int rowStride = ActionValueTable::CalcRowStride(numCols);
+
+	if ((rowInfos.size() % sizeof(RowInfo)) != 0 || values.size() != (numStoredRows * rowStride * sizeof(float))) {
+		return false;
+	}
+
+	Resize(numRows, numCols);
+
+	if (numStoredRows == 0) {
+		return true;
+	}
+
+	mRowInfos.resize(numStoredRows);
+	memcpy(&mRowInfos[0], &rowInfos[0], rowInfos.size());
+
+	ReserveRows(numStoredRows);
+	memcpy(mValues, &values[0], values.size());
+
+	// rebuild the slots (sized as if the rows had been inserted one
+	// by one); rows are kept in their stored order
+	unsigned int numSlots = MIN_NUM_SLOTS;
+
+	while (numStoredRows * 2 > numSlots) {
+		numSlots *= 2;
+	}
+
+	for (unsigned int n = 0; n < numStoredRows; n++) {
+		if (mRowInfos[n].stateID >= numRows) {
+			Resize(numRows, numCols);
+			return false;
+		}
+	}
+
+	ResizeSlots(numSlots);
+	return true;
+}
+
+
+
+void HashedActionValueTable::GetMaxCols(unsigned int* cols) const {
+	// unstored rows are all-default, so their first column is the maximum
+	memset(cols, 0, mNumRows * sizeof(unsigned int));
+
+	for (unsigned int n = 0; n < mRowInfos.size(); n++) {
+		cols[mRowInfos[n].stateID] = mRowInfos[n].rowMax.col;
+	}
+}
+
+size_t HashedActionValueTable::GetSize() const {
+	const size_t valuesSize = static_cast<size_t>(mRowCapacity) * mRowStride * sizeof(float);
+	const size_t rowInfosSize = mRowInfos.capacity() * sizeof(RowInfo);
+	const size_t slotsSize = mSlots.capacity() * sizeof(Slot);
+
+	return (valuesSize + rowInfosSize + slotsSize);
+}
+
+size_t HashedActionValueTable::CalcMaxSize(unsigned int numStoredRows, unsigned int numCols) {
+	const size_t numRows = std::max(numStoredRows, static_cast<unsigned int>(MIN_NUM_SLOTS / 2));
+
+	const size_t valuesSize = numRows * 2 * ActionValueTable::CalcRowStride(numCols) * sizeof(float);
+	const size_t rowInfosSize = numRows * 2 * sizeof(RowInfo);
+	const size_t slotsSize = numRows * 4 * sizeof(Slot);
+
+	return (valuesSize + rowInfosSize + slotsSize);
+}
+
+
+
+unsigned int HashedActionValueTable::InsertRow(unsigned int stateID) {
+	assert(FindRow(stateID) == NO_ROW);
+
+	const unsigned int row = mRowInfos.size();
+
+	// keep the slots at most half full so probe sequences stay short
+	if ((row + 1) * 2 > mSlots.size()) {
+		ResizeSlots(mSlots.size() * 2);
+	}
+	if (row == mRowCapacity) {
+		ReserveRows(std::max(mRowCapacity * 2, static_cast<unsigned int>(MIN_NUM_SLOTS / 2)));
+	}
+
+	float* values = mValues + row * mRowStride;
+
+	for (unsigned int n = 0; n < mRowStride; n++) {
+		values[n] = (n < mNumCols)? mDefaultValue: 0.0f;
+	}
+
+	RowInfo info;
+	info.rowMax = ActionValueTable::RowMax(mDefaultValue);
+	info.stateID = stateID;
+
+	mRowInfos.push_back(info);
+
+	unsigned int slot = GetSlot(stateID);
+
+	while (mSlots[slot].row != NO_ROW) {
+		slot = (slot + 1) & (mSlots.size() - 1);
+	}
+
+	mSlots[slot].stateID = stateID;
+	mSlots[slot].row = row;
+	return row;
+}
+
+void HashedActionValueTable::ResizeSlots(unsigned int numSlots) {
+	Slot emptySlot;
+	emptySlot.stateID = 0;
+	emptySlot.row = NO_ROW;
+
+	mSlots.clear();
+	mSlots.resize(numSlots, emptySlot);
+
+	mHashShift = 32;
+
+	for (unsigned int n = numSlots; n > 1; n >>= 1) {
+		mHashShift -= 1;
+	}
+
+	for (unsigned int row = 0; row < mRowInfos.size(); row++) {
+		unsigned int slot = GetSlot(mRowInfos[row].stateID);
+
+		while (mSlots[slot].row != NO_ROW) {
+			slot = (slot + 1) & (numSlots - 1);
+		}
+
+		mSlots[slot].stateID = mRowInfos[row].stateID;
+		mSlots[slot].row = row;
+	}
+}
+
+void HashedActionValueTable::ReserveRows(unsigned int numRows) {
+	if (numRows <= mRowCapacity) {
+		return;
+	}
+
+	void* mem = NULL;
+
+	if (posix_memalign(&mem, ALIGNMENT, static_cast<size_t>(numRows) * mRowStride * sizeof(float)) != 0) {
+		mem = NULL;
+	}
+
+	assert(mem != NULL);
+
+	if (mValues != NULL) {
+		memcpy(mem, mValues, static_cast<size_t>(mRowInfos.size()) * mRowStride * sizeof(float));
+		free(mValues);
+	}
+
+	mValues = static_cast<float*>(mem);
+	mRowCapacity = numRows;
+}
@@ -0,0 +1,182 @@
+#ifndef RELAX_HASHEDACTIONVALUETABLE_HDR
+#define RELAX_HASHEDACTIONVALUETABLE_HDR
+
+#include <cassert>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "ActionValueTable.hpp"
+
+namespace RELAX {
+	namespace Learners {
+		// sparse counterpart of ActionValueTable: rows are only stored
+		// for states whose action-values were ever set, so the memory
+		// used scales with the number of visited states rather than
+		// with |S|; all other states read as a configurable default
+		// value (with column 0 as their argmax)
+		//
+		// state-ID's are mapped to rows through an open-addressing
+		// (linear probing) hash table of {stateID, row} slots that is
+		// kept at most half full; rows are appended to one aligned
+		// block with the same padded layout (and the same cached row
+		// maxima) as the dense table, so a stored row never moves
+		// relative to the others and the argmax kernels apply as-is
+		class HashedActionValueTable {
+		public:
+			enum {
+				SIMD_WIDTH = ActionValueTable::SIMD_WIDTH,
+				ALIGNMENT = ActionValueTable::ALIGNMENT,
+				MIN_NUM_SLOTS = 64,
+				NO_ROW = 0xFFFFFFFF,
+			};
+
+			HashedActionValueTable();
+			HashedActionValueTable(const HashedActionValueTable& t);
+			~HashedActionValueTable() { Clear(); }
+
+			// safe: operator= performs a deep-copy
+			HashedActionValueTable& operator = (const HashedActionValueTable& t);
+
+			// (re)sizes the logical table to <numRows> states and removes
+			// all stored rows, every state reads as the default value
+			void Resize(unsigned int numRows, unsigned int numCols);
+			void Clear();
+
+			// NOTE: only affects rows stored after the call
+			void SetDefaultValue(float v) { mDefaultValue = v; }
+			float GetDefaultValue() const { return mDefaultValue; }
+
+			// see ActionValueTable; Load copies the stored rows out of
+			// the mapped file (the slots are rebuilt, not stored)
+			bool Save(const std::string& fileName, const std::string& taskName) const;
+			bool Load(const std::string& fileName, const std::string& taskName, bool verify);
+
+			void SaveState(std::vector<char>& values, std::vector<char>& rowInfos) const;
+			bool LoadState(unsigned int numRows, unsigned int numCols, const std::vector<char>& values, const std::vector<char>& rowInfos);
+
+			template<unsigned int NUM_COLS> float GetValue(unsigned int row, unsigned int col) const {
+				assert(NUM_COLS == 0 || NUM_COLS == mNumCols);
+				assert(row < mNumRows);
+				assert(col < mNumCols);
+
+				const unsigned int idx = FindRow(row);
+
+				if (idx == NO_ROW)
+					return mDefaultValue;
+
+				return mValues[idx * GetStride<NUM_COLS>() + col];
+			}
+			template<unsigned int NUM_COLS> void SetValue(unsigned int row, unsigned int col, float v) {
+				assert(NUM_COLS == 0 || NUM_COLS == mNumCols);
+				assert(row < mNumRows);
+				assert(col < mNumCols);
+
+				unsigned int idx = FindRow(row);
+
+				if (idx == NO_ROW) {
+					idx = InsertRow(row);
+				}
+
+				float* values = mValues + idx * GetStride<NUM_COLS>();
+				values[col] = v;
+
+				ActionValueTable::UpdateRowMax<NUM_COLS>(mRowInfos[idx].rowMax, values, mNumCols, col, v);
+			}
+
+			float GetMaxValue(unsigned int row, unsigned int* col) const {
+				assert(row < mNumRows);
+
+				const unsigned int idx = FindRow(row);
+
+				if (idx == NO_ROW) {
+					*col = 0;
+					return mDefaultValue;
+				}
+
+				*col = mRowInfos[idx].rowMax.col;
+				return mRowInfos[idx].rowMax.value;
+			}
+			// only the first slot probed for <row> is prefetched, where
+			// its values are is not known until that arrives
+			void Prefetch(unsigned int row) const { __builtin_prefetch(&mSlots[GetSlot(row)]); }
+			// stores the argmax column of every (logical) row in <cols>
+			void GetMaxCols(unsigned int* cols) const;
+			// calls visitor(row, col) for the stored rows only, in the
+			// order they were inserted; every other row holds default
+			// values, so its argmax column is 0
+			template<typename TVisitor> void VisitMaxCols(TVisitor& visitor) const {
+				for (unsigned int n = 0; n < mRowInfos.size(); n++) {
+					visitor(mRowInfos[n].stateID, mRowInfos[n].rowMax.col);
+				}
+			}
+
+			unsigned int GetNumRows() const { return mNumRows; }
+			unsigned int GetNumCols() const { return mNumCols; }
+			unsigned int GetRowStride() const { return mRowStride; }
+			unsigned int GetNumStoredRows() const { return (mRowInfos.size()); }
+
+			bool IsEmpty() const { return (mNumCols == 0); }
+
+			// size in bytes of everything allocated (rows, row-info and
+			// slots, including the unused capacity of each)
+			size_t GetSize() const;
+			// upper bound of GetSize once <numStoredRows> rows have been
+			// inserted (every capacity grows by doubling, so at most half
+			// of it is unused)
+			static size_t CalcMaxSize(unsigned int numStoredRows, unsigned int numCols);
+
+		private:
+			struct Slot {
+				unsigned int stateID;
+				unsigned int row;
+			};
+			struct RowInfo {
+				ActionValueTable::RowMax rowMax;
+				unsigned int stateID;
+			};
+
+			template<unsigned int NUM_COLS> unsigned int GetStride() const {
+				return ((NUM_COLS != 0)? ActionValueTable::CalcRowStride(NUM_COLS): mRowStride);
+			}
+
+			// Fibonacci hashing: consecutive state-ID's are spread over
+			// the whole slot array rather than filling runs of it
+			unsigned int GetSlot(unsigned int stateID) const { return ((stateID * 2654435769U) >> mHashShift); }
+
+			unsigned int FindRow(unsigned int stateID) const {
+				for (unsigned int slot = GetSlot(stateID); ; slot = (slot + 1) & (mSlots.size() - 1)) {
+					const Slot& s = mSlots[slot];
+
+					if (s.row == NO_ROW)
+						return NO_ROW;
+					if (s.stateID == stateID)
+						return s.row;
+				}
+			}
+
+			// appends a row (all default values) for <stateID>, which
+			// must not be stored yet, and returns its index
+			unsigned int InsertRow(unsigned int stateID);
+			void ResizeSlots(unsigned int numSlots);
+			void ReserveRows(unsigned int numRows);
+
+		private:
+			float* mValues;
+
+			std::vector<RowInfo> mRowInfos;
+			std::vector<Slot> mSlots;
+
+			unsigned int mRowCapacity; // number of rows mValues can hold
+			unsigned int mHashShift;   // 32 - log2(mSlots.size())
+
+			float mDefaultValue;
+
+			unsigned int mNumRows;   // number of states
+			unsigned int mNumCols;   // number of actions
+			unsigned int mRowStride; // number of floats per row
+		};
+	}
+}
+
+#endif
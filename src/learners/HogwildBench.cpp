@@ -0,0 +1,65 @@
+#include <cstdio>
+#include "../Defines.hpp"
+
+// compares learning one HillClimber configuration (with a fine state
+// discretization) on a single thread through QLearning against learning
+// it on 1 to 8 threads sharing one table through HogwildQLearning:
+//
+//   - wall-clock time for the same total number of episodes
+//   - the learning curve (mean episode reward per tenth of episodes)
+//   - the quality of the greedy policy derived from the table, as its
+//     mean reward from the same random start states
+//
+// every Hogwild learner decays its parameters once per episode it runs
+// itself, so with N threads each uses the N-th power of the configured
+// decay to follow the single-threaded schedule per episode in total;
+// build with
+//
+//   g++ -O2 -DRELAX_HOGWILD_BENCHMARK -o hogwildbench  learners/*.cpp tasks/*.cpp util/*.cpp  -llua5.1 -lboost_thread -lboost_system -lpthread
+//
+#ifdef RELAX_HOGWILD_BENCHMARK
+#include <lua5.1/lua.hpp>
+
+#include "HogwildQLearning.hpp"
+#include "SharedTableBench.hpp"
+
+typedef Learners::HogwildQLearning<TState, TAction, TRNG> THogwildLearner;
+
+int main() {
+	lua_State* luaState = lua_open();
+	LuaParser luaParser(luaState);
+
+	if (!InitializeTask(luaParser))
+		return 1;
+
+	std::vector<float> rewards(NUM_EPISODES);
+	std::vector<unsigned int> actionIDs;
+
+	const double baseSecs = RunBaseLine(rewards, actionIDs);
+
+	for (unsigned int t = 0; t < NUM_THREAD_COUNTS; t++) {
+		const unsigned int numThreads = THREAD_COUNTS[t];
+
+		std::vector<TRNG*> rngs(numThreads);
+		std::vector<THogwildLearner*> learners(numThreads);
+
+		CreateLearners(rngs, learners, GetParameters(numThreads, numThreads));
+
+		Timer timer;
+		THogwildLearner::ExecuteEpisodes(&learners[0], numThreads, NUM_EPISODES, &rewards[0]);
+		const double secs = timer.GetElapsedSecs();
+
+		char name[32];
+		snprintf(name, sizeof(name), "Hogwild x%u", numThreads);
+
+		learners[0]->GetBestActionIDs(actionIDs);
+		PrintResult(name, secs, baseSecs, rewards, actionIDs);
+
+		DestroyLearners(rngs, learners);
+	}
+
+	lua_close(luaState);
+	return 0;
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef RELAX_HOGWILDQLEARNING_HDR
+#define RELAX_HOGWILDQLEARNING_HDR
+
+#include <cassert>
+#include <vector>
+
+#include "../Defines.hpp"
+#include "SharedTableQLearning.hpp"
+#include "../util/IThreadPoolJob.hpp"
+#include "../util/ThreadPool.hpp"
+
+namespace RELAX {
+	namespace Learners {
+		// Q-learning on a SharedTableQLearning table updated by every learner,
+		// each running its episodes on a separate thread without any locks
+		// ("Hogwild") and following its own epsilon and alpha schedule
+		//
+		// an update is a plain read-modify-write of relaxed atomic values,
+		// so a thread can overwrite another's concurrent update of the same
+		// value; with many more states than threads this is rare and the
+		// (stochastic) learning tolerates it, but results depend on thread
+		// timing and are not reproducible run-to-run
+		//
+		// the owner's row maxima are rebuilt by ExecuteEpisodes, so its
+		// GetBestActionIDs is valid once that returns
+		template<typename TState, typename TAction, typename TRNG = INumberSequenceGen> class HogwildQLearning: public SharedTableQLearning<TState, TAction, TRNG> {
+		public:
+			HogwildQLearning() {}
+			HogwildQLearning(const TDLearnerParameters& parameters): SharedTableQLearning<TState, TAction, TRNG>(parameters) {}
+
+			static const char* GetName() { return "HogwildQLearning"; }
+
+			// executes <numEpisodes> episodes in total on <numLearners>
+			// learners sharing one table, each learner on its own thread
+			// taking the next episode as soon as its last one has ended;
+			// the reward of the n-th episode to start is stored at index
+			// n in <rewards> (the learning curve of the shared table)
+			static void ExecuteEpisodes(HogwildQLearning* const* learners, unsigned int numLearners, unsigned int numEpisodes, float* rewards) {
+				std::vector<EpisodeJob*> jobs(numLearners, NULL);
+
+				ThreadPool threadPool(numLearners);
+				unsigned int nextEpisode = 0;
+
+				for (unsigned int k = 0; k < numLearners; k++) {
+					assert(learners[k]->mSharedValues == learners[0]->mSharedValues);
+
+					jobs[k] = new EpisodeJob(learners[k], &nextEpisode, numEpisodes, rewards);
+					threadPool.AddJob(jobs[k]);
+				}
+
+				threadPool.Execute();
+
+				for (unsigned int k = 0; k < numLearners; k++) {
+					delete jobs[k];
+				}
+
+				learners[0]->mSharedValues->UpdateRowMaxima();
+			}
+
+		private:
+			// runs episodes on one learner until all have been handed out
+			struct EpisodeJob: public IThreadPoolJob {
+			public:
+				EpisodeJob(HogwildQLearning* learner, unsigned int* nextEpisode, unsigned int numEpisodes, float* rewards):
+					mLearner(learner), mNextEpisode(nextEpisode), mNumEpisodes(numEpisodes), mRewards(rewards) {
+				}
+
+				void Execute() {
+					while (true) {
+						const unsigned int n = __atomic_fetch_add(mNextEpisode, 1, __ATOMIC_RELAXED);
+
+						if (n >= mNumEpisodes)
+							break;
+
+						mRewards[n] = mLearner->ExecuteEpisode(NULL);
+					}
+				}
+
+				// every job runs until the episodes are used up
+				unsigned long GetCost() const { return mNumEpisodes; }
+
+			private:
+				HogwildQLearning* mLearner;
+
+				unsigned int* mNextEpisode;
+				const unsigned int mNumEpisodes;
+
+				float* mRewards;
+			};
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,221 @@
+#include <cstdio>
+#include "../Defines.hpp"
+
+// compares executing the episodes of several Q-learners one after the
+// other (ExecuteEpisode, the serial loop) with interleaving them one
+// step at a time (BeginEpisode / StepEpisode in round-robin order, as
+// TDPolicy::LearnInterleaved does) on HillClimber, for total Q-table
+// sizes from 1 MB to 1 GB; both must give bit-identical results, the
+// interleaved loop should gain once the tables no longer fit in cache
+//
+// every size runs in a child process since HillClimber's multipliers
+// can only be set once per process; build with
+//
+//   g++ -O2 -DRELAX_INTERLEAVE_BENCHMARK -o interleavebench  learners/*.cpp tasks/*.cpp util/*.cpp  -llua5.1 -lboost_thread -lboost_system -lpthread
+//
+#ifdef RELAX_INTERLEAVE_BENCHMARK
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <lua5.1/lua.hpp>
+
+#include "QLearning.hpp"
+#include "../tasks/HillClimber.hpp"
+#include "../util/LuaParser.hpp"
+#include "../util/RandomNumberSequenceGen.hpp"
+#include "../util/Timer.hpp"
+
+using namespace RELAX;
+
+typedef Tasks::HillClimber TTask;
+typedef TTask::State TState;
+typedef TTask::Action TAction;
+typedef XS128x4RandomNumberSequenceGen TRNG;
+typedef Learners::QLearning<TState, TAction, TRNG> TLearner;
+
+static const unsigned int NUM_LEARNERS = 8;
+static const unsigned int NUM_EPISODES = 100;
+static const unsigned int MAX_EPISODE_ACTIONS = 2000;
+static const unsigned int VELOCITY_MULT = 10;
+
+struct LearnerSet {
+public:
+	LearnerSet() {
+		Learners::TDLearnerParameters params;
+		params.SetMaxActions(MAX_EPISODE_ACTIONS);
+		params.SetAlpha(0.1f);
+		params.SetGamma(0.99f);
+		params.SetEpsilon(0.3f);
+		params.SetRandomizeInitialStates(true);
+
+		for (unsigned int k = 0; k < NUM_LEARNERS; k++) {
+			rngs.push_back(new TRNG(100 + k));
+			learners.push_back(new TLearner(params));
+
+			learners[k]->SetInitialState(TState());
+			learners[k]->SetNumberSequenceGen(rngs[k]);
+			// random action-values fault in every page of the table
+			learners[k]->Initialize(rngs[k], true);
+		}
+
+		rewardSums.resize(NUM_LEARNERS, 0.0f);
+	}
+	~LearnerSet() {
+		for (unsigned int k = 0; k < NUM_LEARNERS; k++) {
+			delete learners[k];
+			delete rngs[k];
+		}
+	}
+
+	size_t GetSize() const {
+		size_t size = 0;
+
+		for (unsigned int k = 0; k < NUM_LEARNERS; k++) {
+			size += learners[k]->GetSize();
+		}
+
+		return size;
+	}
+
+	std::vector<TRNG*> rngs;
+	std::vector<TLearner*> learners;
+	std::vector<float> rewardSums;
+};
+
+static double ExecuteSerial(LearnerSet& set) {
+	Timer timer;
+
+	for (unsigned int k = 0; k < NUM_LEARNERS; k++) {
+		for (unsigned int n = 0; n < NUM_EPISODES; n++) {
+			set.rewardSums[k] += set.learners[k]->ExecuteEpisode(NULL);
+		}
+	}
+
+	return (timer.GetElapsedSecs());
+}
+
+// returns the time taken and stores the number of steps made in <numSteps>
+static double ExecuteInterleaved(LearnerSet& set, size_t* numSteps) {
+	std::vector<TLearner::EpisodeState> episodes(NUM_LEARNERS);
+	std::vector<unsigned int> numEpisodes(NUM_LEARNERS, 0);
+	std::vector<unsigned int> slots;
+
+	*numSteps = 0;
+
+	Timer timer;
+
+	for (unsigned int k = 0; k < NUM_LEARNERS; k++) {
+		set.learners[k]->BeginEpisode(episodes[k]);
+		slots.push_back(k);
+	}
+
+	while (!slots.empty()) {
+		for (unsigned int i = 0; i < slots.size(); /* no-op */) {
+			const unsigned int k = slots[i];
+
+			if (set.learners[k]->StepEpisode(episodes[k])) {
+				i += 1;
+				continue;
+			}
+
+			// StepEpisode counts the step that found the episode over
+			// only when it ended by running out of actions
+			*numSteps += std::min(episodes[k].numActions, MAX_EPISODE_ACTIONS);
+			set.rewardSums[k] += episodes[k].reward;
+
+			if ((numEpisodes[k] += 1) < NUM_EPISODES) {
+				set.learners[k]->BeginEpisode(episodes[k]);
+				i += 1;
+				continue;
+			}
+
+			slots[i] = slots.back();
+			slots.pop_back();
+		}
+	}
+
+	return (timer.GetElapsedSecs());
+}
+
+static int BenchSize(size_t totalSize) {
+	lua_State* luaState = lua_open();
+	LuaParser luaParser(luaState);
+
+	// a dense row (three actions padded to four floats) takes 16 bytes
+	// and there are (vmax - vmin) * VELOCITY_MULT + 1 velocities per
+	// position; the position range is [0, 2 * PI]
+	const double numStates = totalSize / (NUM_LEARNERS * 16.0);
+	const double numVelocities = 10.0 * VELOCITY_MULT + 1.0;
+	const unsigned int positionMult = std::max(1.0, numStates / (numVelocities * 2.0 * M_PI));
+
+	char script[256];
+	snprintf(script, sizeof(script), "return {Terrain = {}, Vehicle = {}, positionMult = %u, velocityMult = %u}", positionMult, VELOCITY_MULT);
+
+	if (!luaParser.Execute(script, false)) {
+		printf("[%s] error: %s\n", __FUNCTION__, (luaParser.GetError()).c_str());
+		return 1;
+	}
+
+	TTask::GetInstance().Initialize(luaParser.GetRootTbl());
+
+	size_t numSteps = 0;
+	double serialSecs = 0.0;
+	double interleavedSecs = 0.0;
+	size_t tableSize = 0;
+	bool identical = true;
+
+	{
+		LearnerSet serialSet;
+		LearnerSet interleavedSet;
+
+		tableSize = serialSet.GetSize();
+		serialSecs = ExecuteSerial(serialSet);
+		interleavedSecs = ExecuteInterleaved(interleavedSet, &numSteps);
+
+		for (unsigned int k = 0; k < NUM_LEARNERS; k++) {
+			const float serialValues[2] = {serialSet.rewardSums[k], serialSet.learners[k]->GetParameters().GetEpsilon()};
+			const float interleavedValues[2] = {interleavedSet.rewardSums[k], interleavedSet.learners[k]->GetParameters().GetEpsilon()};
+
+			identical = identical && (memcmp(serialValues, interleavedValues, sizeof(serialValues)) == 0);
+			identical = identical && (serialSet.rngs[k]->NextInt() == interleavedSet.rngs[k]->NextInt());
+		}
+	}
+
+	const char* format = "[%s] %8.2f MB of Q-tables (%u learners): %6.2f M steps/sec (serial), %6.2f M steps/sec (interleaved), %.2fx, identical: %d\n";
+	const double serialRate = numSteps / serialSecs;
+	const double interleavedRate = numSteps / interleavedSecs;
+
+	printf(format, __FUNCTION__, tableSize / (1024.0 * 1024.0), NUM_LEARNERS, serialRate * 1e-6, interleavedRate * 1e-6, interleavedRate / serialRate, identical);
+
+	lua_close(luaState);
+	return 0;
+}
+
+int main() {
+	const size_t MB = 1024 * 1024;
+	const size_t tableSizes[] = {1 * MB, 4 * MB, 16 * MB, 64 * MB, 256 * MB, 1024 * MB};
+
+	for (unsigned int n = 0; n < (sizeof(tableSizes) / sizeof(tableSizes[0])); n++) {
+		fflush(stdout);
+
+		const pid_t pid = fork();
+
+		if (pid < 0) {
+			printf("[%s] error: could not fork\n", __FUNCTION__);
+			return 1;
+		}
+		if (pid == 0) {
+			return (BenchSize(tableSizes[n]));
+		}
+
+		int status = 0;
+		waitpid(pid, &status, 0);
+	}
+
+	return 0;
+}
+
+#endif
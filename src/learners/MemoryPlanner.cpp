@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <cstdio>
+
+#include "MemoryPlanner.hpp"
+
+using namespace RELAX::Learners;
+
+static double ToMB(size_t size) { return (size / (1024.0 * 1024.0)); }
+
+MemoryPlanner::MemoryPlanner(size_t budget): mBudget(budget), mFixedSize(0), mPolicySize(0), mNumTables(0), mNumPolicies(0), mTablesPerThread(0) {
+	for (unsigned int mode = 0; mode < ActionValueStorage::NUM_STORAGE_MODES; mode++) {
+		mTableSizes[mode] = 0;
+		mMaxTableSizes[mode] = 0;
+		mDisabledModes[mode] = false;
+	}
+
+	mStorageMode = ActionValueStorage::STORAGE_DENSE;
+	mNumThreads = 1;
+	mConfiguredStorageMode = ActionValueStorage::STORAGE_DENSE;
+	mConfiguredNumThreads = 1;
+}
+
+void MemoryPlanner::AddTable(const size_t sizes[ActionValueStorage::NUM_STORAGE_MODES]) {
+	for (unsigned int mode = 0; mode < ActionValueStorage::NUM_STORAGE_MODES; mode++) {
+		mTableSizes[mode] += sizes[mode];
+		mMaxTableSizes[mode] = std::max(mMaxTableSizes[mode], sizes[mode]);
+	}
+
+	mNumTables += 1;
+}
+
+
+
+bool MemoryPlanner::Plan(unsigned int storageMode, unsigned int numThreads) {
+	mStorageMode = storageMode;
+	mNumThreads = numThreads;
+	mConfiguredStorageMode = storageMode;
+	mConfiguredNumThreads = numThreads;
+
+	if (mBudget == 0) {
+		return true;
+	}
+
+	// modes in order of preference: the configured one, then halving
+	// the table (bf16 keeps fp32's range, so it cannot overflow where
+	// fp32 did not), then only storing the states that get visited
+	unsigned int modes[3] = {storageMode, ActionValueStorage::STORAGE_BF16, ActionValueStorage::STORAGE_HASHED};
+	unsigned int numModes = 3;
+
+	if (storageMode >= ActionValueStorage::STORAGE_FP16) {
+		modes[1] = ActionValueStorage::STORAGE_HASHED;
+		numModes = 2;
+	}
+
+	for (unsigned int n = 0; n < numModes; n++) {
+		const unsigned int mode = modes[n];
+
+		if (mode != storageMode && mDisabledModes[mode]) {
+			continue;
+		}
+		if (!Fits(mode, 1)) {
+			continue;
+		}
+
+		mStorageMode = mode;
+		mNumThreads = numThreads;
+
+		while (!Fits(mode, mNumThreads)) {
+			mNumThreads -= 1;
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+void MemoryPlanner::Print() const {
+	printf("[MemoryPlanner::%s] fixed: %.2f MB, %u policies: %.2f MB, %u Q-tables (%u copies per thread)\n", __FUNCTION__, ToMB(mFixedSize), mNumPolicies, ToMB(mPolicySize), mNumTables, mTablesPerThread);
+
+	for (unsigned int mode = 0; mode < ActionValueStorage::NUM_STORAGE_MODES; mode++) {
+		const char* format = "[MemoryPlanner::%s]     %-6s: %10.2f MB of Q-tables, %10.2f MB in total with %u threads%s\n";
+		const char* status = mDisabledModes[mode]? " (not usable)": "";
+
+		printf(format, __FUNCTION__, ActionValueStorage::GetModeName(mode), ToMB(mTableSizes[mode]), ToMB(GetSize(mode, mConfiguredNumThreads)), mConfiguredNumThreads, status);
+	}
+
+	if (mBudget == 0) {
+		printf("[MemoryPlanner::%s] no budget, using \"%s\" storage and %u threads (%.2f MB)\n", __FUNCTION__, ActionValueStorage::GetModeName(mStorageMode), mNumThreads, ToMB(GetSize(mStorageMode, mNumThreads)));
+		return;
+	}
+
+	if (!Fits(mStorageMode, mNumThreads)) {
+		printf("[MemoryPlanner::%s] budget of %.2f MB is too small for every usable storage mode\n", __FUNCTION__, ToMB(mBudget));
+		return;
+	}
+
+	const char* format = "[MemoryPlanner::%s] budget %.2f MB, using \"%s\" storage (configured: \"%s\") and %u threads (configured: %u) for %.2f MB\n";
+	printf(format, __FUNCTION__, ToMB(mBudget), ActionValueStorage::GetModeName(mStorageMode), ActionValueStorage::GetModeName(mConfiguredStorageMode), mNumThreads, mConfiguredNumThreads, ToMB(GetSize(mStorageMode, mNumThreads)));
+}
+
+
+
+size_t MemoryPlanner::GetSize(unsigned int storageMode, unsigned int numThreads) const {
+	return (mFixedSize + mPolicySize + mTableSizes[storageMode] + numThreads * mTablesPerThread * mMaxTableSizes[storageMode]);
+}
+
+bool MemoryPlanner::Fits(unsigned int storageMode, unsigned int numThreads) const {
+	return (mBudget == 0 || GetSize(storageMode, numThreads) <= mBudget);
+}
@@ -0,0 +1,78 @@
+#ifndef RELAX_MEMORYPLANNER_HDR
+#define RELAX_MEMORYPLANNER_HDR
+
+#include <cstddef>
+
+#include "ActionValueStorage.hpp"
+
+namespace RELAX {
+	namespace Learners {
+		// adds up the memory an experiment will need before any of it is
+		// allocated and picks the action-value storage and the number of
+		// worker threads such that the total stays within a budget
+		//
+		// every Q-table is added with its size in each storage mode; the
+		// configured mode is kept if it fits, otherwise the first mode in
+		// {bf16 (unless a quantized mode was configured), hashed} that
+		// does is used, and the number of threads is then lowered until
+		// the copies of Q-tables they take (checkpoint snapshots) fit too
+		//
+		// policies are dense in every mode (one packed action per state,
+		// also with hashed Q-tables), and deriving them from the Q-tables
+		// needs no memory of its own (see TDLearnerBase::GetBestActionIDs)
+		class MemoryPlanner {
+		public:
+			// a <budget> of zero means unlimited (the configured storage
+			// and number of threads are always kept)
+			MemoryPlanner(size_t budget);
+
+			// memory needed regardless of storage and number of threads
+			void AddFixedSize(size_t size) { mFixedSize += size; }
+			// adds a policy (PI-table and reward traces) of <size> bytes,
+			// which is needed regardless of storage too
+			void AddPolicy(size_t size) { mPolicySize += size; mNumPolicies += 1; }
+			// adds a Q-table taking <sizes[mode]> bytes in each mode
+			void AddTable(const size_t sizes[ActionValueStorage::NUM_STORAGE_MODES]);
+			// excludes <mode> from being picked (eg. hashed storage for
+			// tasks that randomize initial action-values)
+			void DisableMode(unsigned int mode) { mDisabledModes[mode] = true; }
+			// each worker thread holds up to <n> copies of the (largest)
+			// Q-table at a time
+			void SetTablesPerThread(unsigned int n) { mTablesPerThread = n; }
+
+			// returns false if nothing fits, even with one thread
+			bool Plan(unsigned int storageMode, unsigned int numThreads);
+			void Print() const;
+
+			unsigned int GetStorageMode() const { return mStorageMode; }
+			unsigned int GetNumThreads() const { return mNumThreads; }
+
+			size_t GetBudget() const { return mBudget; }
+			size_t GetSize(unsigned int storageMode, unsigned int numThreads) const;
+
+		private:
+			bool Fits(unsigned int storageMode, unsigned int numThreads) const;
+
+		private:
+			const size_t mBudget;
+
+			size_t mFixedSize;
+			size_t mPolicySize;
+			size_t mTableSizes[ActionValueStorage::NUM_STORAGE_MODES];
+			size_t mMaxTableSizes[ActionValueStorage::NUM_STORAGE_MODES];
+
+			bool mDisabledModes[ActionValueStorage::NUM_STORAGE_MODES];
+
+			unsigned int mNumTables;
+			unsigned int mNumPolicies;
+			unsigned int mTablesPerThread;
+
+			unsigned int mStorageMode;
+			unsigned int mNumThreads;
+			unsigned int mConfiguredStorageMode;
+			unsigned int mConfiguredNumThreads;
+		};
+	}
+}
+
+#endif
@@ -1,16 +1,26 @@
 #ifndef RELAX_POLICYBASE_HDR
 #define RELAX_POLICYBASE_HDR
 
+#include <cstdio>
 #include <vector>
+#include <stdint.h>
+
+#include "StateActionTable.hpp"
+#include "StateIndex.hpp"
 #include "../Defines.hpp"
+#include "../util/BinaryFile.hpp"
 #include "../util/ISerializer.hpp"
 #include "../util/INumberSequenceGen.hpp"
+#include "../util/RandomNumberBuffer.hpp"
+#include "../util/RandomNumberStreams.hpp"
 #include "../util/LuaParser.hpp"
 
 namespace RELAX {
 	namespace Learners {
-		template<typename TState, typename TAction> class PolicyBase: public ISerializer {
+		template<typename TState, typename TAction, typename TRNG = INumberSequenceGen> class PolicyBase: public ISerializer {
 		public:
+			typedef StateActionTable<ActionIDBits<TAction::NUM_ACTIONS>::VALUE> TStateActionTable;
+
 			PolicyBase() {
 				mInitialized = false;
 				mLearned = false;
@@ -19,6 +29,11 @@ namespace RELAX {
 				mMaxEvaluationTrials = 0;
 				mMaxLearningEpisodes = 0;
 				mMaxEpisodeActions = 0;
+
+				mTrainEpisodeRewards = NULL;
+				mTrialEpisodeRewards = NULL;
+
+				mStateIndex = NULL;
 			}
 			PolicyBase(const LuaTable* table): ISerializer() {
 				mInitialized = false;
@@ -28,49 +43,79 @@ namespace RELAX {
 				mMaxEvaluationTrials = static_cast<unsigned int>(table->GetFltVal("maxEvaluationTrials", 0.0f));
 				mMaxLearningEpisodes = static_cast<unsigned int>(table->GetFltVal("maxLearningEpisodes", 0.0f));
 				mMaxEpisodeActions = static_cast<unsigned int>(table->GetFltVal("maxEpisodeActions", 0.0f));
+
+				mTrainEpisodeRewards = NULL;
+				mTrialEpisodeRewards = NULL;
+
+				mStateIndex = NULL;
 			}
 
-			PolicyBase(const PolicyBase& p): ISerializer() {
-				*this = p;
+			virtual ~PolicyBase() {
+				mStateActions.Clear();
+				mRewardsBlock.Free();
 			}
 
-			PolicyBase& operator = (const PolicyBase& p) {
-				// safe: operator= performs a 1D deep-copy
-				mStateActions = p.mStateActions;
-				mTrainEpisodeRewards = p.mTrainEpisodeRewards;
-				mTrialEpisodeRewards = p.mTrialEpisodeRewards;
+			// makes Initialize carve the state-action table and reward
+			// traces from <arena> (which must have been reserved by
+			// ReserveArena with the same parameter table)
+			void SetArena(Arena* arena) {
+				assert(!mInitialized);
+
+				mStateActions.SetArena(arena);
+				mRewardsBlock.SetArena(arena);
+			}
 
-				mInitialized = p.mInitialized;
-				mLearned = p.mLearned;
-				mEvaluated = p.mEvaluated;
+			// makes the state-action table hold only the states in <index>
+			// (which must be the one of the learner this policy is learned
+			// from); all other states share the action of its sink
+			void SetStateIndex(const StateIndex* index) {
+				assert(!mInitialized);
+				assert(index == NULL || index->GetNumStates() == (TState::GetMaxID() + 1));
+				mStateIndex = index;
+			}
 
-				mMaxEvaluationTrials = p.mMaxEvaluationTrials;
-				mMaxLearningEpisodes = p.mMaxLearningEpisodes;
-				mMaxEpisodeActions = p.mMaxEpisodeActions;
+			static void ReserveArena(Arena& arena, const LuaTable* table, const StateIndex* index) {
+				const unsigned int maxEvaluationTrials = static_cast<unsigned int>(table->GetFltVal("maxEvaluationTrials", 0.0f));
+				const unsigned int maxLearningEpisodes = static_cast<unsigned int>(table->GetFltVal("maxLearningEpisodes", 0.0f));
 
-				return *this;
+				TStateActionTable::ReserveArena(arena, GetNumRows(index));
+				arena.Reserve((maxLearningEpisodes + maxEvaluationTrials) * sizeof(float));
 			}
+			// size in bytes of the state-action table and reward traces
+			// of a policy with parameter table <table>
+			static size_t CalcSize(const LuaTable* table, const StateIndex* index) {
+				const unsigned int maxEvaluationTrials = static_cast<unsigned int>(table->GetFltVal("maxEvaluationTrials", 0.0f));
+				const unsigned int maxLearningEpisodes = static_cast<unsigned int>(table->GetFltVal("maxLearningEpisodes", 0.0f));
 
-			virtual ~PolicyBase() {
-				mStateActions.clear();
-				mTrainEpisodeRewards.clear();
-				mTrialEpisodeRewards.clear();
+				return (TStateActionTable::CalcSize(GetNumRows(index)) + (maxLearningEpisodes + maxEvaluationTrials) * sizeof(float));
+			}
+			static unsigned int GetNumRows(const StateIndex* index) {
+				return ((index != NULL)? index->GetNumRows(): (TState::GetMaxID() + 1));
 			}
 
 
 
-			void Initialize(INumberSequenceGen* nsg, bool randomize) {
+			void Initialize(TRNG* nsg, bool randomize) {
 				assert(!mInitialized);
-
-				mStateActions.resize(TState::GetMaxID() + 1);
-				mTrainEpisodeRewards.resize(mMaxLearningEpisodes, 0.0f);
-				mTrialEpisodeRewards.resize(mMaxEvaluationTrials, 0.0f);
+				assert(TAction::GetMaxID() <= TStateActionTable::MAX_ACTION_ID);
 
 				// the policy should contain an action for every
 				// possible state that can be encountered by the
 				// agent (so we ensure this by pre-initializing)
-				for (unsigned int n = 0; n <= TState::GetMaxID(); n++) {
-					mStateActions[n] = randomize? TAction::GetRandomActionID(nsg->NextInt()): TAction::GetDefaultActionID();
+				mStateActions.Resize(GetNumRows(mStateIndex), TAction::GetDefaultActionID());
+
+				// both reward traces share one (zero-filled) block
+				mTrainEpisodeRewards = static_cast<float*>(mRewardsBlock.Allocate((mMaxLearningEpisodes + mMaxEvaluationTrials) * sizeof(float)));
+				mTrialEpisodeRewards = mTrainEpisodeRewards + mMaxLearningEpisodes;
+
+				if (randomize) {
+					// as with random action-values (see TDLearnerBase), one
+					// key is drawn and each state's action hashed from it
+					const uint64_t key = nsg->NextInt();
+
+					for (unsigned int n = 0; n < mStateActions.GetNumStates(); n++) {
+						mStateActions.SetActionID(n, TAction::GetRandomActionID(CBRandomNumberSequenceGen::Hash(key, n) >> 32));
+					}
 				}
 
 				mInitialized = true;
@@ -78,15 +123,19 @@ namespace RELAX {
 
 
 			// NOTE: only called ONCE per policy
-			float Evaluate(INumberSequenceGen* nsg) /*const*/ {
+			float Evaluate(TRNG* nsg) /*const*/ {
 				assert(mInitialized);
 				assert(mLearned);
 				assert(!mEvaluated);
 
 				float policyReward = 0.0f;
 
+				// initial trial states are randomized from pre-generated
+				// numbers (drawn from <nsg> in bulk) as well
+				RandomNumberBuffer<TRNG> rngBuffer(nsg);
+
 				for (unsigned int n = 0; n < mMaxEvaluationTrials; n++) {
-					mTrialEpisodeRewards[n] = ExecuteEpisode(nsg);
+					mTrialEpisodeRewards[n] = ExecuteEpisode(&rngBuffer);
 					policyReward += mTrialEpisodeRewards[n];
 				}
 
@@ -95,48 +144,60 @@ namespace RELAX {
 			}
 
 
-			void Serialize(const std::string& fileName) {
+			// the file holds the packed words of mStateActions as-is
+			bool Serialize(const std::string& fileName) const {
 				assert(mInitialized);
 				assert(mLearned);
-				assert(mEvaluated);
 
-				mSerializerFileStream.open(fileName.c_str(), std::ios::in | std::ios::binary);
+				BinaryFile::Header header;
+				BinaryFile::InitHeader(&header, BinaryFile::CONTENT_STATE_ACTIONS, GetDataType(), BinaryFile::LAYOUT_PACKED_WORDS, TState::GetTaskName());
 
-				unsigned int numStates = TState::GetMaxID() + 1;
-				unsigned int numActions = TAction::GetMaxID() + 1;
+				header.numStates = mStateActions.GetNumStates();
+				header.numActions = TAction::GetMaxID() + 1;
+				header.numSections = 1;
 
-				if (!mSerializerFileStream.good()) {
-					// write the state-actions
-					mSerializerFileStream.close();
-					mSerializerFileStream.open(fileName.c_str(), std::ios::out | std::ios::binary);
+				const void* sections[1] = {mStateActions.GetWords()};
+				const uint64_t sectionSizes[1] = {mStateActions.GetSize()};
 
-					mSerializerFileStream.write(reinterpret_cast<const char*>(&numStates), sizeof(unsigned int));
-					mSerializerFileStream.write(reinterpret_cast<const char*>(&numActions), sizeof(unsigned int));
+				return (BinaryFile::Write(fileName, &header, sections, sectionSizes));
+			}
 
-					for (unsigned int n = 0; n < numStates; n++) {
-						mSerializerFileStream.write(reinterpret_cast<const char*>(&mStateActions[n]), sizeof(unsigned int));
-					}
-				} else {
-					// read the state-actions
-					mSerializerFileStream.read(reinterpret_cast<char*>(&numStates), sizeof(unsigned int));
-					mSerializerFileStream.read(reinterpret_cast<char*>(&numActions), sizeof(unsigned int));
-					mStateActions.resize(numStates);
+			bool Deserialize(const std::string& fileName) {
+				BinaryFile::Header header;
 
-					assert(numStates == (TState::GetMaxID() + 1));
-					assert(numActions == (TAction::GetMaxID() + 1));
+				void* data = NULL;
+				size_t size = 0;
 
-					for (unsigned int n = 0; n < numStates; n++) {
-						mSerializerFileStream.read(reinterpret_cast<char*>(&mStateActions[n]), sizeof(unsigned int));
-					}
+				if (!BinaryFile::Map(fileName, &header, &data, &size, true)) {
+					return false;
+				}
+
+				bool ok = BinaryFile::CheckContent(fileName, header, BinaryFile::CONTENT_STATE_ACTIONS, GetDataType(), BinaryFile::LAYOUT_PACKED_WORDS, TState::GetTaskName());
+
+				if (ok && (header.numStates != GetNumRows(mStateIndex) || header.numActions != (TAction::GetMaxID() + 1) || header.numSections != 1)) {
+					printf("[PolicyBase::%s] \"%s\": policy dimensions do not match the task\n", __FUNCTION__, fileName.c_str());
+					ok = false;
+				}
+				if (ok && header.sectionSizes[0] != TStateActionTable::CalcSize(header.numStates)) {
+					printf("[PolicyBase::%s] \"%s\": expected %u bytes of packed action-ID's, found %llu\n", __FUNCTION__, fileName.c_str(), TStateActionTable::CalcSize(header.numStates), static_cast<unsigned long long>(header.sectionSizes[0]));
+					ok = false;
+				}
+
+				if (ok) {
+					// the packed table is small enough to simply be copied
+					mStateActions.Assign(header.numStates, static_cast<const uint32_t*>(static_cast<const void*>(static_cast<const char*>(data) + header.sectionOffsets[0])));
+
+					mInitialized = true;
+					mLearned = true;
 				}
 
-				mSerializerFileStream.flush();
-				mSerializerFileStream.close();
+				BinaryFile::Unmap(data, size);
+				return ok;
 			}
 
 			// return the size in bytes claimed by the state-action
 			// table, excluding any internal data-structure overhead
-			unsigned int GetSize() const { return ((TState::GetMaxID() + 1) * sizeof(TAction)); }
+			unsigned int GetSize() const { return (mStateActions.GetSize()); }
 
 			unsigned int GetMaxEvaluationTrials() const { return mMaxEvaluationTrials; }
 			unsigned int GetMaxLearningEpisodes() const { return mMaxLearningEpisodes; }
@@ -145,8 +206,29 @@ namespace RELAX {
 			float GetTrainEpisodeReward(unsigned int k) const { return mTrainEpisodeRewards[k]; }
 			float GetTrialEpisodeReward(unsigned int k) const { return mTrialEpisodeRewards[k]; }
 
+			const TStateActionTable& GetStateActions() const { return mStateActions; }
+
 		private:
-			float ExecuteEpisode(INumberSequenceGen* nsg) {
+			// non-copyable, policies are constructed in place
+			PolicyBase(const PolicyBase&);
+			PolicyBase& operator = (const PolicyBase&);
+
+			static uint32_t GetDataType() {
+				const unsigned int bitsPerAction = TStateActionTable::BITS_PER_ACTION;
+
+				if (bitsPerAction == 2)
+					return BinaryFile::DTYPE_UINT2;
+				if (bitsPerAction == 4)
+					return BinaryFile::DTYPE_UINT4;
+
+				return BinaryFile::DTYPE_UINT8;
+			}
+
+			unsigned int GetRow(const TState& s) const {
+				return ((mStateIndex == NULL)? s.GetID(): mStateIndex->GetIndex(s.GetID()));
+			}
+
+			float ExecuteEpisode(RandomNumberBuffer<TRNG>* nsg) {
 				float episodeReward = 0.0f;
 				float actionReward = 0.0f;
 
@@ -159,9 +241,7 @@ namespace RELAX {
 					if (state.IsTerminal())
 						break;
 
-					assert(state.GetID() < mStateActions.size());
-
-					const TAction& action = mStateActions[state.GetID()];
+					const TAction action(mStateActions.GetActionID(GetRow(state)));
 					const TState& sstate = state.ApplyAction(action, &actionReward);
 
 					episodeReward += actionReward;
@@ -172,12 +252,20 @@ namespace RELAX {
 			}
 
 		protected:
-			// use a vector indexed by state ID's instead of
+			// use a table indexed by state ID's instead of
 			// a map<TState, TAction> for faster lookups (at
-			// the cost of increased memory use)
-			std::vector<TAction> mStateActions;
-			std::vector<float> mTrainEpisodeRewards;
-			std::vector<float> mTrialEpisodeRewards;
+			// the cost of increased memory use); it stores
+			// packed action ID's rather than TAction objects
+			TStateActionTable mStateActions;
+
+			// per-episode rewards of Learn and Evaluate (both point
+			// into mRewardsBlock)
+			float* mTrainEpisodeRewards;
+			float* mTrialEpisodeRewards;
+			ArenaBlock mRewardsBlock;
+
+			// NULL if every state has a row (then indexed by state-ID)
+			const StateIndex* mStateIndex;
 
 			bool mInitialized;
 			bool mLearned;
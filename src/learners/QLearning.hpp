@@ -9,12 +9,10 @@
 
 namespace RELAX {
 	namespace Learners {
-		template<typename TState, typename TAction> class QLearning: public TDLearnerBase<TState, TAction> {
+		template<typename TState, typename TAction, typename TRNG = INumberSequenceGen> class QLearning: public TDLearnerBase<TState, TAction, TRNG> {
 		public:
 			QLearning() {}
-			QLearning(const TDLearnerParameters& parameters): TDLearnerBase<TState, TAction>(parameters) {}
-			QLearning(const QLearning& q): TDLearnerBase<TState, TAction>(q.mParameters) { *this = q; }
-			QLearning& operator = (const QLearning& q) { TDLearnerBase<TState, TAction>::operator = (q); return *this; }
+			QLearning(const TDLearnerParameters& parameters): TDLearnerBase<TState, TAction, TRNG>(parameters) {}
 
 			static const char* GetName() { return "QLearning"; }
 
@@ -33,7 +31,7 @@ namespace RELAX {
 				TAction aaction;
 
 				if (params.GetRandomizeInitialStates())
-					state.Randomize(this->mNumberSeqGen);
+					state.Randomize(&this->mRandomNumbers);
 
 				#ifdef RELAX_LOG_LEARNER
 				{
@@ -58,7 +56,9 @@ namespace RELAX {
 					const TAction& action = SelectAction(state);
 					const TState& sstate = state.ApplyAction(action, &actionReward);
 
-					ApplyUpdateRule(state, sstate, action, aaction, actionReward);
+					// qualified call: binds statically, so the update-rule
+					// can be inlined into the loop
+					QLearning::ApplyUpdateRule(state, sstate, action, aaction, actionReward);
 					trace.AddActionReward(actionReward, false);
 
 					episodeReward += actionReward;
@@ -67,10 +67,7 @@ namespace RELAX {
 					state = sstate;
 				}
 
-				params.SetAlpha(params.GetAlpha() * params.GetAlphaDecay());
-				params.SetAlpha(std::max(params.GetAlpha(), params.GetMinAlpha()));
-				params.SetEpsilon(params.GetEpsilon() * params.GetEpsilonDecay());
-				params.SetEpsilon(std::max(params.GetEpsilon(), params.GetMinEpsilon()));
+				this->DecayParameters();
 
 				if (status != NULL) {
 					*status = (numActions < params.GetMaxActions());
@@ -87,21 +84,195 @@ namespace RELAX {
 				return episodeReward;
 			}
 
+			// executes one episode on each of <numLearners> learners in
+			// lockstep, one learner per lane: every step selects the action
+			// of each lane, applies them all through TState::ApplyActions
+			// and then makes each lane's update; lanes whose episode ended
+			// are masked off (moved out of the batch) until the last one
+			// has ended
+			//
+			// every learner draws the same random numbers and makes the same
+			// updates as in ExecuteEpisode, so results do not change; what
+			// is gained is that the lanes' table accesses are independent
+			// (their cache misses overlap) and the states are stepped as one
+			// batch; stores each lane's episode reward and status at its
+			// index in <rewards> and <statuses>
+			static void ExecuteEpisodes(QLearning* const* learners, unsigned int numLearners, float* rewards, bool* statuses) {
+				assert(numLearners <= QLearning::MAX_LANES);
+
+				// the states of the active lanes and their successors (the
+				// two are swapped after every step); lanes[i] is the learner
+				// whose state is at index i
+				typename TState::Batch batches[2];
+				TState state;
+
+				unsigned int lanes[QLearning::MAX_LANES];
+				unsigned int actionIDs[QLearning::MAX_LANES];
+				unsigned int numActions[QLearning::MAX_LANES];
+				float actionRewards[QLearning::MAX_LANES];
+				unsigned char terminals[QLearning::MAX_LANES];
+				bool ended[QLearning::MAX_LANES];
+
+				unsigned int numActiveLanes = numLearners;
+				unsigned int batchIdx = 0;
+
+				batches[0].Resize(numLearners);
+
+				for (unsigned int k = 0; k < numLearners; k++) {
+					QLearning* learner = learners[k];
+
+					assert(learner->mInitialized);
+
+					state = learner->mInitialState;
+
+					if (learner->mParameters.GetRandomizeInitialStates())
+						state.Randomize(&learner->mRandomNumbers);
+
+					batches[0].SetState(k, state);
+
+					lanes[k] = k;
+					rewards[k] = 0.0f;
+					numActions[k] = 0;
+					ended[k] = state.IsTerminal();
+				}
+
+				numActiveLanes = RemoveEndedLanes(batches[0], lanes, actionIDs, ended, numActiveLanes);
+
+				while (numActiveLanes != 0) {
+					typename TState::Batch& states = batches[batchIdx];
+					typename TState::Batch& nextStates = batches[batchIdx ^ 1];
+
+					for (unsigned int i = 0; i < numActiveLanes; i++) {
+						QLearning* learner = learners[lanes[i]];
+
+						if ((ended[i] = ((numActions[lanes[i]]++) >= learner->mParameters.GetMaxActions())))
+							continue;
+
+						actionIDs[i] = learner->SelectActionID(states.GetID(i));
+					}
+
+					if ((numActiveLanes = RemoveEndedLanes(states, lanes, actionIDs, ended, numActiveLanes)) == 0)
+						break;
+
+					TState::ApplyActions(states, &actionIDs[0], nextStates, &actionRewards[0], &terminals[0]);
+
+					for (unsigned int i = 0; i < numActiveLanes; i++) {
+						learners[lanes[i]]->ApplyUpdate(states.GetID(i), nextStates.GetID(i), actionIDs[i], actionRewards[i]);
+						rewards[lanes[i]] += actionRewards[i];
+						ended[i] = terminals[i];
+					}
+
+					numActiveLanes = RemoveEndedLanes(nextStates, lanes, actionIDs, ended, numActiveLanes);
+					batchIdx ^= 1;
+				}
+
+				for (unsigned int k = 0; k < numLearners; k++) {
+					learners[k]->DecayParameters();
+
+					if (statuses != NULL) {
+						statuses[k] = (numActions[k] < learners[k]->mParameters.GetMaxActions());
+					}
+				}
+			}
+
+			typedef typename TDLearnerBase<TState, TAction, TRNG>::EpisodeState EpisodeState;
+
+			// the same episode as ExecuteEpisode, suspended after every
+			// step (for TDPolicy::LearnInterleaved): each StepEpisode first
+			// makes the update of the previous step, then selects and takes
+			// the next action and prefetches the row of the state it led to,
+			// which the update (made on the next call) and the next action-
+			// selection read; by the time the other learners have made a step
+			// that row has arrived, so their cache misses overlap
+			void BeginEpisode(EpisodeState& episode) {
+				assert(this->mInitialized);
+
+				episode.state = this->mInitialState;
+
+				if (this->mParameters.GetRandomizeInitialStates())
+					episode.state.Randomize(&this->mRandomNumbers);
+
+				episode.numActions = 0;
+				episode.reward = 0.0f;
+				episode.updatePending = false;
+				episode.terminated = false;
+
+				this->PrefetchActionValues(episode.state.GetID());
+			}
+
+			// returns false once the episode has ended
+			bool StepEpisode(EpisodeState& episode) {
+				const TDLearnerParameters& params = this->mParameters;
+
+				if (episode.updatePending) {
+					ApplyUpdate(episode.state.GetID(), episode.nextState.GetID(), episode.actionID, episode.actionReward);
+
+					episode.reward += episode.actionReward;
+					episode.state = episode.nextState;
+					episode.updatePending = false;
+				}
+
+				if (episode.state.IsTerminal() || (episode.numActions++) >= params.GetMaxActions()) {
+					this->DecayParameters();
+
+					episode.terminated = (episode.numActions < params.GetMaxActions());
+					return false;
+				}
+
+				episode.actionID = this->SelectActionID(episode.state.GetID());
+				episode.nextState = episode.state.ApplyAction(TAction(episode.actionID), &episode.actionReward);
+				episode.updatePending = true;
+
+				this->PrefetchActionValues(episode.nextState.GetID());
+				return true;
+			}
+
 		private:
+			// moves the lanes that have not ended to the front of <states>
+			// (keeping <lanes> and <actionIDs> in step) and returns how many
+			// there are; the lanes are independent, so their order does not
+			// matter
+			static unsigned int RemoveEndedLanes(typename TState::Batch& states, unsigned int* lanes, unsigned int* actionIDs, bool* ended, unsigned int numLanes) {
+				TState state;
+
+				for (unsigned int i = 0; i < numLanes; /* no-op */) {
+					if (!ended[i]) {
+						i += 1;
+						continue;
+					}
+
+					numLanes -= 1;
+
+					states.GetState(numLanes, state);
+					states.SetState(i, state);
+
+					lanes[i] = lanes[numLanes];
+					actionIDs[i] = actionIDs[numLanes];
+					ended[i] = ended[numLanes];
+				}
+
+				states.Resize(numLanes);
+				return numLanes;
+			}
+
 			// NOTE:
 			//   what if <ss> is equal to <s> due to the discretization scheme?
 			//   does the update-rule still make any sense in such a situation?
 			void ApplyUpdateRule(const TState& s, const TState& ss, const TAction& a, const TAction&, float r) {
-				TAction maxQssa;
+				ApplyUpdate(s.GetID(), ss.GetID(), a.GetID(), r);
+			}
+
+			void ApplyUpdate(unsigned int stateID, unsigned int nextStateID, unsigned int actionID, float r) {
+				unsigned int maxQssa = 0;
 
 				const float alpha = this->mParameters.GetAlpha();
 				const float gamma = this->mParameters.GetGamma();
 
-				const float oldQsav  = GetActionValue(s, a);            // Q(s, a)
-				const float maxQssav = GetMaxActionValue(ss, maxQssa);  // Q(s', a*)
+				const float oldQsav  = this->GetActionValue(stateID, actionID);           // Q(s, a)
+				const float maxQssav = this->GetMaxActionValue(nextStateID, &maxQssa);    // Q(s', a*)
 				const float newQsav  = oldQsav + alpha * (r + gamma * maxQssav - oldQsav);
 
-				SetActionValue(s, a, newQsav);
+				this->SetActionValue(stateID, actionID, newQsav);
 			}
 		};
 	}
@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#include "ActionValueTable.hpp"
+#include "QuantizedActionValueTable.hpp"
+#include "../util/BinaryFile.hpp"
+
+using namespace RELAX::Learners;
+
+QuantizedActionValueTable::QuantizedActionValueTable(): mValues(NULL), mNumRows(0), mNumCols(0) {
+	SetCodec(CODEC_FP16, ROUNDING_NEAREST, INT16_MAX_CODE);
+}
+
+QuantizedActionValueTable::QuantizedActionValueTable(const QuantizedActionValueTable& t): mValues(NULL), mNumRows(0), mNumCols(0) {
+	SetCodec(CODEC_FP16, ROUNDING_NEAREST, INT16_MAX_CODE);
+	*this = t;
+}
+
+QuantizedActionValueTable& QuantizedActionValueTable::operator = (const QuantizedActionValueTable& t) {
+	if (this == &t) {
+		return *this;
+	}
+
+	Clear();
+	SetCodec(t.mCodec, t.mRounding, t.mRange);
+
+	if (!t.IsEmpty()) {
+		Resize(t.mNumRows, t.mNumCols);
+		memcpy(mValues, t.mValues, GetSize());
+	}
+
+	mNumUpdates = t.mNumUpdates;
+	return *this;
+}
+
+void QuantizedActionValueTable::SetCodec(unsigned int codec, unsigned int rounding, float range) {
+	assert(IsEmpty());
+	assert(range > 0.0f);
+
+	mCodec = codec;
+	mRounding = rounding;
+	mRange = range;
+	mStep = range / INT16_MAX_CODE;
+	mNumUpdates = 0;
+}
+
+
+
+void QuantizedActionValueTable::Resize(unsigned int numRows, unsigned int numCols) {
+	Clear();
+
+	mNumRows = numRows;
+	mNumCols = numCols;
+
+	// zero encodes 0.0 in every codec, so the zero-filled block needs
+	// no initialization
+	mValues = static_cast<uint16_t*>(mValuesBlock.Allocate(GetSize()));
+
+	assert(mValues != NULL);
+}
+
+void QuantizedActionValueTable::Clear() {
+	mValuesBlock.Free();
+
+	mValues = NULL;
+	mNumUpdates = 0;
+	mNumRows = 0;
+	mNumCols = 0;
+}
+
+void QuantizedActionValueTable::Randomize(uint64_t key, const StateIndex* index) {
+	assert(index == NULL || index->GetNumRows() == mNumRows);
+
+	for (unsigned int n = 0; n < mNumRows; n++) {
+		uint16_t* row = mValues + static_cast<size_t>(n) * mNumCols;
+
+		const unsigned int stateID = ActionValueTable::GetRandomValueID(index, n);
+
+		for (unsigned int k = 0; k < mNumCols; k++) {
+			row[k] = EncodeNearest(ActionValueTable::GetRandomValue(key, stateID, k, mNumCols));
+		}
+	}
+}
+
+
+
+bool QuantizedActionValueTable::Save(const std::string& fileName, const std::string& taskName) const {
+	assert(!IsEmpty());
+
+	static const uint32_t dataTypes[3] = {BinaryFile::DTYPE_FLOAT16, BinaryFile::DTYPE_BFLOAT16, BinaryFile::DTYPE_INT16};
+
+	BinaryFile::Header header;
+	BinaryFile::InitHeader(&header, BinaryFile::CONTENT_ACTION_VALUES, dataTypes[mCodec], BinaryFile::LAYOUT_PADDED_ROWS, taskName);
+
+	header.numStates = mNumRows;
+	header.numActions = mNumCols;
+	header.rowStride = mNumCols;
+	header.numSections = 2;
+
+	std::vector<char> values;
+	std::vector<char> state;
+
+	SaveState(values, state);
+
+	const void* sections[2] = {mValues, &state[0]};
+	const uint64_t sectionSizes[2] = {GetSize(), state.size()};
+
+	return (BinaryFile::Write(fileName, &header, sections, sectionSizes));
+}
+
+bool QuantizedActionValueTable::Load(const std::string& fileName, const std::string& taskName, bool verify) {
+	static const uint32_t dataTypes[3] = {BinaryFile::DTYPE_FLOAT16, BinaryFile::DTYPE_BFLOAT16, BinaryFile::DTYPE_INT16};
+
+	BinaryFile::Header header;
+
+	void* data = NULL;
+	size_t size = 0;
+
+	if (!BinaryFile::Map(fileName, &header, &data, &size, verify)) {
+		return false;
+	}
+
+	// the codec must match the one this table was configured with
+	bool ok = BinaryFile::CheckContent(fileName, header, BinaryFile::CONTENT_ACTION_VALUES, dataTypes[mCodec], BinaryFile::LAYOUT_PADDED_ROWS, taskName);
+
+	if (ok) {
+		const char* base = static_cast<const char*>(data);
+
+		const std::vector<char> values(base + header.sectionOffsets[0], base + header.sectionOffsets[0] + header.sectionSizes[0]);
+		const std::vector<char> state(base + header.sectionOffsets[1], base + header.sectionOffsets[1] + header.sectionSizes[1]);
+
+		if (header.numSections != 2 || header.rowStride != header.numActions || !LoadState(header.numStates, header.numActions, values, state)) {
+			printf("[QuantizedActionValueTable::%s] \"%s\": unexpected table layout\n", __FUNCTION__, fileName.c_str());
+			ok = false;
+		}
+	}
+
+	BinaryFile::Unmap(data, size);
+	return ok;
+}
+
+void QuantizedActionValueTable::SaveState(std::vector<char>& values, std::vector<char>& state) const {
+	State s;
+	s.codec = mCodec;
+	s.rounding = mRounding;
+	s.range = mRange;
+	s.numUpdates = mNumUpdates;
+
+	values.resize(GetSize());
+	state.resize(sizeof(State));
+
+	memcpy(&values[0], mValues, values.size());
+	memcpy(&state[0], &s, sizeof(State));
+}
+
+bool QuantizedActionValueTable::LoadState(unsigned int numRows, unsigned int numCols, const std::vector<char>& values, const std::vector<char>& state) {
+	State s;
+
+	if (values.size() != CalcSize(numRows, numCols) || state.size() != sizeof(State)) {
+		return false;
+	}
+
+	memcpy(&s, &state[0], sizeof(State));
+
+	if (s.codec != mCodec || s.range <= 0.0f) {
+		return false;
+	}
+
+	Clear();
+	SetCodec(s.codec, s.rounding, s.range);
+	Resize(numRows, numCols);
+
+	memcpy(mValues, &values[0], values.size());
+
+	mNumUpdates = s.numUpdates;
+	return true;
+}
+
+
+
+void QuantizedActionValueTable::GetMaxCols(unsigned int* cols) const {
+	for (unsigned int n = 0; n < mNumRows; n++) {
+		GetMaxValue<0>(n, &cols[n]);
+	}
+}
+
+
+
+uint16_t QuantizedActionValueTable::EncodeNearest(float v) const {
+	const uint32_t bits = FloatBits(v);
+
+	switch (mCodec) {
+		case CODEC_FP16: {
+			const uint32_t sign = (bits >> 16) & 0x8000;
+			const uint32_t absBits = bits & 0x7FFFFFFF;
+
+			uint32_t code = 0;
+
+			if (absBits >= 0x38800000) {
+				// normal half: round away the low 13 mantissa bits (ties
+				// to even) and re-bias the exponent from 127 to 15
+				code = ((absBits + 0x0FFF + ((absBits >> 13) & 1)) >> 13) - (112 << 10);
+			} else {
+				// subnormal half: a multiple of 2^-24
+				code = static_cast<uint32_t>(std::floor(BitsFloat(absBits) * 16777216.0f + 0.5f));
+			}
+
+			// saturate at the largest finite half (65504)
+			return (sign | std::min(code, 0x7BFFU));
+		} break;
+
+		case CODEC_BF16: {
+			// round away the low 16 bits (ties to even)
+			return ((bits + 0x7FFF + ((bits >> 16) & 1)) >> 16);
+		} break;
+
+		default: {
+		} break;
+	}
+
+	const float code = std::floor(v / mStep + 0.5f);
+	return (static_cast<uint16_t>(static_cast<int16_t>(std::max(-float(INT16_MAX_CODE), std::min(code, float(INT16_MAX_CODE))))));
+}
+
+uint16_t QuantizedActionValueTable::EncodeStochastic(float v, uint32_t dither) const {
+	const uint32_t bits = FloatBits(v);
+
+	// uniform in [0, 1)
+	const float u = (dither >> 8) * (1.0f / 16777216.0f);
+
+	switch (mCodec) {
+		case CODEC_FP16: {
+			const uint32_t sign = (bits >> 16) & 0x8000;
+			const uint32_t absBits = bits & 0x7FFFFFFF;
+
+			uint32_t code = 0;
+
+			if (absBits >= 0x38800000) {
+				// adding a random fraction of one unit-in-the-last-place
+				// before truncating rounds up with probability equal to
+				// the truncated fraction
+				code = ((absBits + (dither & 0x1FFF)) >> 13) - (112 << 10);
+			} else {
+				code = static_cast<uint32_t>(std::floor(BitsFloat(absBits) * 16777216.0f + u));
+			}
+
+			return (sign | std::min(code, 0x7BFFU));
+		} break;
+
+		case CODEC_BF16: {
+			return ((bits + (dither & 0xFFFF)) >> 16);
+		} break;
+
+		default: {
+		} break;
+	}
+
+	const float code = std::floor(v / mStep + u);
+	return (static_cast<uint16_t>(static_cast<int16_t>(std::max(-float(INT16_MAX_CODE), std::min(code, float(INT16_MAX_CODE))))));
+}
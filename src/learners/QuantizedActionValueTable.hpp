@@ -0,0 +1,215 @@
+#ifndef RELAX_QUANTIZEDACTIONVALUETABLE_HDR
+#define RELAX_QUANTIZEDACTIONVALUETABLE_HDR
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "StateIndex.hpp"
+#include "../util/Arena.hpp"
+
+namespace RELAX {
+	namespace Learners {
+		// stores every action-value in 16 bits, as an IEEE half (fp16),
+		// a bfloat16 (the upper half of an fp32) or a fixed-point int16
+		// with a configurable range; updates are still computed in fp32
+		// by the learner and only rounded (to nearest, or stochastically
+		// so that small updates are not lost on average) when stored
+		//
+		// rows are not padded and there is no row-maxima cache: for the
+		// small action-sets of our tasks, decoding and scanning a whole
+		// row is cheaper than reading a separate cache entry, and the
+		// table stays at 2 bytes per action-value (vs. 4 plus padding
+		// and 8 bytes per state for the cached maxima when dense)
+		//
+		// stochastic rounding draws its dither from a hash of the value's
+		// index, the fp32 value itself and a per-table update counter, so
+		// runs remain reproducible (the counter is part of the state)
+		class QuantizedActionValueTable {
+		public:
+			enum {
+				CODEC_FP16  = 0,
+				CODEC_BF16  = 1,
+				CODEC_INT16 = 2,
+			};
+			enum {
+				ROUNDING_NEAREST    = 0,
+				ROUNDING_STOCHASTIC = 1,
+			};
+			enum {
+				INT16_MAX_CODE = 32767,
+			};
+
+			QuantizedActionValueTable();
+			QuantizedActionValueTable(const QuantizedActionValueTable& t);
+			~QuantizedActionValueTable() { Clear(); }
+
+			// safe: operator= performs a deep-copy
+			QuantizedActionValueTable& operator = (const QuantizedActionValueTable& t);
+
+			// must be called before Resize; <range> is the largest value
+			// representable by CODEC_INT16 (and ignored by the others)
+			void SetCodec(unsigned int codec, unsigned int rounding, float range);
+
+			unsigned int GetCodec() const { return mCodec; }
+			unsigned int GetRounding() const { return mRounding; }
+
+			// (re)allocates the table, all values are set to zero (O(1),
+			// see ActionValueTable)
+			void Resize(unsigned int numRows, unsigned int numCols);
+			void Clear();
+
+			// see ActionValueTable
+			void SetArena(Arena* arena) { mValuesBlock.SetArena(arena); }
+
+			static void ReserveArena(Arena& arena, unsigned int numRows, unsigned int numCols) {
+				arena.Reserve(CalcSize(numRows, numCols));
+			}
+
+			// see ActionValueTable (values are stored with nearest rounding)
+			void Randomize(uint64_t key, const StateIndex* index = NULL);
+
+			// see ActionValueTable (files are always copied on load)
+			bool Save(const std::string& fileName, const std::string& taskName) const;
+			bool Load(const std::string& fileName, const std::string& taskName, bool verify);
+
+			// <state> holds the codec parameters and the update counter
+			void SaveState(std::vector<char>& values, std::vector<char>& state) const;
+			bool LoadState(unsigned int numRows, unsigned int numCols, const std::vector<char>& values, const std::vector<char>& state);
+
+			template<unsigned int NUM_COLS> float GetValue(unsigned int row, unsigned int col) const {
+				return (Decode(mValues[GetIndex<NUM_COLS>(row, col)]));
+			}
+			template<unsigned int NUM_COLS> void SetValue(unsigned int row, unsigned int col, float v) {
+				const unsigned int idx = GetIndex<NUM_COLS>(row, col);
+
+				mValues[idx] = Encode(v, idx);
+				mNumUpdates += 1;
+			}
+
+			// returns the largest (decoded) value in <row> and stores the
+			// first column holding it in <col>
+			template<unsigned int NUM_COLS> float GetMaxValue(unsigned int row, unsigned int* col) const {
+				const unsigned int numCols = (NUM_COLS != 0)? NUM_COLS: mNumCols;
+				const uint16_t* codes = mValues + GetIndex<NUM_COLS>(row, 0);
+
+				float maxValue = Decode(codes[0]);
+				unsigned int maxCol = 0;
+
+				for (unsigned int n = 1; n < numCols; n++) {
+					const float v = Decode(codes[n]);
+
+					if (v > maxValue) {
+						maxValue = v;
+						maxCol = n;
+					}
+				}
+
+				*col = maxCol;
+				return maxValue;
+			}
+			void GetMaxCols(unsigned int* cols) const;
+			// see ActionValueTable
+			template<typename TVisitor> void VisitMaxCols(TVisitor& visitor) const {
+				for (unsigned int n = 0; n < mNumRows; n++) {
+					unsigned int col = 0;
+					GetMaxValue<0>(n, &col);
+					visitor(n, col);
+				}
+			}
+
+			void Prefetch(unsigned int row) const { __builtin_prefetch(mValues + GetIndex<0>(row, 0)); }
+
+			unsigned int GetNumRows() const { return mNumRows; }
+			unsigned int GetNumCols() const { return mNumCols; }
+
+			bool IsEmpty() const { return (mValues == NULL); }
+
+			size_t GetSize() const { return (CalcSize(mNumRows, mNumCols)); }
+			static size_t CalcSize(unsigned int numRows, unsigned int numCols) { return (static_cast<size_t>(numRows) * numCols * sizeof(uint16_t)); }
+
+			// the value <v> would read back as after being stored with
+			// nearest rounding (used for accuracy reports)
+			float RoundTrip(float v) const { return (Decode(EncodeNearest(v))); }
+
+			float Decode(uint16_t code) const {
+				switch (mCodec) {
+					case CODEC_FP16: { return (DecodeFP16(code)); } break;
+					case CODEC_BF16: { return (DecodeBF16(code)); } break;
+					default: {} break;
+				}
+
+				return (static_cast<int16_t>(code) * mStep);
+			}
+
+		private:
+			struct State {
+				unsigned int codec;
+				unsigned int rounding;
+				float range;
+				unsigned int numUpdates;
+			};
+
+			template<unsigned int NUM_COLS> unsigned int GetIndex(unsigned int row, unsigned int col) const {
+				assert(NUM_COLS == 0 || NUM_COLS == mNumCols);
+				assert(row < mNumRows);
+				assert(col < mNumCols);
+
+				return (row * ((NUM_COLS != 0)? NUM_COLS: mNumCols) + col);
+			}
+
+			uint16_t Encode(float v, unsigned int idx) const {
+				if (mRounding == ROUNDING_NEAREST)
+					return (EncodeNearest(v));
+
+				return (EncodeStochastic(v, GetDither(v, idx)));
+			}
+			uint16_t EncodeNearest(float v) const;
+			// <dither> is uniform over all 32-bit values
+			uint16_t EncodeStochastic(float v, uint32_t dither) const;
+
+			uint32_t GetDither(float v, unsigned int idx) const {
+				uint32_t h = (idx * 0x9E3779B1U) ^ FloatBits(v) ^ (mNumUpdates * 0x85EBCA77U);
+
+				h ^= (h >> 16); h *= 0x7FEB352DU;
+				h ^= (h >> 15); h *= 0x846CA68BU;
+				h ^= (h >> 16);
+				return h;
+			}
+
+			static uint32_t FloatBits(float v) { uint32_t u; memcpy(&u, &v, sizeof(u)); return u; }
+			static float BitsFloat(uint32_t u) { float v; memcpy(&v, &u, sizeof(v)); return v; }
+
+			static float DecodeBF16(uint16_t code) { return (BitsFloat(static_cast<uint32_t>(code) << 16)); }
+			static float DecodeFP16(uint16_t code) {
+				// move exponent and mantissa into place and re-bias the
+				// exponent by multiplying with 2^112 (which also handles
+				// subnormal halves); codes are never Inf or NaN
+				const float magnitude = BitsFloat(static_cast<uint32_t>(code & 0x7FFF) << 13) * 5.192296858534828e33f;
+				return ((code & 0x8000)? -magnitude: magnitude);
+			}
+
+		private:
+			uint16_t* mValues;
+			ArenaBlock mValuesBlock;
+
+			unsigned int mCodec;
+			unsigned int mRounding;
+
+			float mRange; // CODEC_INT16 only
+			float mStep;  // value of one int16 step (mRange / INT16_MAX_CODE)
+
+			// number of SetValue calls, seeds the stochastic rounding
+			unsigned int mNumUpdates;
+
+			unsigned int mNumRows; // number of states
+			unsigned int mNumCols; // number of actions
+		};
+	}
+}
+
+#endif
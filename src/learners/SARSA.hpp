@@ -6,12 +6,10 @@
 
 namespace RELAX {
 	namespace Learners {
-		template<typename TState, typename TAction> class SARSA: public TDLearnerBase<TState, TAction> {
+		template<typename TState, typename TAction, typename TRNG = INumberSequenceGen> class SARSA: public TDLearnerBase<TState, TAction, TRNG> {
 		public:
 			SARSA() {}
-			SARSA(const TDLearnerParameters& parameters): TDLearnerBase<TState, TAction>(parameters) {}
-			SARSA(const SARSA& s): TDLearnerBase<TState, TAction>(s.mParameters) { *this = s; }
-			SARSA& operator = (const SARSA& s) { TDLearnerBase<TState, TAction>::operator = (s); return *this; }
+			SARSA(const TDLearnerParameters& parameters): TDLearnerBase<TState, TAction, TRNG>(parameters) {}
 
 			static const char* GetName() { return "SARSA"; }
 
@@ -25,7 +23,7 @@ namespace RELAX {
 				TAction action = SelectAction(state);
 
 				if (params.GetRandomizeInitialStates())
-					state.Randomize(this->mNumberSeqGen);
+					state.Randomize(&this->mRandomNumbers);
 
 				#ifdef RELAX_LOG_LEARNER
 				{
@@ -50,7 +48,9 @@ namespace RELAX {
 					const TState& sstate = state.ApplyAction(action, &actionReward);
 					const TAction& aaction = SelectAction(sstate);
 
-					ApplyUpdateRule(state, sstate, action, aaction, actionReward);
+					// qualified call: binds statically, so the update-rule
+					// can be inlined into the loop
+					SARSA::ApplyUpdateRule(state, sstate, action, aaction, actionReward);
 					trace.AddActionReward(actionReward, false);
 
 					episodeReward += actionReward;
@@ -60,10 +60,7 @@ namespace RELAX {
 					action = aaction;
 				}
 
-				params.SetAlpha(params.GetAlpha() * params.GetAlphaDecay());
-				params.SetAlpha(std::max(params.GetAlpha(), params.GetMinAlpha()));
-				params.SetEpsilon(params.GetEpsilon() * params.GetEpsilonDecay());
-				params.SetEpsilon(std::max(params.GetEpsilon(), params.GetMinEpsilon()));
+				this->DecayParameters();
 
 				if (status != NULL) {
 					*status = (numActions < params.GetMaxActions());
@@ -0,0 +1,169 @@
+#ifndef RELAX_SHAREDTABLEBENCH_HDR
+#define RELAX_SHAREDTABLEBENCH_HDR
+
+// fixtures shared by the benchmarks comparing single-threaded QLearning
+// on one HillClimber configuration (with a fine state discretization)
+// against the SharedTableQLearning learners (HogwildBench.cpp and
+// ActorLearnerBench.cpp); only included by those
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "QLearning.hpp"
+#include "../tasks/HillClimber.hpp"
+#include "../util/LuaParser.hpp"
+#include "../util/RandomNumberSequenceGen.hpp"
+#include "../util/Timer.hpp"
+
+using namespace RELAX;
+
+typedef Tasks::HillClimber TTask;
+typedef TTask::State TState;
+typedef TTask::Action TAction;
+typedef XS128x4RandomNumberSequenceGen TRNG;
+typedef Learners::QLearning<TState, TAction, TRNG> TLearner;
+
+static const unsigned int NUM_EPISODES = 40000;
+static const unsigned int NUM_CURVE_WINDOWS = 10;
+static const unsigned int NUM_EVAL_EPISODES = 1000;
+static const unsigned int MAX_EPISODE_ACTIONS = 5000;
+
+static const float ALPHA_DECAY = 0.9999f;
+static const float EPSILON_DECAY = 0.9999f;
+
+// the numbers of threads every benchmark runs its shared table on
+static const unsigned int THREAD_COUNTS[] = {1, 2, 4, 8};
+static const unsigned int NUM_THREAD_COUNTS = sizeof(THREAD_COUNTS) / sizeof(THREAD_COUNTS[0]);
+
+// with alpha (epsilon) decayed <alphaDecayPower> (<epsilonDecayPower>)
+// times as often as by a single-threaded learner, each decay uses that
+// power of the configured one to follow the same schedule per episode
+static Learners::TDLearnerParameters GetParameters(unsigned int alphaDecayPower, unsigned int epsilonDecayPower) {
+	Learners::TDLearnerParameters params;
+
+	params.SetMaxActions(MAX_EPISODE_ACTIONS);
+	params.SetAlpha(0.5f);
+	params.SetGamma(0.99f);
+	params.SetEpsilon(0.5f);
+	params.SetMinAlpha(0.05f);
+	params.SetMinEpsilon(0.01f);
+	params.SetAlphaDecay(std::pow(ALPHA_DECAY, float(alphaDecayPower)));
+	params.SetEpsilonDecay(std::pow(EPSILON_DECAY, float(epsilonDecayPower)));
+	params.SetRandomizeInitialStates(true);
+
+	return params;
+}
+
+// mean reward of the greedy policy <actionIDs> (indexed by state-ID)
+// over NUM_EVAL_EPISODES episodes from the same random start states;
+// stores the fraction of them reaching the goal in <goalRate>
+static float EvaluatePolicy(const std::vector<unsigned int>& actionIDs, float* goalRate) {
+	TRNG rng(4321);
+	TState state;
+
+	float rewardSum = 0.0f;
+	unsigned int numGoals = 0;
+
+	for (unsigned int n = 0; n < NUM_EVAL_EPISODES; n++) {
+		unsigned int numActions = 0;
+
+		state.Randomize(&rng);
+
+		while (!state.IsTerminal() && (numActions++) < MAX_EPISODE_ACTIONS) {
+			float reward = 0.0f;
+
+			state = state.ApplyAction(TAction(actionIDs[state.GetID()]), &reward);
+			rewardSum += reward;
+		}
+
+		numGoals += state.IsTerminal();
+	}
+
+	*goalRate = numGoals / float(NUM_EVAL_EPISODES);
+	return (rewardSum / NUM_EVAL_EPISODES);
+}
+
+static void PrintResult(const char* name, double secs, double baseSecs, const std::vector<float>& rewards, const std::vector<unsigned int>& actionIDs) {
+	const unsigned int windowSize = NUM_EPISODES / NUM_CURVE_WINDOWS;
+
+	float goalRate = 0.0f;
+	const float policyReward = EvaluatePolicy(actionIDs, &goalRate);
+
+	printf("[%s] %-12s %7.2f secs (%5.2fx), policy reward %9.2f (goal %5.1f%%), curve:", __FUNCTION__, name, secs, baseSecs / secs, policyReward, goalRate * 100.0f);
+
+	for (unsigned int w = 0; w < NUM_CURVE_WINDOWS; w++) {
+		double sum = 0.0;
+
+		for (unsigned int n = w * windowSize; n < (w + 1) * windowSize; n++) {
+			sum += rewards[n];
+		}
+
+		printf(" %.1f", sum / windowSize);
+	}
+
+	printf("\n");
+}
+
+static bool InitializeTask(LuaParser& luaParser) {
+	if (!luaParser.Execute("return {Terrain = {}, Vehicle = {}, positionMult = 200, velocityMult = 20}", false)) {
+		printf("[%s] error: %s\n", __FUNCTION__, (luaParser.GetError()).c_str());
+		return false;
+	}
+
+	TTask::GetInstance().Initialize(luaParser.GetRootTbl());
+
+	printf("[%s] %u states, %u episodes (at most %u actions each)\n", __FUNCTION__, TState::GetMaxID() + 1, NUM_EPISODES, MAX_EPISODE_ACTIONS);
+	return true;
+}
+
+// learns on a single thread through QLearning (the baseline every
+// shared-table run is compared against); returns its wall-clock time
+static double RunBaseLine(std::vector<float>& rewards, std::vector<unsigned int>& actionIDs) {
+	TRNG rng(100);
+	TLearner learner(GetParameters(1, 1));
+
+	learner.SetInitialState(TState());
+	learner.SetNumberSequenceGen(&rng);
+	learner.Initialize(&rng, false);
+
+	Timer timer;
+
+	for (unsigned int n = 0; n < NUM_EPISODES; n++) {
+		rewards[n] = learner.ExecuteEpisode(NULL);
+	}
+
+	const double secs = timer.GetElapsedSecs();
+
+	learner.GetBestActionIDs(actionIDs);
+	PrintResult("QLearning", secs, secs, rewards, actionIDs);
+
+	return secs;
+}
+
+// fills <learners> (and their <rngs>) with learners on one table, the
+// first owning it and the others sharing it
+template<typename TSharedLearner> static void CreateLearners(std::vector<TRNG*>& rngs, std::vector<TSharedLearner*>& learners, const Learners::TDLearnerParameters& params) {
+	for (unsigned int k = 0; k < learners.size(); k++) {
+		rngs[k] = new TRNG(100 + k);
+		learners[k] = new TSharedLearner(params);
+
+		learners[k]->SetInitialState(TState());
+		learners[k]->SetNumberSequenceGen(rngs[k]);
+
+		if (k == 0) {
+			learners[k]->Initialize(rngs[k], false);
+		} else {
+			learners[k]->Share(*learners[0]);
+		}
+	}
+}
+
+// sharers are deleted before the owner of their table
+template<typename TSharedLearner> static void DestroyLearners(std::vector<TRNG*>& rngs, std::vector<TSharedLearner*>& learners) {
+	for (unsigned int k = learners.size(); k > 0; k--) {
+		delete learners[k - 1];
+		delete rngs[k - 1];
+	}
+}
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef RELAX_SHAREDTABLEQLEARNING_HDR
+#define RELAX_SHAREDTABLEQLEARNING_HDR
+
+#include <cassert>
+
+#include "../Defines.hpp"
+#include "TDLearnerBase.hpp"
+
+namespace RELAX {
+	namespace Learners {
+		// Q-learning on one action-value table shared by several learners
+		// on separate threads (see HogwildQLearning and ActorLearnerQLearning):
+		// one learner owns the table (Initialize), the others act on it
+		// through Share; each keeps its own parameters (so its own epsilon
+		// schedule) and draws from its own RNG
+		//
+		// the table is read and written with relaxed atomic values, so
+		// only dense storage can be shared; the owner's cached row maxima
+		// are stale while learning and must be rebuilt (UpdateRowMaxima)
+		// before its GetBestActionIDs is valid
+		template<typename TState, typename TAction, typename TRNG = INumberSequenceGen> class SharedTableQLearning: public TDLearnerBase<TState, TAction, TRNG> {
+		public:
+			SharedTableQLearning(): mSharedValues(NULL) {}
+			SharedTableQLearning(const TDLearnerParameters& parameters): TDLearnerBase<TState, TAction, TRNG>(parameters), mSharedValues(NULL) {}
+
+			// allocates the table this learner owns and shares
+			void Initialize(TRNG* nsg, bool randomize) {
+				assert(this->mParameters.GetStorageMode() == ActionValueStorage::STORAGE_DENSE);
+
+				TDLearnerBase<TState, TAction, TRNG>::Initialize(nsg, randomize);
+				mSharedValues = &this->mActionValues;
+			}
+
+			// makes this learner act on the table of <owner> (which must
+			// be initialized and outlive it) instead of having its own;
+			// it then only executes episodes, everything acting on the
+			// whole table (GetBestActionIDs, Serialize, checkpoints and
+			// GetSize) must be called on the owner
+			void Share(const SharedTableQLearning& owner) {
+				assert(!this->mInitialized);
+				assert(owner.mInitialized);
+				assert(owner.mSharedValues == &owner.mActionValues);
+
+				mSharedValues = owner.mSharedValues;
+
+				this->mStateIndex = owner.mStateIndex;
+				this->mInitialized = true;
+			}
+
+			// acts and learns on the calling thread, with this learner's
+			// own alpha
+			float ExecuteEpisode(bool* status) {
+				assert(this->mInitialized);
+
+				const TDLearnerParameters& params = this->mParameters;
+
+				TState state = this->mInitialState;
+
+				if (params.GetRandomizeInitialStates())
+					state.Randomize(&this->mRandomNumbers);
+
+				float actionReward = 0.0f;
+				float episodeReward = 0.0f;
+
+				unsigned int numActions = 0;
+
+				while (!state.IsTerminal()) {
+					if ((numActions++) >= params.GetMaxActions())
+						break;
+
+					const unsigned int actionID = SelectSharedActionID(state.GetID());
+					const TState& sstate = state.ApplyAction(TAction(actionID), &actionReward);
+
+					ApplyUpdate(state.GetID(), sstate.GetID(), actionID, actionReward, params.GetAlpha());
+
+					episodeReward += actionReward;
+					actionReward = 0.0f;
+
+					state = sstate;
+				}
+
+				this->DecayParameters();
+
+				if (status != NULL) {
+					*status = (numActions < params.GetMaxActions());
+				}
+
+				return episodeReward;
+			}
+
+		protected:
+			// same as TDLearnerBase::SelectActionID, on the shared table
+			unsigned int SelectSharedActionID(unsigned int stateID) {
+				unsigned int actionID = 0;
+
+				const float tau = this->mRandomNumbers.NextFlt();
+				const float epsilon = this->mParameters.GetEpsilon();
+
+				if (tau >= epsilon) {
+					mSharedValues->template GetSharedMaxValue<SharedTableQLearning::NUM_ACTIONS>(this->GetRow(stateID), &actionID);
+				} else {
+					actionID = TAction::GetRandomActionID(this->mRandomNumbers.NextInt());
+				}
+
+				return actionID;
+			}
+
+			void ApplyUpdateRule(const TState& s, const TState& ss, const TAction& a, const TAction&, float r) {
+				ApplyUpdate(s.GetID(), ss.GetID(), a.GetID(), r, this->mParameters.GetAlpha());
+			}
+
+			void ApplyUpdate(unsigned int stateID, unsigned int nextStateID, unsigned int actionID, float r, float alpha) {
+				if (!ApplyUpdate(mSharedValues, this->mStateIndex, stateID, nextStateID, actionID, r, alpha, this->mParameters.GetGamma())) {
+					this->mNumSinkUpdates += 1;
+				}
+			}
+
+			// touches only <values> and <index>, so it can be called
+			// without a learner; returns false (without updating) for
+			// transitions from the sink
+			static bool ApplyUpdate(ActionValueStorage* values, const StateIndex* index, unsigned int stateID, unsigned int nextStateID, unsigned int actionID, float r, float alpha, float gamma) {
+				unsigned int maxQssa = 0;
+
+				const unsigned int row = SharedTableQLearning::GetRow(index, stateID);
+				const unsigned int nextRow = SharedTableQLearning::GetRow(index, nextStateID);
+
+				if (index != NULL && row == index->GetSinkIndex())
+					return false;
+
+				const float oldQsav  = values->template GetSharedValue<SharedTableQLearning::NUM_ACTIONS>(row, actionID);
+				const float maxQssav = values->template GetSharedMaxValue<SharedTableQLearning::NUM_ACTIONS>(nextRow, &maxQssa);
+				const float newQsav  = oldQsav + alpha * (r + gamma * maxQssav - oldQsav);
+
+				values->template SetSharedValue<SharedTableQLearning::NUM_ACTIONS>(row, actionID, newQsav);
+				return true;
+			}
+
+		protected:
+			// the owner's mActionValues (also for the owner itself)
+			ActionValueStorage* mSharedValues;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef RELAX_STATEACTIONTABLE_HDR
+#define RELAX_STATEACTIONTABLE_HDR
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+
+#include "../util/Arena.hpp"
+
+namespace RELAX {
+	namespace Learners {
+		// number of bits needed to store one action-ID of a task with
+		// NUM_ACTIONS actions (zero means the count is only known at
+		// run-time, in which case up to 256 actions are supported)
+		template<unsigned int NUM_ACTIONS> struct ActionIDBits {
+			enum {
+				VALUE = (NUM_ACTIONS == 0 || NUM_ACTIONS > 16)? 8: ((NUM_ACTIONS > 4)? 4: 2),
+			};
+		};
+
+		// maps state-ID's to action-ID's, packed at BITS (2, 4 or 8)
+		// bits per state into 32-bit words; with 2 bits, the policy
+		// for 128K states fits in 32KB (vs. 16 bytes per state when
+		// storing TAction objects); the words are carved from an Arena
+		// if the table was given one, like the action-value tables
+		template<unsigned int BITS> class StateActionTable {
+		public:
+			enum {
+				BITS_PER_ACTION  = BITS,
+				ACTIONS_PER_WORD = 32 / BITS,
+				ACTION_ID_MASK   = (1U << BITS) - 1,
+				MAX_ACTION_ID    = ACTION_ID_MASK,
+			};
+
+			StateActionTable(): mWords(NULL), mNumWords(0), mNumStates(0) {}
+			StateActionTable(const StateActionTable& t): mWords(NULL), mNumWords(0), mNumStates(0) { *this = t; }
+			~StateActionTable() { Clear(); }
+
+			// safe: operator= performs a deep-copy
+			StateActionTable& operator = (const StateActionTable& t) {
+				if (this != &t) {
+					Assign(t.mNumStates, t.mWords);
+				}
+
+				return *this;
+			}
+
+			void SetArena(Arena* arena) { mWordsBlock.SetArena(arena); }
+
+			static void ReserveArena(Arena& arena, unsigned int numStates) {
+				arena.Reserve(CalcSize(numStates));
+			}
+			static unsigned int CalcSize(unsigned int numStates) {
+				return (((numStates + ACTIONS_PER_WORD - 1) / ACTIONS_PER_WORD) * sizeof(uint32_t));
+			}
+
+			// (re)sizes the table, all states map to <actionID>
+			void Resize(unsigned int numStates, unsigned int actionID) {
+				Allocate(numStates);
+
+				// the block is already zero-filled
+				if (actionID != 0) {
+					Fill(actionID);
+				}
+			}
+
+			// maps all states to <actionID>
+			void Fill(unsigned int actionID) {
+				assert(actionID <= MAX_ACTION_ID);
+
+				uint32_t word = 0;
+
+				for (unsigned int n = 0; n < ACTIONS_PER_WORD; n++) {
+					word |= (actionID << (n * BITS));
+				}
+
+				std::fill(mWords, mWords + mNumWords, word);
+			}
+
+			void Clear() {
+				mWordsBlock.Free();
+
+				mWords = NULL;
+				mNumWords = 0;
+				mNumStates = 0;
+			}
+
+			unsigned int GetActionID(unsigned int stateID) const {
+				assert(stateID < mNumStates);
+
+				const uint32_t word = mWords[stateID / ACTIONS_PER_WORD];
+				const unsigned int shift = (stateID % ACTIONS_PER_WORD) * BITS;
+
+				return ((word >> shift) & ACTION_ID_MASK);
+			}
+
+			void SetActionID(unsigned int stateID, unsigned int actionID) {
+				assert(stateID < mNumStates);
+				assert(actionID <= MAX_ACTION_ID);
+
+				uint32_t& word = mWords[stateID / ACTIONS_PER_WORD];
+				const unsigned int shift = (stateID % ACTIONS_PER_WORD) * BITS;
+
+				word &= ~(static_cast<uint32_t>(ACTION_ID_MASK) << shift);
+				word |= (static_cast<uint32_t>(actionID) << shift);
+			}
+
+			// replaces the contents of the table by <numStates> action-
+			// ID's packed into words the same way as GetWords returns them
+			void Assign(unsigned int numStates, const uint32_t* words) {
+				Allocate(numStates);
+
+				if (mNumWords != 0) {
+					memcpy(mWords, words, GetSize());
+				}
+			}
+
+			const uint32_t* GetWords() const { return mWords; }
+
+			unsigned int GetNumStates() const { return mNumStates; }
+
+			// size in bytes of the packed table
+			unsigned int GetSize() const { return (mNumWords * sizeof(uint32_t)); }
+
+		private:
+			void Allocate(unsigned int numStates) {
+				Clear();
+
+				mNumWords = (numStates + ACTIONS_PER_WORD - 1) / ACTIONS_PER_WORD;
+				mNumStates = numStates;
+				mWords = static_cast<uint32_t*>(mWordsBlock.Allocate(GetSize()));
+
+				assert(mNumWords == 0 || mWords != NULL);
+			}
+
+			uint32_t* mWords;
+			ArenaBlock mWordsBlock;
+
+			unsigned int mNumWords;
+			unsigned int mNumStates;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef RELAX_STATEINDEX_HDR
+#define RELAX_STATEINDEX_HDR
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+#include <stdint.h>
+
+#include "../util/BinaryFile.hpp"
+
+namespace RELAX {
+	namespace Learners {
+		// maps state-ID's to the rows of tables that only hold a subset
+		// of the states (eg. those reachable from where a learner starts,
+		// see StateSpaceGraph::GetReachableStates): the states in the set
+		// get dense indices in ID-order and every other state is mapped
+		// to one shared row past them, the sink
+		//
+		// tables keep the sink row at zero (the value of a terminal state)
+		// and updates to it are dropped, so states outside the set (which
+		// should never be visited) neither learn nor affect other states
+		class StateIndex {
+		public:
+			StateIndex(): mNumIndexedStates(0), mKey(0) {}
+
+			void Assign(const std::vector<bool>& states) {
+				mIndices.resize(states.size());
+				mStateIDs.clear();
+
+				for (unsigned int n = 0; n < states.size(); n++) {
+					if (states[n]) {
+						mIndices[n] = mStateIDs.size();
+						mStateIDs.push_back(n);
+					}
+				}
+
+				mNumIndexedStates = mStateIDs.size();
+
+				for (unsigned int n = 0; n < states.size(); n++) {
+					mIndices[n] = (states[n])? mIndices[n]: mNumIndexedStates;
+				}
+
+				mKey = BinaryFile::Checksum(&mIndices[0], mIndices.size() * sizeof(unsigned int));
+			}
+
+			unsigned int GetIndex(unsigned int stateID) const {
+				assert(stateID < mIndices.size());
+				return mIndices[stateID];
+			}
+			// the state-ID of row <index>, GetNumStates() (which no state
+			// has) for the sink
+			unsigned int GetStateID(unsigned int index) const {
+				assert(index <= mNumIndexedStates);
+				return ((index < mNumIndexedStates)? mStateIDs[index]: mIndices.size());
+			}
+
+			// identifies the set of indexed states (a hash of the mapping)
+			uint64_t GetKey() const { return mKey; }
+
+			unsigned int GetSinkIndex() const { return mNumIndexedStates; }
+			// rows needed by a table indexed through this (including the sink)
+			unsigned int GetNumRows() const { return (mNumIndexedStates + 1); }
+
+			unsigned int GetNumStates() const { return (mIndices.size()); }
+			unsigned int GetNumIndexedStates() const { return mNumIndexedStates; }
+
+			size_t GetSize() const { return ((mIndices.size() + mStateIDs.size()) * sizeof(unsigned int)); }
+
+		private:
+			std::vector<unsigned int> mIndices;
+			std::vector<unsigned int> mStateIDs;
+
+			unsigned int mNumIndexedStates;
+
+			uint64_t mKey;
+		};
+	}
+}
+
+#endif
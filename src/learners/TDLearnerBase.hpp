@@ -1,49 +1,58 @@
 #ifndef RELAX_TDLEARNERBASE_HDR
 #define RELAX_TDLEARNERBASE_HDR
 
+#include <algorithm>
+#include <cstdio>
 #include <vector>
-#include <limits>
 
+#include <boost/static_assert.hpp>
+#include <boost/type_traits/is_polymorphic.hpp>
+
+#include "ActionValueStorage.hpp"
+#include "StateIndex.hpp"
 #include "TDLearnerParameters.hpp"
 #include "TDLearnerExecutionTrace.hpp"
+#include "../util/Checkpoint.hpp"
 #include "../util/ISerializer.hpp"
 #include "../util/INumberSequenceGen.hpp"
+#include "../util/RandomNumberBuffer.hpp"
 
 namespace RELAX {
 	namespace Learners {
-		template<typename TState, typename TAction> class TDLearnerBase: public ISerializer {
+		// NOTE:
+		//     TRNG can be any type providing NextInt and NextFlt; when it
+		//     is a concrete generator (rather than the INumberSequenceGen
+		//     interface) the calls in SelectAction are resolved statically
+		template<typename TState, typename TAction, typename TRNG = INumberSequenceGen> class TDLearnerBase: public ISerializer {
 		public:
+			enum {
+				// non-zero if the task's action-set is fixed at compile-
+				// time, in which case all action-value accesses and the
+				// argmax rescans (for 2, 3 or 4 actions unrolled) use it
+				// instead of the run-time size of mActionValues
+				NUM_ACTIONS = TAction::NUM_ACTIONS,
+
+				// most learners ExecuteEpisodes runs at once
+				MAX_LANES = 16,
+			};
+
 			TDLearnerBase(): ISerializer() {
 				mInitialized = false;
 				mNumberSeqGen = NULL;
+				mStateIndex = NULL;
+				mNumSinkUpdates = 0;
 			}
 
 			TDLearnerBase(const TDLearnerParameters& parameters): ISerializer() {
 				mInitialized = false;
 				mParameters = parameters;
 				mNumberSeqGen = NULL;
-			}
-
-			TDLearnerBase(const TDLearnerBase& b) {
-				*this = b;
-			}
-
-			TDLearnerBase& operator = (const TDLearnerBase& b) {
-				// safe: operator= performs a 2D deep-copy
-				mActionValues = b.mActionValues;
-				mInitialized = b.mInitialized;
-				mParameters = b.mParameters;
-				mInitialState = b.mInitialState;
-				mNumberSeqGen = b.mNumberSeqGen;
-				return *this;
+				mStateIndex = NULL;
+				mNumSinkUpdates = 0;
 			}
 
 			virtual ~TDLearnerBase() {
-				for (unsigned int n = 0; n < mActionValues.size(); n++) {
-					mActionValues[n].clear();
-				}
-
-				mActionValues.clear();
+				mActionValues.Clear();
 			}
 
 			// executes one episode
@@ -52,8 +61,88 @@ namespace RELAX {
 			// NOTE: <aa> is not used by the Q-learning update-rule
 			virtual void ApplyUpdateRule(const TState& s, const TState& ss, const TAction& a, const TAction& aa, float r) = 0;
 
+			// executes one episode on each of <numLearners> learners (of
+			// derived type TLearner), one learner after the other; learners
+			// able to run them in lockstep hide this (see QLearning)
+			template<typename TLearner> static void ExecuteEpisodes(TLearner* const* learners, unsigned int numLearners, float* rewards, bool* statuses) {
+				for (unsigned int k = 0; k < numLearners; k++) {
+					rewards[k] = learners[k]->ExecuteEpisode((statuses != NULL)? (statuses + k): NULL);
+				}
+			}
+
+			// where an episode executed step by step (BeginEpisode, then
+			// StepEpisode until it returns false) left off, so a scheduler
+			// can interleave the episodes of many learners
+			struct EpisodeState {
+				TState state;
+				TState nextState;
+
+				unsigned int actionID;
+				unsigned int numActions;
+
+				float actionReward;
+				float reward;         // the episode's reward once it ended
+
+				bool updatePending;   // whether the last step still needs its update
+				bool terminated;      // status (as ExecuteEpisode reports it) once ended
+			};
+
+			// learners that can suspend an episode after each step hide
+			// these (see QLearning), the others execute it all at once
+			void BeginEpisode(EpisodeState& episode) {
+				episode.numActions = 0;
+				episode.reward = 0.0f;
+				episode.updatePending = false;
+				episode.terminated = false;
+			}
+			bool StepEpisode(EpisodeState& episode) {
+				episode.reward = ExecuteEpisode(&episode.terminated);
+				return false;
+			}
+
+
+			// makes Initialize carve the action-value table from <arena>
+			// (which must have been reserved by ReserveArena)
+			void SetArena(Arena* arena) {
+				assert(!mInitialized);
+				mActionValues.SetArena(arena);
+			}
+
+			// makes Initialize share random action-values with every other
+			// learner (given the same <templates>) that draws the same key,
+			// until either writes to them; pointless unless learners draw
+			// identical keys (see RELAX_RNG_SHARED_SEEDS)
+			void SetTemplates(PageTemplates* templates) {
+				assert(!mInitialized);
+				mActionValues.SetTemplates(templates);
+			}
+
+			// makes the action-value table hold only the states in <index>
+			// (which must outlive the learner), rather than all of them
+			void SetStateIndex(const StateIndex* index) {
+				assert(!mInitialized);
+				assert(index == NULL || index->GetNumStates() == (TState::GetMaxID() + 1));
+				mStateIndex = index;
+			}
+
+			static void ReserveArena(Arena& arena, const TDLearnerParameters& parameters, const StateIndex* index) {
+				ActionValueStorage::ReserveArena(arena, parameters.GetStorageMode(), GetNumRows(index), TAction::GetMaxID() + 1);
+			}
+			static unsigned int GetNumRows(const StateIndex* index) {
+				return ((index != NULL)? index->GetNumRows(): (TState::GetMaxID() + 1));
+			}
+			static unsigned int GetRow(const StateIndex* index, unsigned int stateID) {
+				return ((index == NULL)? stateID: index->GetIndex(stateID));
+			}
+			// what GetSize will return for a learner storing its action-
+			// values in <mode> (an upper bound for hashed tables, which
+			// store at most one row per update, of which there can be
+			// at most <maxUpdates>)
+			static size_t CalcSize(unsigned int mode, const StateIndex* index, unsigned int maxUpdates) {
+				return (ActionValueStorage::CalcSize(mode, GetNumRows(index), TAction::GetMaxID() + 1, maxUpdates));
+			}
 
-			void Initialize(INumberSequenceGen* nsg, bool randomize) {
+			void Initialize(TRNG* nsg, bool randomize) {
 				// NOTE:
 				//     we assume each state shares the same set of actions
 				//     if this is not the case, will need to refactor much
@@ -61,125 +150,307 @@ namespace RELAX {
 				// NOTE:
 				//     do not use our _own_ RNG to set the action-values!
 				assert(!mInitialized);
-				mActionValues.resize(TState::GetMaxID() + 1, std::vector<float>(TAction::GetMaxID() + 1));
+				assert(NUM_ACTIONS == 0 || NUM_ACTIONS == (TAction::GetMaxID() + 1));
+
+				mActionValues.SetMode(mParameters.GetStorageMode());
+				mActionValues.SetDefaultValue(mParameters.GetDefaultActionValue());
+				mActionValues.SetQuantization(mParameters.GetQuantizedRounding(), mParameters.GetQuantizedRange());
+				mActionValues.Resize(GetNumRows(mStateIndex), TAction::GetMaxID() + 1);
+
+				if (randomize && mActionValues.GetMode() == ActionValueStorage::STORAGE_HASHED) {
+					// drawing a value for every state would defeat the point
+					// of only storing the visited ones
+					printf("[TDLearnerBase::%s] hashed storage: using the default action-value instead of random ones\n", __FUNCTION__);
+				} else if (randomize) {
+					// only the key is drawn from <nsg>, the values are hashed
+					// from it per (state, action) so the generator's state
+					// afterwards does not depend on the table size (and a
+					// state gets the same values whether pruned or not)
+					mActionValues.Randomize(nsg->NextInt(), mStateIndex);
+				}
+
+				if (mActionValues.GetMode() != ActionValueStorage::STORAGE_HASHED && (randomize || mParameters.GetDefaultActionValue() != 0.0f)) {
+					// terminal states are not acted from, so their rows keep
+					// their initial values, which updates into them bootstrap
+					// from; zero them (the value of a terminal state) as the
+					// sink of a pruned table is, so pruning does not change
+					// what is learned (hashed tables do not store them and
+					// keep the default value unless pruned)
+					TState state;
+
+					for (unsigned int n = 0; n <= TState::GetMaxID(); n++) {
+						if (!(state.Initialize(n)).IsTerminal())
+							continue;
+
+						for (unsigned int k = 0; k <= TAction::GetMaxID(); k++) {
+							mActionValues.SetValue<NUM_ACTIONS>(GetRow(n), k, 0.0f);
+						}
+					}
+				}
 
-				for (unsigned int n = 0; n <= TState::GetMaxID(); n++) {
+				if (mStateIndex != NULL) {
+					// the sink stands in for (mostly terminal) states that
+					// are never updated, so it must not carry random values
 					for (unsigned int k = 0; k <= TAction::GetMaxID(); k++) {
-						mActionValues[n][k] = randomize? nsg->NextFlt(): 0.0f;
+						mActionValues.SetValue<NUM_ACTIONS>(mStateIndex->GetSinkIndex(), k, 0.0f);
 					}
 				}
 
 				mInitialized = true;
 			}
 
-			void Serialize(const std::string& fileName) {
-				unsigned int numStates = TState::GetMaxID() + 1;
-				unsigned int numActions = TAction::GetMaxID() + 1;
-
+			// with dense storage the file is mapped rather than read, so
+			// the table is paged in on first access (and shared with any
+			// other process that has the same file loaded until either
+			// writes to it); hashed tables are copied out of the mapping
+			bool Serialize(const std::string& fileName) const {
 				assert(mInitialized);
-				assert(numStates == mActionValues.size());
+				assert(OwnsActionValues());
+				assert(mActionValues.GetNumRows() == GetNumRows(mStateIndex));
 
-				mSerializerFileStream.open(fileName.c_str(), std::ios::in | std::ios::binary);
+				return (mActionValues.Save(fileName, TState::GetTaskName()));
+			}
 
-				if (!mSerializerFileStream.good()) {
-					// write the action-values
-					mSerializerFileStream.close();
-					mSerializerFileStream.open(fileName.c_str(), std::ios::out | std::ios::binary);
+			bool Deserialize(const std::string& fileName) {
+				// the file must have been written with the same storage mode
+				mActionValues.Clear();
+				mActionValues.SetMode(mParameters.GetStorageMode());
+				mActionValues.SetQuantization(mParameters.GetQuantizedRounding(), mParameters.GetQuantizedRange());
 
-					mSerializerFileStream.write(reinterpret_cast<const char*>(&numStates), sizeof(unsigned int));
-					mSerializerFileStream.write(reinterpret_cast<const char*>(&numActions), sizeof(unsigned int));
+				if (!mActionValues.Load(fileName, TState::GetTaskName(), false)) {
+					return false;
+				}
 
-					for (unsigned int n = 0; n < numStates; n++) {
-						for (unsigned int k = 0; k < numActions; k++) {
-							mSerializerFileStream.write(reinterpret_cast<const char*>(&mActionValues[n][k]), sizeof(float));
-						}
-					}
-				} else {
-					// read the action-values
-					mSerializerFileStream.read(reinterpret_cast<char*>(&numStates), sizeof(unsigned int));
-					mSerializerFileStream.read(reinterpret_cast<char*>(&numActions), sizeof(unsigned int));
-					mActionValues.resize(numStates, std::vector<float>(numActions, 0.0f));
+				if (mActionValues.GetNumRows() != GetNumRows(mStateIndex) || mActionValues.GetNumCols() != (TAction::GetMaxID() + 1)) {
+					printf("[TDLearnerBase::%s] \"%s\": table dimensions do not match the task\n", __FUNCTION__, fileName.c_str());
+					mActionValues.Clear();
+					return false;
+				}
 
-					assert(numStates == (TState::GetMaxID() + 1));
-					assert(numActions == (TAction::GetMaxID() + 1));
+				mInitialized = true;
+				return true;
+			}
 
-					for (unsigned int n = 0; n < numStates; n++) {
-						for (unsigned int k = 0; k < numActions; k++) {
-							mSerializerFileStream.read(reinterpret_cast<char*>(&mActionValues[n][k]), sizeof(float));
-						}
-					}
-				}
+			// stores (restores) everything needed to continue learning
+			// bit-exactly: the action-values, the decayed parameters and
+			// the state of the RNG including any numbers drawn from it
+			// that were not consumed yet
+			// NOTE:
+			//     TRNG must be a concrete generator type here since its
+			//     state is saved as raw bytes
+			void SaveCheckpoint(Checkpoint* checkpoint) const {
+				BOOST_STATIC_ASSERT(!boost::is_polymorphic<TRNG>::value);
 
-				mSerializerFileStream.flush();
-				mSerializerFileStream.close();
+				assert(mInitialized);
+				assert(OwnsActionValues());
+				assert(mNumberSeqGen != NULL);
+
+				LearnerState state;
+				state.alpha = mParameters.GetAlpha();
+				state.epsilon = mParameters.GetEpsilon();
+				state.numberSeqGen = *mNumberSeqGen;
+				mRandomNumbers.GetState(&state.randomNumbers);
+
+				checkpoint->SetNumStates(mActionValues.GetNumRows());
+				checkpoint->SetNumActions(mActionValues.GetNumCols());
+				checkpoint->SetSectionValue(Checkpoint::SECTION_LEARNER_STATE, state);
+
+				mActionValues.SaveState(
+					checkpoint->GetSection(Checkpoint::SECTION_ACTION_VALUES),
+					checkpoint->GetSection(Checkpoint::SECTION_ROW_MAXIMA)
+				);
+			}
+
+			bool LoadCheckpoint(const Checkpoint& checkpoint) {
+				BOOST_STATIC_ASSERT(!boost::is_polymorphic<TRNG>::value);
+
+				assert(mInitialized);
+				assert(OwnsActionValues());
+				assert(mNumberSeqGen != NULL);
+
+				LearnerState state;
+
+				if (checkpoint.GetNumStates() != GetNumRows(mStateIndex) || checkpoint.GetNumActions() != (TAction::GetMaxID() + 1))
+					return false;
+				if (!checkpoint.GetSectionValue(Checkpoint::SECTION_LEARNER_STATE, &state))
+					return false;
+
+				const bool loaded = mActionValues.LoadState(
+					checkpoint.GetNumStates(),
+					checkpoint.GetNumActions(),
+					checkpoint.GetSection(Checkpoint::SECTION_ACTION_VALUES),
+					checkpoint.GetSection(Checkpoint::SECTION_ROW_MAXIMA)
+				);
+
+				if (!loaded)
+					return false;
+
+				// the generator is shared with our owner (which may use it
+				// after learning), so restore it in place; the buffer keeps
+				// drawing from it
+				mParameters.SetAlpha(state.alpha);
+				mParameters.SetEpsilon(state.epsilon);
+				*mNumberSeqGen = state.numberSeqGen;
+				mRandomNumbers.SetState(state.randomNumbers);
+
+				assert(mRandomNumbers.GetSource() == mNumberSeqGen);
+				return true;
 			}
 
 			// return the size in bytes claimed by the action-value
-			// table, excluding any internal data-structure overhead
-			unsigned int GetSize() const { return ((TState::GetMaxID() + 1) * (TAction::GetMaxID() + 1) * sizeof(float)); }
+			// table (including row-padding, and for hashed storage its
+			// slots and unused capacity)
+			size_t GetSize() const {
+				assert(!mInitialized || OwnsActionValues());
+				return (mActionValues.GetSize());
+			}
+			unsigned int GetNumStoredStates() const {
+				assert(!mInitialized || OwnsActionValues());
+				return (mActionValues.GetNumStoredRows());
+			}
+			// false for a learner initialized onto the table of another
+			// (see SharedTableQLearning::Share), which has none of its own;
+			// the calls acting on the whole table must go to the owner
+			bool OwnsActionValues() const { return (!mActionValues.IsEmpty()); }
+			// number of updates dropped because they were made to a state
+			// outside the state-index (diagnostic, not checkpointed)
+			unsigned int GetNumSinkUpdates() const { return mNumSinkUpdates; }
 
 			const TDLearnerParameters& GetParameters() const { return mParameters; }
 			const TState& GetInitialState() const { return mInitialState; }
 
 			void SetInitialState(const TState& s) { mInitialState = s; }
-			void SetNumberSequenceGen(INumberSequenceGen* nsg) { assert(mNumberSeqGen == NULL); mNumberSeqGen = nsg; }
+			void SetNumberSequenceGen(TRNG* nsg) {
+				assert(mNumberSeqGen == NULL);
+				mNumberSeqGen = nsg;
+				mRandomNumbers.SetSource(nsg);
+			}
 
 			TAction GetBestAction(const TState& s) {
+				assert(OwnsActionValues());
+
 				TAction a;
 				GetMaxActionValue(s, a);
 				return a;
 			}
 
-		protected:
-			float GetActionValue(const TState& s, const TAction& a) const {
-				assert(s.GetID() < mActionValues.size());
-				assert(a.GetID() < mActionValues[s.GetID()].size());
-				return mActionValues[s.GetID()][a.GetID()];
+			// bulk version of GetBestAction for all states at once (the
+			// best action-ID for state-ID n is stored at index n, or at
+			// the state's index if the learner has a state-index)
+			void GetBestActionIDs(std::vector<unsigned int>& actionIDs) const {
+				assert(OwnsActionValues());
+
+				actionIDs.resize(mActionValues.GetNumRows());
+				mActionValues.GetMaxCols(&actionIDs[0]);
 			}
-			void SetActionValue(const TState& s, const TAction& a, float v) {
-				assert(s.GetID() < mActionValues.size());
-				assert(a.GetID() < mActionValues[s.GetID()].size());
-				mActionValues[s.GetID()][a.GetID()] = v;
+			// same, but stores the best action-ID's straight into the
+			// table <stateActions> (with one entry per row, anything with
+			// a SetActionID(row, actionID)) which must map every row to
+			// action 0 beforehand; needs no per-state temporary and with
+			// hashed storage only visits the stored rows
+			template<typename TStateActionTable> void GetBestActionIDs(TStateActionTable& stateActions) const {
+				assert(OwnsActionValues());
+				assert(stateActions.GetNumStates() == mActionValues.GetNumRows());
+
+				BestActionWriter<TStateActionTable> writer(stateActions);
+				mActionValues.VisitMaxCols(writer);
 			}
 
-			float GetMaxActionValue(const TState& s, TAction& a) const {
-				assert(s.GetID() < mActionValues.size());
+		protected:
+			template<typename TStateActionTable> struct BestActionWriter {
+			public:
+				BestActionWriter(TStateActionTable& stateActions): mStateActions(stateActions) {}
+				void operator () (unsigned int row, unsigned int col) { mStateActions.SetActionID(row, col); }
+
+			private:
+				TStateActionTable& mStateActions;
+			};
+
+			// plain values only, Checkpoint stores it as raw bytes
+			struct LearnerState {
+				// the parameters learning decays, the others are set
+				// from the configuration
+				float alpha;
+				float epsilon;
+
+				TRNG numberSeqGen;
+				typename RandomNumberBuffer<TRNG>::State randomNumbers;
+			};
+
+			unsigned int GetRow(unsigned int stateID) const { return (GetRow(mStateIndex, stateID)); }
+			unsigned int GetRow(const TState& s) const { return (GetRow(s.GetID())); }
+
+			void PrefetchActionValues(unsigned int stateID) const { mActionValues.Prefetch(GetRow(stateID)); }
+
+			// the accessors taking ID's are used by learners that step
+			// states in batches (see QLearning::ExecuteEpisodes)
+			float GetActionValue(unsigned int stateID, unsigned int actionID) const {
+				return mActionValues.GetValue<NUM_ACTIONS>(GetRow(stateID), actionID);
+			}
+			void SetActionValue(unsigned int stateID, unsigned int actionID, float v) {
+				const unsigned int row = GetRow(stateID);
 
-				float v = -std::numeric_limits<float>::max();
+				if (mStateIndex != NULL && row == mStateIndex->GetSinkIndex()) {
+					mNumSinkUpdates += 1;
+					return;
+				}
 
-				const unsigned int id = s.GetID();
-				const std::vector<float>& values = mActionValues[id];
+				mActionValues.SetValue<NUM_ACTIONS>(row, actionID, v);
+			}
 
-				for (unsigned int n = 0; n < values.size(); n++) {
-					if (values[n] > v) {
-						v = values[n];
-						a = n;
-					}
-				}
+			// O(1), served from the table's cached row maxima
+			float GetMaxActionValue(unsigned int stateID, unsigned int* actionID) const {
+				return mActionValues.GetMaxValue<NUM_ACTIONS>(GetRow(stateID), actionID);
+			}
+
+			float GetActionValue(const TState& s, const TAction& a) const { return (GetActionValue(s.GetID(), a.GetID())); }
+			void SetActionValue(const TState& s, const TAction& a, float v) { SetActionValue(s.GetID(), a.GetID(), v); }
 
+			float GetMaxActionValue(const TState& s, TAction& a) const {
+				unsigned int id = 0;
+				const float v = GetMaxActionValue(s.GetID(), &id);
+
+				a.SetID(id);
 				return v;
 			}
 
-			TAction SelectAction(const TState& state) {
-				TAction action;
+			unsigned int SelectActionID(unsigned int stateID) {
+				unsigned int actionID = 0;
 
-				const float tau = mNumberSeqGen->NextFlt();
+				const float tau = mRandomNumbers.NextFlt();
 				const float epsilon = mParameters.GetEpsilon();
 
 				// use epsilon-greedy strategy for action-selection
 				// NOTE: the random action can still equal the best!
 				if (tau >= epsilon) {
-					GetMaxActionValue(state, action);
+					GetMaxActionValue(stateID, &actionID);
 				} else {
-					action.SetID(TAction::GetRandomActionID(mNumberSeqGen->NextInt()));
+					actionID = TAction::GetRandomActionID(mRandomNumbers.NextInt());
 				}
 
-				return action;
+				return actionID;
+			}
+
+			TAction SelectAction(const TState& state) { return (TAction(SelectActionID(state.GetID()))); }
+
+			// decays alpha and epsilon, once per episode
+			void DecayParameters() {
+				mParameters.SetAlpha(mParameters.GetAlpha() * mParameters.GetAlphaDecay());
+				mParameters.SetAlpha(std::max(mParameters.GetAlpha(), mParameters.GetMinAlpha()));
+				mParameters.SetEpsilon(mParameters.GetEpsilon() * mParameters.GetEpsilonDecay());
+				mParameters.SetEpsilon(std::max(mParameters.GetEpsilon(), mParameters.GetMinEpsilon()));
 			}
 
 
-			// first dimension: stateID, second dimension: actionID
-			std::vector< std::vector<float> > mActionValues;
+		private:
+			// non-copyable, learners are constructed in place (and their
+			// tables are far too large to copy by accident)
+			TDLearnerBase(const TDLearnerBase&);
+			TDLearnerBase& operator = (const TDLearnerBase&);
+
+		protected:
+			// rows are indexed by stateID, columns by actionID
+			ActionValueStorage mActionValues;
 
 			// true IFF Initialize was called
 			bool mInitialized;
@@ -188,7 +459,16 @@ namespace RELAX {
 			TDLearnerParameters mParameters;
 			TState mInitialState;
 
-			INumberSequenceGen* mNumberSeqGen;
+			TRNG* mNumberSeqGen;
+
+			// NULL if every state has a row (then indexed by state-ID)
+			const StateIndex* mStateIndex;
+			unsigned int mNumSinkUpdates;
+
+			// all randomness consumed during episodes (action selection
+			// and initial-state randomization) is drawn from mNumberSeqGen
+			// in bulk through this buffer
+			RandomNumberBuffer<TRNG> mRandomNumbers;
 		};
 	};
 }
@@ -1,6 +1,7 @@
 #include <cstdio>
 
 #include "TDLearnerParameters.hpp"
+#include "ActionValueStorage.hpp"
 #include "../Defines.hpp"
 #include "../util/LuaParser.hpp"
 
@@ -16,6 +17,15 @@ bool RELAX::Learners::TDLearnerParameters::Initialize(const LuaTable* table) {
 	SetMinAlpha(table->GetFltVal("minAlpha", 0.0f));
 	SetMinEpsilon(table->GetFltVal("minEpsilon", 0.0f));
 	SetRandomizeInitialStates(table->GetBoolVal("randomizeInitialEpisodeStates", true));
+	SetStorageMode(ActionValueStorage::GetModeFromName(table->GetStrVal("storage", "dense")));
+	SetDefaultActionValue(table->GetFltVal("defaultActionValue", 0.0f));
+	SetQuantizedRounding((table->GetStrVal("rounding", "nearest") == "stochastic")? QuantizedActionValueTable::ROUNDING_STOCHASTIC: QuantizedActionValueTable::ROUNDING_NEAREST);
+	SetQuantizedRange(table->GetFltVal("quantizedRange", 4096.0f));
+
+	if (mStorageMode == ActionValueStorage::NUM_STORAGE_MODES) {
+		printf("[TDLearnerParameters::%s] unknown action-value storage \"%s\"\n", __FUNCTION__, (table->GetStrVal("storage", "dense")).c_str());
+		return false;
+	}
 
 	#ifdef RELAX_LOG_PARAMETERS
 	printf("[TDLearnerParameters::%s]\n", __FUNCTION__);
@@ -26,6 +36,10 @@ bool RELAX::Learners::TDLearnerParameters::Initialize(const LuaTable* table) {
 	printf("  alpha-decay multiplier: %f\n", mAlphaDecay);
 	printf("  epsilon-decay multiplier: %f\n", mEpsilonDecay);
 	printf("  randomize initial states: %d\n", mRandomizeInitialStates);
+	printf("  action-value storage: %s\n", ActionValueStorage::GetModeName(mStorageMode));
+	printf("  default action-value: %f\n", mDefaultActionValue);
+	printf("  quantized rounding: %s\n", (mQuantizedRounding == QuantizedActionValueTable::ROUNDING_STOCHASTIC)? "stochastic": "nearest");
+	printf("  quantized (int16) range: %f\n", mQuantizedRange);
 	#endif
 
 	return true;
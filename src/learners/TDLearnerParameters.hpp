@@ -21,6 +21,12 @@ namespace RELAX {
 				mMinEpsilon = 0.0f;
 
 				mRandomizeInitialStates = false;
+
+				mStorageMode = 0;
+				mDefaultActionValue = 0.0f;
+
+				mQuantizedRounding = 0;
+				mQuantizedRange = 4096.0f;
 			}
 
 			TDLearnerParameters(const TDLearnerParameters& p) {
@@ -41,6 +47,12 @@ namespace RELAX {
 				mMinEpsilon = p.mMinEpsilon;
 
 				mRandomizeInitialStates = p.mRandomizeInitialStates;
+
+				mStorageMode = p.mStorageMode;
+				mDefaultActionValue = p.mDefaultActionValue;
+
+				mQuantizedRounding = p.mQuantizedRounding;
+				mQuantizedRange = p.mQuantizedRange;
 				return *this;
 			}
 
@@ -55,6 +67,10 @@ namespace RELAX {
 			void SetMinAlpha(float v) { mMinAlpha = v; }
 			void SetMinEpsilon(float v) { mMinEpsilon = v; }
 			void SetRandomizeInitialStates(bool b) { mRandomizeInitialStates = b; }
+			void SetStorageMode(unsigned int m) { mStorageMode = m; }
+			void SetDefaultActionValue(float v) { mDefaultActionValue = v; }
+			void SetQuantizedRounding(unsigned int r) { mQuantizedRounding = r; }
+			void SetQuantizedRange(float v) { mQuantizedRange = v; }
 
 			unsigned int GetMaxActions() const { return mMaxActions; }
 			float GetAlpha() const { return mAlpha; }
@@ -65,6 +81,10 @@ namespace RELAX {
 			float GetMinAlpha() const { return mMinAlpha; }
 			float GetMinEpsilon() const { return mMinEpsilon; }
 			bool GetRandomizeInitialStates() const { return mRandomizeInitialStates; }
+			unsigned int GetStorageMode() const { return mStorageMode; }
+			float GetDefaultActionValue() const { return mDefaultActionValue; }
+			unsigned int GetQuantizedRounding() const { return mQuantizedRounding; }
+			float GetQuantizedRange() const { return mQuantizedRange; }
 
 		private:
 			unsigned int mMaxActions;      // max. number of actions allowed to be executed per episode
@@ -80,6 +100,12 @@ namespace RELAX {
 			float mMinEpsilon;             // minimum value that <mEpsilon> is allowed to decay to
 
 			bool mRandomizeInitialStates;  // whether episodes start from random states while learning policy
+
+			unsigned int mStorageMode;     // ActionValueStorage::STORAGE_*, how the action-values are stored
+			float mDefaultActionValue;     // action-value of states never updated (hashed storage only)
+
+			unsigned int mQuantizedRounding; // QuantizedActionValueTable::ROUNDING_*, how fp32 updates are stored
+			float mQuantizedRange;         // largest magnitude representable by int16 storage
 		};
 	}
 }
@@ -1,17 +1,76 @@
 #ifndef RELAX_TDPOLICY_HDR
 #define RELAX_TDPOLICY_HDR
 
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
 #include "PolicyBase.hpp"
 #include "TDLearnerBase.hpp"
+#include "../util/Checkpoint.hpp"
 
 namespace RELAX {
 	namespace Learners {
-		template<typename TState, typename TAction> class TDPolicy: public PolicyBase<TState, TAction> {
+		template<typename TState, typename TAction, typename TRNG = INumberSequenceGen> class TDPolicy: public PolicyBase<TState, TAction, TRNG> {
 		public:
-			TDPolicy(): PolicyBase<TState, TAction>() {}
-			TDPolicy(const LuaTable* table): PolicyBase<TState, TAction>(table) {}
-			TDPolicy(const TDPolicy& p): PolicyBase<TState, TAction>() { *this = p; }
-			TDPolicy& operator = (const TDPolicy& p) { PolicyBase<TState, TAction>::operator = (p); return *this; }
+			TDPolicy(): PolicyBase<TState, TAction, TRNG>() { ResetLearning(); }
+			TDPolicy(const LuaTable* table): PolicyBase<TState, TAction, TRNG>(table) { ResetLearning(); }
+
+			// makes Learn submit a checkpoint to <writer> every <interval>
+			// episodes and after the last one (an interval of zero turns
+			// checkpointing off)
+			void SetCheckpointing(CheckpointWriter* writer, const std::string& fileName, unsigned int interval) {
+				mCheckpointWriter = (interval != 0)? writer: NULL;
+				mCheckpointFileName = fileName;
+				mCheckpointInterval = interval;
+			}
+
+			// restores this policy and <learner> (both must have been
+			// initialized as for the original run) from a checkpoint,
+			// so that Learn continues after the last checkpointed episode;
+			// fails if <learner> starts from another state than the one
+			// the checkpoint was taken from
+			bool Resume(TDLearnerBase<TState, TAction, TRNG>& learner, const std::string& fileName) {
+				assert(this->mInitialized);
+				assert(!this->mLearned);
+
+				Checkpoint checkpoint;
+				PolicyState state;
+
+				if (!checkpoint.Load(fileName, TState::GetTaskName()))
+					return false;
+
+				const std::vector<char>& section = checkpoint.GetSection(Checkpoint::SECTION_POLICY_STATE);
+
+				if (section.size() < sizeof(PolicyState)) {
+					printf("[TDPolicy::%s] \"%s\": bad policy state\n", __FUNCTION__, fileName.c_str());
+					return false;
+				}
+
+				memcpy(&state, &section[0], sizeof(PolicyState));
+
+				if (state.numLearnedEpisodes > this->mMaxLearningEpisodes || section.size() != (sizeof(PolicyState) + state.numLearnedEpisodes * sizeof(float))) {
+					printf("[TDPolicy::%s] \"%s\": bad policy state\n", __FUNCTION__, fileName.c_str());
+					return false;
+				}
+				if (state.initialStateID != (learner.GetInitialState()).GetID()) {
+					printf("[TDPolicy::%s] \"%s\": learner started from state %u, not %u\n", __FUNCTION__, fileName.c_str(), state.initialStateID, (learner.GetInitialState()).GetID());
+					return false;
+				}
+				if (!learner.LoadCheckpoint(checkpoint)) {
+					printf("[TDPolicy::%s] \"%s\": bad learner state\n", __FUNCTION__, fileName.c_str());
+					return false;
+				}
+
+				if (state.numLearnedEpisodes > 0) {
+					memcpy(&this->mTrainEpisodeRewards[0], &section[sizeof(PolicyState)], state.numLearnedEpisodes * sizeof(float));
+				}
+
+				mNumLearnedEpisodes = state.numLearnedEpisodes;
+				mLearnerReward = state.learnerReward;
+				return true;
+			}
 
 			// a TDPolicy is learned through a TDLearner derivative
 			// by having the learner execute a sequence of episodes
@@ -20,37 +79,195 @@ namespace RELAX {
 			// policy
 			//
 			// NOTE: only called ONCE per policy
-			float Learn(TDLearnerBase<TState, TAction>& learner) {
+			float Learn(TDLearnerBase<TState, TAction, TRNG>& learner) {
 				assert(this->mInitialized);
 				assert(!this->mLearned);
 
 				bool episodeTerminated = false;
 
-				float episodeReward = 0.0f;
-				float learnerReward = 0.0f;
+				// starts at zero unless we were resumed from a checkpoint
+				while (mNumLearnedEpisodes < this->mMaxLearningEpisodes) {
+					AddLearnedEpisode(learner, learner.ExecuteEpisode(&episodeTerminated));
+				}
 
-				for (unsigned int n = 0; n < this->mMaxLearningEpisodes; n++) {
-					episodeReward = learner.ExecuteEpisode(&episodeTerminated);
-					learnerReward += episodeReward;
+				FinishLearning(learner);
+				return mLearnerReward;
+			}
 
-					this->mTrainEpisodeRewards[n] = episodeReward;
+			// learns each of <numPolicies> policies from its learner in
+			// <learners> exactly as Learn does, but has the learners run
+			// their episodes together (see TLearner::ExecuteEpisodes, at
+			// most MAX_LANES of them); policies may have been resumed
+			// from different episodes, each stops after its last one
+			template<typename TLearner> static void LearnLockstep(TDPolicy* const* policies, TLearner* const* learners, unsigned int numPolicies) {
+				assert(numPolicies <= TLearner::MAX_LANES);
+
+				TDPolicy* lanePolicies[TLearner::MAX_LANES];
+				TLearner* laneLearners[TLearner::MAX_LANES];
+
+				float episodeRewards[TLearner::MAX_LANES];
+				bool episodeStatuses[TLearner::MAX_LANES];
+
+				for (unsigned int k = 0; k < numPolicies; k++) {
+					assert(policies[k]->mInitialized);
+					assert(!policies[k]->mLearned);
 				}
 
-				TState state;
-				TAction action;
+				while (true) {
+					unsigned int numLanes = 0;
 
-				// derive the optimal policy from the learned action-values
-				for (unsigned int n = 0; n <= TState::GetMaxID(); n++) {
-					state = state.Initialize(n);
-					action = learner.GetBestAction(state);
+					for (unsigned int k = 0; k < numPolicies; k++) {
+						if (policies[k]->mNumLearnedEpisodes >= policies[k]->mMaxLearningEpisodes)
+							continue;
 
-					this->mStateActions[n] = action;
+						lanePolicies[numLanes] = policies[k];
+						laneLearners[numLanes] = learners[k];
+						numLanes += 1;
+					}
+
+					if (numLanes == 0)
+						break;
+
+					TLearner::ExecuteEpisodes(laneLearners, numLanes, episodeRewards, episodeStatuses);
+
+					for (unsigned int k = 0; k < numLanes; k++) {
+						lanePolicies[k]->AddLearnedEpisode(*laneLearners[k], episodeRewards[k]);
+					}
+				}
+
+				for (unsigned int k = 0; k < numPolicies; k++) {
+					policies[k]->FinishLearning(*learners[k]);
 				}
+			}
+
+			// learns each of <numPolicies> policies from its learner in
+			// <learners> exactly as Learn does, but executes the learners'
+			// episodes one step at a time in round-robin order (see
+			// TLearner::StepEpisode) so that each learner's wait for its
+			// next Q-table row overlaps with the steps of the others; unlike
+			// LearnLockstep, every learner moves on to its next episode as
+			// soon as one ends
+			template<typename TLearner> static void LearnInterleaved(TDPolicy* const* policies, TLearner* const* learners, unsigned int numPolicies) {
+				std::vector<typename TLearner::EpisodeState> episodes(numPolicies);
+				std::vector<unsigned int> slots;
+
+				for (unsigned int k = 0; k < numPolicies; k++) {
+					assert(policies[k]->mInitialized);
+					assert(!policies[k]->mLearned);
+
+					if (policies[k]->mNumLearnedEpisodes >= policies[k]->mMaxLearningEpisodes)
+						continue;
+
+					learners[k]->BeginEpisode(episodes[k]);
+					slots.push_back(k);
+				}
+
+				while (!slots.empty()) {
+					for (unsigned int i = 0; i < slots.size(); /* no-op */) {
+						const unsigned int k = slots[i];
+
+						if (learners[k]->StepEpisode(episodes[k])) {
+							i += 1;
+							continue;
+						}
+
+						policies[k]->AddLearnedEpisode(*learners[k], episodes[k].reward);
+
+						if (policies[k]->mNumLearnedEpisodes < policies[k]->mMaxLearningEpisodes) {
+							learners[k]->BeginEpisode(episodes[k]);
+							i += 1;
+							continue;
+						}
+
+						// done, the last slot takes this one's place
+						slots[i] = slots.back();
+						slots.pop_back();
+					}
+				}
+
+				for (unsigned int k = 0; k < numPolicies; k++) {
+					policies[k]->FinishLearning(*learners[k]);
+				}
+			}
+
+			unsigned int GetNumLearnedEpisodes() const { return mNumLearnedEpisodes; }
+
+		private:
+			struct PolicyState {
+				unsigned int numLearnedEpisodes;
+				float learnerReward;
+
+				// ID of the learner's initial state (derived from the
+				// master seed, so a checkpoint only fits runs with the
+				// same one)
+				unsigned int initialStateID;
+			};
+
+			// records the reward of the episode <learner> just executed
+			// and checkpoints if one is due
+			void AddLearnedEpisode(const TDLearnerBase<TState, TAction, TRNG>& learner, float episodeReward) {
+				mLearnerReward += episodeReward;
+
+				this->mTrainEpisodeRewards[mNumLearnedEpisodes] = episodeReward;
+				mNumLearnedEpisodes += 1;
+
+				if (mCheckpointWriter == NULL)
+					return;
+				if ((mNumLearnedEpisodes % mCheckpointInterval) != 0 && mNumLearnedEpisodes != this->mMaxLearningEpisodes)
+					return;
+
+				SubmitCheckpoint(learner);
+			}
+
+			void FinishLearning(const TDLearnerBase<TState, TAction, TRNG>& learner) {
+				// derive the optimal policy from the learned action-values
+				// (every task's State::Initialize(n) yields the state with
+				// ID n, so this equals calling GetBestAction per state);
+				// rows the learner does not visit keep action 0
+				this->mStateActions.Fill(0);
+				learner.GetBestActionIDs(this->mStateActions);
 
 				// make sure we aren't called again
 				this->mLearned = true;
-				return learnerReward;
 			}
+
+			void ResetLearning() {
+				mNumLearnedEpisodes = 0;
+				mLearnerReward = 0.0f;
+
+				mCheckpointWriter = NULL;
+				mCheckpointInterval = 0;
+			}
+
+			// the snapshot is taken here (one copy of the action-values),
+			// writing it to disk is left to the writer's thread
+			void SubmitCheckpoint(const TDLearnerBase<TState, TAction, TRNG>& learner) const {
+				Checkpoint* checkpoint = new Checkpoint();
+				PolicyState state;
+
+				state.numLearnedEpisodes = mNumLearnedEpisodes;
+				state.learnerReward = mLearnerReward;
+				state.initialStateID = (learner.GetInitialState()).GetID();
+
+				std::vector<char>& section = checkpoint->GetSection(Checkpoint::SECTION_POLICY_STATE);
+				section.resize(sizeof(PolicyState) + mNumLearnedEpisodes * sizeof(float));
+
+				memcpy(&section[0], &state, sizeof(PolicyState));
+				memcpy(&section[sizeof(PolicyState)], &this->mTrainEpisodeRewards[0], mNumLearnedEpisodes * sizeof(float));
+
+				learner.SaveCheckpoint(checkpoint);
+				mCheckpointWriter->Submit(mCheckpointFileName, checkpoint);
+			}
+
+		private:
+			// number of learning episodes executed so far and the sum
+			// of their rewards (both part of checkpoints)
+			unsigned int mNumLearnedEpisodes;
+			float mLearnerReward;
+
+			CheckpointWriter* mCheckpointWriter;
+			std::string mCheckpointFileName;
+			unsigned int mCheckpointInterval;
 		};
 	}
 }
@@ -7,7 +7,6 @@
 #include "ITask.hpp"
 
 class LuaTable;
-class INumberSequenceGen;
 
 namespace RELAX {
 	namespace Tasks {
@@ -29,18 +28,46 @@ namespace RELAX {
 
 			struct State {
 			public:
+				enum {
+					EXACT_TRANSITIONS = 1,
+				};
+
+				// a batch of (indistinguishable) states, see ApplyActions
+				struct Batch {
+				public:
+					Batch(): mSize(0) {}
+
+					void Resize(unsigned int n) { mSize = n; }
+					void SetState(unsigned int, const State&) {}
+					void GetState(unsigned int, State&) const {}
+
+					unsigned int GetSize() const { return mSize; }
+					unsigned int GetID(unsigned int) const { return 0; }
+
+				private:
+					unsigned int mSize;
+				};
+
 				State() {}
 				State& operator = (const State&) { return *this; }
 
 			public:
 				// functions required for RL
 				State ApplyAction(const Action&, float*) { return State(); }
+				static void ApplyActions(const Batch& states, const unsigned int*, Batch& nextStates, float*, unsigned char* terminals) {
+					nextStates.Resize(states.GetSize());
+
+					for (unsigned int k = 0; k < states.GetSize(); k++) {
+						terminals[k] = 0;
+					}
+				}
 
 				State& Initialize(unsigned int) { return *this; }
-				State& Randomize(INumberSequenceGen*) { return *this; }
+				template<typename TRNG> State& Randomize(TRNG*) { return *this; }
 
 				unsigned int GetID() const { return 0; }
 				static unsigned int GetMaxID() { return 0; }
+				static const char* GetTaskName() { return Dummy::GetName(); }
 
 				bool IsTerminal() const { return false; }
 				bool operator < (const State& s) const { return (GetID() < s.GetID()); }
@@ -4,7 +4,6 @@
 
 #include "HillClimber.hpp"
 #include "../util/LuaParser.hpp"
-#include "../util/INumberSequenceGen.hpp"
 
 using namespace RELAX::Tasks;
 
@@ -45,38 +44,6 @@ bool HillClimber::Initialize(const LuaTable* table) {
 	return true;
 }
 
-unsigned int HillClimber::GetChosenStates(std::vector<State>&, INumberSequenceGen*) {
-	/*
-	static const float posRangeVariance = (gTerrain.MaxPosition() - gTerrain.MinPosition()) * 0.125f;
-	static const float velRangeVariance = (gVehicle.MaxVelocity() - gVehicle.MinVelocity()) * 0.125f;
-
-	assert(!states.empty());
-
-	for (unsigned int n = 0; n < states.size(); n++) {
-		// NOTE: each state is already default-initialized, but see [2] in Main
-		states[n] = State();
-
-		const float tau1 = nsg->NextFlt();
-		const float tau2 = nsg->NextFlt();
-		const float sgn1 = ((tau1 >= 0.5f)? 1.0f: -1.0f);
-		const float sgn2 = ((tau2 >= 0.5f)? 1.0f: -1.0f);
-		// NOTE:
-		//     should we really restrict velocity this way? if we do, then the
-		//     agent has to take MORE actions (compared to when starting from
-		//     MOST random states) to reach a goal-state, but otherwise it gets
-		//     a free advantage and obviously earns higher-than-average reward
-		//     (only states close to the domain end-points would be even better)
-		const float pos = states[n].GetPosition() + (tau1 * posRangeVariance * sgn1);
-		const float vel = states[n].GetVelocity() + (tau2 * velRangeVariance * sgn2);
-
-		states[n] = State(pos, vel);
-	}
-	*/
-	return 0;
-}
-
-
-
 HillClimber::State::State() {
 	// initialize position to the center of the valley, velocity to zero
 	mPosition = gTerrain.MinPosition() + ((gTerrain.MaxPosition() - gTerrain.MinPosition()) * 0.5f);
@@ -92,9 +59,10 @@ HillClimber::State::State(float pos, float vel): mPosition(pos), mVelocity(vel)
 
 
 HillClimber::State& HillClimber::State::Initialize(unsigned int sID) {
-	static const unsigned int posRange = (gTerrain.MaxPosition() - gTerrain.MinPosition()) * gPositionMult;
 	static const float epsilon = 0.001f;
 
+	const unsigned int posRange = GetPositionRange();
+
 	sID = std::min(sID, GetMaxID());
 	mID = sID;
 
@@ -106,19 +74,6 @@ HillClimber::State& HillClimber::State::Initialize(unsigned int sID) {
 	return *this;
 }
 
-HillClimber::State& HillClimber::State::Randomize(INumberSequenceGen* nsg) {
-	static const float minPos = gTerrain.MinPosition(), maxPos = gTerrain.MaxPosition();
-	static const float minVel = gVehicle.MinVelocity(), maxVel = gVehicle.MaxVelocity();
-
-	do {
-		mPosition = minPos + (nsg->NextFlt() * (maxPos - minPos));
-		mVelocity = minVel + (nsg->NextFlt() * (maxVel - minVel));
-	} while (IsTerminal());
-
-	assert(!IsTerminal());
-	return *this;
-}
-
 HillClimber::State HillClimber::State::ApplyAction(const IAction& action, float* reward) {
 	float actionSign = 0.0f;
 
@@ -151,10 +106,64 @@ HillClimber::State HillClimber::State::ApplyAction(const IAction& action, float*
 	return s;
 }
 
+void HillClimber::State::ApplyActions(const Batch& states, const unsigned int* actionIDs, Batch& nextStates, float* rewards, unsigned char* terminals) {
+	const unsigned int numStates = states.GetSize();
+	const unsigned int posRange = GetPositionRange();
 
+	const Terrain& terrain = gTerrain;
+	const Vehicle& vehicle = gVehicle;
+
+	nextStates.Resize(numStates);
+
+	// the gravity terms are the only calls into libm, computing them
+	// first keeps the loop below free of calls and branches
+	for (unsigned int k = 0; k < numStates; k++) {
+		nextStates.mAccelerations[k] = terrain.GravityAcceleration(states.mPositions[k]);
+	}
 
-unsigned int HillClimber::State::CalculateID() const {
+	const float* positions = &states.mPositions[0];
+	const float* velocities = &states.mVelocities[0];
+	const float* accelerations = &nextStates.mAccelerations[0];
+
+	float* nextPositions = &nextStates.mPositions[0];
+	float* nextVelocities = &nextStates.mVelocities[0];
+	unsigned int* nextIDs = &nextStates.mIDs[0];
+
+	// the same operations (in the same order) as ApplyAction, so the
+	// results are identical
+	for (unsigned int k = 0; k < numStates; k++) {
+		assert(actionIDs[k] < Action::NUM_ACTIONS);
+
+		const unsigned int actionID = actionIDs[k];
+		const float actionSign = (actionID == Action::ACTION_POSX)? 1.0f: ((actionID == Action::ACTION_NEGX)? -1.0f: 0.0f);
+		const float accEngine = vehicle.EngineAcceleration() * actionSign;
+
+		float velocity = velocities[k];
+		velocity += accEngine;
+		velocity += accelerations[k];
+		velocity *= terrain.FrictionCoefficient(positions[k]);
+		velocity  = vehicle.ClampVelocity(velocity);
+
+		const float position = terrain.ClampPosition(positions[k] + velocity);
+		const bool terminal = !terrain.PositionInBounds(position + velocity);
+
+		nextPositions[k] = position;
+		nextVelocities[k] = velocity;
+		nextIDs[k] = CalculateID(position, velocity, posRange);
+
+		rewards[k] = terminal? 1000.0f: ((actionID == Action::ACTION_IDLE)? -2.0f: -1.0f);
+		terminals[k] = terminal;
+	}
+}
+
+
+
+unsigned int HillClimber::State::GetPositionRange() {
 	static const unsigned int posRange = (gTerrain.MaxPosition() - gTerrain.MinPosition()) * gPositionMult;
+	return posRange;
+}
+
+unsigned int HillClimber::State::CalculateID(float position, float velocity, unsigned int posRange) {
 	static const float epsilon = 0.001f;
 
 	// convert position and velocity to integer representation
@@ -165,8 +174,8 @@ unsigned int HillClimber::State::CalculateID() const {
 	// we initialize a state <s> from ID <n=1>, then s.GetID()
 	// should equal <n=1>, but this is not guaranteed due to
 	// the FP-division in ::Initialize)
-	const unsigned int pos = ((mPosition - gTerrain.MinPosition()) * gPositionMult) + epsilon;
-	const unsigned int vel = ((mVelocity - gVehicle.MinVelocity()) * gVelocityMult) + epsilon;
+	const unsigned int pos = ((position - gTerrain.MinPosition()) * gPositionMult) + epsilon;
+	const unsigned int vel = ((velocity - gVehicle.MinVelocity()) * gVelocityMult) + epsilon;
 
 	return (vel * posRange + pos);
 }
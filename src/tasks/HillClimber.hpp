@@ -1,6 +1,7 @@
 #ifndef RELAX_HILLCLIMBER_TASK_HDR
 #define RELAX_HILLCLIMBER_TASK_HDR
 
+#include <cassert>
 #include <cmath>
 #include <vector>
 #include <string>
@@ -12,7 +13,6 @@
 #define gVehicle (HILL.GetVehicle())
 
 class LuaTable;
-class INumberSequenceGen;
 
 namespace RELAX {
 	namespace Tasks {
@@ -41,7 +41,7 @@ namespace RELAX {
 				// acceleration due to gravity is proportional to the length of the
 				// unit-normal projected onto the x-axis (ie. simply the value of its
 				// x-component)
-				float UnitNormal(float x) const { return (Normal(x) / std::sqrt(Normal(x) * Normal(x) + 1.0f * 1.0f)); }
+				float UnitNormal(float x) const { const float n = Normal(x); return (n / std::sqrt(n * n + 1.0f * 1.0f)); }
 				float GravityAcceleration(float x) const { return (ga * UnitNormal(x)); }
 				float FrictionCoefficient(float) const { return cf; }
 
@@ -97,6 +97,49 @@ namespace RELAX {
 
 			struct State {
 			public:
+				enum {
+					// the (continuous) position and velocity are discretized
+					// into ID's, so states sharing an ID can have successors
+					// with different ID's
+					EXACT_TRANSITIONS = 0,
+				};
+
+				// the states of a batch of episodes in structure-of-arrays
+				// form, which ApplyActions steps all at once
+				struct Batch {
+				public:
+					void Resize(unsigned int n) {
+						mPositions.resize(n);
+						mVelocities.resize(n);
+						mAccelerations.resize(n);
+						mIDs.resize(n);
+					}
+
+					void SetState(unsigned int k, const State& s) {
+						mPositions[k] = s.mPosition;
+						mVelocities[k] = s.mVelocity;
+						mIDs[k] = s.mID;
+					}
+					void GetState(unsigned int k, State& s) const {
+						s.mPosition = mPositions[k];
+						s.mVelocity = mVelocities[k];
+						s.mID = mIDs[k];
+					}
+
+					unsigned int GetSize() const { return (mIDs.size()); }
+					unsigned int GetID(unsigned int k) const { return mIDs[k]; }
+					const unsigned int* GetIDs() const { return &mIDs[0]; }
+
+				private:
+					friend struct State;
+
+					std::vector<float> mPositions;
+					std::vector<float> mVelocities;
+					// gravity at each position, only used by ApplyActions
+					std::vector<float> mAccelerations;
+					std::vector<unsigned int> mIDs;
+				};
+
 				State();
 				State(float pos, float vel);
 				State& operator = (const State& state) {
@@ -110,12 +153,29 @@ namespace RELAX {
 			public:
 				// functions required for RL
 				State ApplyAction(const IAction& action, float* reward);
+				// applies action <actionIDs[k]> to every state k in <states>
+				// and stores the successor, reward and terminal-flag (0 or 1)
+				// at k in <nextStates>, <rewards> and <terminals>, with the
+				// same results as ApplyAction; <nextStates> may be <states>
+				static void ApplyActions(const Batch& states, const unsigned int* actionIDs, Batch& nextStates, float* rewards, unsigned char* terminals);
 
 				State& Initialize(unsigned int sID);
-				State& Randomize(INumberSequenceGen* nsg);
+				template<typename TRNG> State& Randomize(TRNG* nsg) {
+					static const float minPos = gTerrain.MinPosition(), maxPos = gTerrain.MaxPosition();
+					static const float minVel = gVehicle.MinVelocity(), maxVel = gVehicle.MaxVelocity();
+
+					do {
+						mPosition = minPos + (nsg->NextFlt() * (maxPos - minPos));
+						mVelocity = minVel + (nsg->NextFlt() * (maxVel - minVel));
+					} while (IsTerminal());
+
+					assert(!IsTerminal());
+					return *this;
+				}
 
 				unsigned int GetID() const { return mID; }
 				static unsigned int GetMaxID();
+				static const char* GetTaskName() { return HillClimber::GetName(); }
 
 				bool IsTerminal() const;
 				bool operator < (const State& s) const { return (GetID() < s.GetID()); }
@@ -138,7 +198,10 @@ namespace RELAX {
 				std::string ToString() const;
 
 			private:
-				unsigned int CalculateID() const;
+				unsigned int CalculateID() const { return (CalculateID(mPosition, mVelocity, GetPositionRange())); }
+
+				static unsigned int CalculateID(float position, float velocity, unsigned int posRange);
+				static unsigned int GetPositionRange();
 
 				// constants used to generate a discrete ID for each state
 				// (together, these determine the size of the state-space)
@@ -156,7 +219,35 @@ namespace RELAX {
 			static const char* GetName() { return "HillClimber"; }
 
 			bool Initialize(const LuaTable* table);
-			unsigned int GetChosenStates(std::vector<State>&, INumberSequenceGen*);
+			template<typename TRNG> unsigned int GetChosenStates(std::vector<State>&, TRNG*) {
+				/*
+				static const float posRangeVariance = (gTerrain.MaxPosition() - gTerrain.MinPosition()) * 0.125f;
+				static const float velRangeVariance = (gVehicle.MaxVelocity() - gVehicle.MinVelocity()) * 0.125f;
+
+				assert(!states.empty());
+
+				for (unsigned int n = 0; n < states.size(); n++) {
+					// NOTE: each state is already default-initialized, but see [2] in Main
+					states[n] = State();
+
+					const float tau1 = nsg->NextFlt();
+					const float tau2 = nsg->NextFlt();
+					const float sgn1 = ((tau1 >= 0.5f)? 1.0f: -1.0f);
+					const float sgn2 = ((tau2 >= 0.5f)? 1.0f: -1.0f);
+					// NOTE:
+					//     should we really restrict velocity this way? if we do, then the
+					//     agent has to take MORE actions (compared to when starting from
+					//     MOST random states) to reach a goal-state, but otherwise it gets
+					//     a free advantage and obviously earns higher-than-average reward
+					//     (only states close to the domain end-points would be even better)
+					const float pos = states[n].GetPosition() + (tau1 * posRangeVariance * sgn1);
+					const float vel = states[n].GetVelocity() + (tau2 * velRangeVariance * sgn2);
+
+					states[n] = State(pos, vel);
+				}
+				*/
+				return 0;
+			}
 
 			const Terrain& GetTerrain() const { return mTerrain; }
 			      Terrain& GetTerrain()       { return mTerrain; }
@@ -5,6 +5,14 @@ namespace RELAX {
 	namespace Tasks {
 		struct IAction {
 		public:
+			enum {
+				// tasks with a fixed action-set declare their own
+				// (non-zero) NUM_ACTIONS, which lets the learners
+				// specialize on it at compile-time; zero means the
+				// number is only known at run-time (via GetMaxID)
+				NUM_ACTIONS = 0,
+			};
+
 			IAction(): mID(-1U) {}
 			IAction(unsigned int id): mID(id) {}
 			IAction(const IAction& a) { *this = a; }
@@ -13,7 +21,11 @@ namespace RELAX {
 			void SetID(unsigned int id) { mID = id; }
 			unsigned int GetID() const { return mID; }
 
-			virtual std::string ToString() const { return ""; }
+			// NOTE:
+			//     deliberately not virtual: actions are passed and stored
+			//     by value everywhere, so a vtable-pointer would only
+			//     triple the size of each action
+			std::string ToString() const { return ""; }
 
 		protected:
 			unsigned int mID;
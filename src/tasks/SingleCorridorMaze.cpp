@@ -3,7 +3,6 @@
 
 #include "SingleCorridorMaze.hpp"
 #include "../util/LuaParser.hpp"
-#include "../util/INumberSequenceGen.hpp"
 
 using namespace RELAX::Tasks;
 
@@ -24,16 +23,6 @@ bool SingleCorridorMaze::Initialize(const LuaTable* table) {
 	return true;
 }
 
-unsigned int SingleCorridorMaze::GetChosenStates(std::vector<State>& states, INumberSequenceGen*) {
-	// pretend the probability distribution over states
-	// has ALL mass concentrated at the left-most state,
-	// so we would always draw it during learning etc.
-	states.push_back(State());
-	return (states.size());
-}
-
-
-
 SingleCorridorMaze::State& SingleCorridorMaze::State::Initialize(unsigned int sID) {
 	sID  = std::min(sID, GetMaxID());
 	mCol = sID % MAZE.GetNumCols();
@@ -42,17 +31,6 @@ SingleCorridorMaze::State& SingleCorridorMaze::State::Initialize(unsigned int sI
 	return *this;
 }
 
-SingleCorridorMaze::State& SingleCorridorMaze::State::Randomize(INumberSequenceGen* nsg) {
-	do {
-		mRow = nsg->NextInt() % MAZE.GetNumRows();
-		mCol = nsg->NextInt() % MAZE.GetNumCols();
-		mID  = CalculateID();
-	} while (IsTerminal());
-
-	assert(!IsTerminal());
-	return *this;
-}
-
 SingleCorridorMaze::State SingleCorridorMaze::State::ApplyAction(const Action& action, float* reward) {
 	State s = *this;
 	*reward = -1.0f;
@@ -87,6 +65,42 @@ SingleCorridorMaze::State SingleCorridorMaze::State::ApplyAction(const Action& a
 	return s;
 }
 
+void SingleCorridorMaze::State::ApplyActions(const Batch& states, const unsigned int* actionIDs, Batch& nextStates, float* rewards, unsigned char* terminals) {
+	const unsigned int numStates = states.GetSize();
+	const unsigned int numRows = MAZE.GetNumRows();
+	const unsigned int numCols = MAZE.GetNumCols();
+
+	nextStates.Resize(numStates);
+
+	const unsigned int* rows = &states.mRows[0];
+	const unsigned int* cols = &states.mCols[0];
+
+	unsigned int* nextRows = &nextStates.mRows[0];
+	unsigned int* nextCols = &nextStates.mCols[0];
+	unsigned int* nextIDs = &nextStates.mIDs[0];
+
+	for (unsigned int k = 0; k < numStates; k++) {
+		const unsigned int actionID = actionIDs[k];
+		const unsigned int row = rows[k];
+		const unsigned int col = cols[k];
+
+		// LEFT and RIGHT stop at the ends of the corridor, UP and DOWN
+		// are no-ops
+		const unsigned int leftCol = (col > 0)? (col - 1): col;
+		const unsigned int rightCol = (col < (numCols - 1))? (col + 1): col;
+		const unsigned int nextCol = (actionID == Action::ACTION_LEFT)? leftCol: ((actionID == Action::ACTION_RIGHT)? rightCol: col);
+
+		const bool terminal = (nextCol == (numCols - 1) && row == (numRows - 1));
+
+		nextRows[k] = row;
+		nextCols[k] = nextCol;
+		nextIDs[k] = row * numRows + nextCol;
+
+		rewards[k] = terminal? 1000.0f: ((actionID >= Action::ACTION_UP)? -5.0f: -1.0f);
+		terminals[k] = terminal;
+	}
+}
+
 std::string SingleCorridorMaze::State::ToString() const {
 	static char buffer[128] = {'\0'};
 	static const char* format = "<col=%u, row=%u>";
@@ -1,6 +1,7 @@
 #ifndef RELAX_SINGLECORRIDORMAZE_TASK_HDR
 #define RELAX_SINGLECORRIDORMAZE_TASK_HDR
 
+#include <cassert>
 #include <cmath>
 #include <vector>
 #include <string>
@@ -10,7 +11,6 @@
 #define MAZE (SingleCorridorMaze::GetInstance())
 
 class LuaTable;
-class INumberSequenceGen;
 
 namespace RELAX {
 	namespace Tasks {
@@ -35,6 +35,46 @@ namespace RELAX {
 
 			struct State {
 			public:
+				enum {
+					// non-zero if the successor of a state (under any action)
+					// only depends on its ID, ie. if the StateSpaceGraph built
+					// from the states' ID's is exact
+					EXACT_TRANSITIONS = 1,
+				};
+
+				// the states of a batch of episodes in structure-of-arrays
+				// form, which ApplyActions steps all at once
+				struct Batch {
+				public:
+					void Resize(unsigned int n) {
+						mRows.resize(n);
+						mCols.resize(n);
+						mIDs.resize(n);
+					}
+
+					void SetState(unsigned int k, const State& s) {
+						mRows[k] = s.mRow;
+						mCols[k] = s.mCol;
+						mIDs[k] = s.mID;
+					}
+					void GetState(unsigned int k, State& s) const {
+						s.mRow = mRows[k];
+						s.mCol = mCols[k];
+						s.mID = mIDs[k];
+					}
+
+					unsigned int GetSize() const { return (mIDs.size()); }
+					unsigned int GetID(unsigned int k) const { return mIDs[k]; }
+					const unsigned int* GetIDs() const { return &mIDs[0]; }
+
+				private:
+					friend struct State;
+
+					std::vector<unsigned int> mRows;
+					std::vector<unsigned int> mCols;
+					std::vector<unsigned int> mIDs;
+				};
+
 				State(): mRow(0), mCol(0), mID(CalculateID()) {}
 				State& operator = (const State& state) {
 					mRow = state.mRow;
@@ -46,12 +86,28 @@ namespace RELAX {
 			public:
 				// functions required for RL
 				State ApplyAction(const Action& action, float* reward);
+				// applies action <actionIDs[k]> to every state k in <states>
+				// and stores the successor, reward and terminal-flag (0 or 1)
+				// at k in <nextStates>, <rewards> and <terminals>, with the
+				// same results as ApplyAction; <nextStates> may be <states>
+				static void ApplyActions(const Batch& states, const unsigned int* actionIDs, Batch& nextStates, float* rewards, unsigned char* terminals);
 
 				State& Initialize(unsigned int sID);
-				State& Randomize(INumberSequenceGen* nsg);
+				template<typename TRNG> State& Randomize(TRNG* nsg) {
+					do {
+						mRow = nsg->NextInt() % MAZE.GetNumRows();
+						mCol = nsg->NextInt() % MAZE.GetNumCols();
+						mID  = CalculateID();
+					} while (IsTerminal());
+
+					assert(!IsTerminal());
+					return *this;
+				}
 
 				unsigned int GetID() const { return mID; }
 				static unsigned int GetMaxID() { return (MAZE.GetNumRows() * MAZE.GetNumCols()) - 1; }
+				// identifies the task in serialized Q-tables and policies
+				static const char* GetTaskName() { return SingleCorridorMaze::GetName(); }
 
 				bool IsTerminal() const { return (mCol == (MAZE.GetNumCols() - 1) && mRow == (MAZE.GetNumRows() - 1)); }
 				bool operator < (const State& s) const { return (GetID() < s.GetID()); }
@@ -77,7 +133,13 @@ namespace RELAX {
 			static const char* GetName() { return "SingleCorridorMaze"; }
 
 			bool Initialize(const LuaTable*);
-			unsigned int GetChosenStates(std::vector<State>&, INumberSequenceGen*);
+			template<typename TRNG> unsigned int GetChosenStates(std::vector<State>& states, TRNG*) {
+				// pretend the probability distribution over states
+				// has ALL mass concentrated at the left-most state,
+				// so we would always draw it during learning etc.
+				states.push_back(State());
+				return (states.size());
+			}
 
 			unsigned int GetNumRows() const { return mNumRows; }
 			unsigned int GetNumCols() const { return mNumCols; }
@@ -0,0 +1,137 @@
+#include <cstdio>
+#include "../Defines.hpp"
+
+// compares stepping HillClimber states one at a time (ApplyAction) with
+// stepping batches of them (ApplyActions) for increasing batch sizes,
+// and checks that both produce bit-identical states and rewards; every
+// state that reaches a terminal one is restarted from a random state;
+// build with
+//
+//   g++ -O2 -DRELAX_TASK_BENCHMARK -o taskbench  util/*.cpp tasks/*.cpp learners/*.cpp  -llua5.1 ...
+//
+#ifdef RELAX_TASK_BENCHMARK
+#include <cstring>
+#include <vector>
+#include <lua5.1/lua.hpp>
+
+#include "HillClimber.hpp"
+#include "../util/LuaParser.hpp"
+#include "../util/RandomNumberSequenceGen.hpp"
+#include "../util/Timer.hpp"
+
+using namespace RELAX;
+
+typedef Tasks::HillClimber TTask;
+typedef TTask::State TState;
+typedef TTask::Action TAction;
+typedef XS128x4RandomNumberSequenceGen TRNG;
+
+static const unsigned int NUM_STEPS = 20000000;
+
+// steps <numStates> states NUM_STEPS times in total, either one at a
+// time or as one batch; returns the steps per second and stores the
+// final states and a checksum of the rewards
+double StepStates(unsigned int numStates, bool batched, std::vector<TState>& states, double* rewardSum) {
+	TRNG rng(1234);
+
+	TState::Batch batch;
+	TState state;
+
+	std::vector<unsigned int> actionIDs(numStates);
+	std::vector<float> rewards(numStates);
+	std::vector<unsigned char> terminals(numStates);
+
+	states.resize(numStates);
+	batch.Resize(numStates);
+
+	for (unsigned int k = 0; k < numStates; k++) {
+		states[k].Randomize(&rng);
+		batch.SetState(k, states[k]);
+	}
+
+	*rewardSum = 0.0;
+
+	Timer timer;
+
+	for (unsigned int n = 0; n < NUM_STEPS; n += numStates) {
+		for (unsigned int k = 0; k < numStates; k++) {
+			actionIDs[k] = TAction::GetRandomActionID(rng.NextInt());
+		}
+
+		if (batched) {
+			TState::ApplyActions(batch, &actionIDs[0], batch, &rewards[0], &terminals[0]);
+		} else {
+			for (unsigned int k = 0; k < numStates; k++) {
+				states[k] = states[k].ApplyAction(TAction(actionIDs[k]), &rewards[k]);
+				terminals[k] = states[k].IsTerminal();
+			}
+		}
+
+		for (unsigned int k = 0; k < numStates; k++) {
+			*rewardSum += rewards[k];
+
+			if (!terminals[k]) {
+				continue;
+			}
+
+			if (batched) {
+				batch.SetState(k, state.Randomize(&rng));
+			} else {
+				states[k].Randomize(&rng);
+			}
+		}
+	}
+
+	const double secs = timer.GetElapsedSecs();
+
+	if (batched) {
+		for (unsigned int k = 0; k < numStates; k++) {
+			batch.GetState(k, states[k]);
+		}
+	}
+
+	return (((NUM_STEPS + numStates - 1) / numStates) * numStates / secs);
+}
+
+int main() {
+	lua_State* luaState = lua_open();
+	LuaParser luaParser(luaState);
+
+	if (!luaParser.Execute("return {Terrain = {}, Vehicle = {}, positionMult = 100, velocityMult = 10}", false)) {
+		printf("[%s] error: %s\n", __FUNCTION__, (luaParser.GetError()).c_str());
+		return 1;
+	}
+
+	TTask::GetInstance().Initialize(luaParser.GetRootTbl());
+
+	const unsigned int batchSizes[] = {1, 4, 16, 64, 256, 1024};
+
+	for (unsigned int n = 0; n < (sizeof(batchSizes) / sizeof(batchSizes[0])); n++) {
+		std::vector<TState> scalarStates;
+		std::vector<TState> batchedStates;
+
+		double scalarSum = 0.0;
+		double batchedSum = 0.0;
+
+		const double scalarRate = StepStates(batchSizes[n], false, scalarStates, &scalarSum);
+		const double batchedRate = StepStates(batchSizes[n], true, batchedStates, &batchedSum);
+
+		bool identical = (scalarSum == batchedSum);
+
+		for (unsigned int k = 0; k < batchSizes[n]; k++) {
+			const float scalarValues[2] = {scalarStates[k].GetPosition(), scalarStates[k].GetVelocity()};
+			const float batchedValues[2] = {batchedStates[k].GetPosition(), batchedStates[k].GetVelocity()};
+
+			identical = identical && (scalarStates[k].GetID() == batchedStates[k].GetID());
+			identical = identical && (memcmp(scalarValues, batchedValues, sizeof(scalarValues)) == 0);
+		}
+
+		const char* format = "[%s] batch size %4u: %8.2f M steps/sec (scalar), %8.2f M steps/sec (batched), identical: %d\n";
+		printf(format, __FUNCTION__, batchSizes[n], scalarRate * 1e-6, batchedRate * 1e-6, identical);
+	}
+
+	lua_close(luaState);
+	return 0;
+}
+
+#endif
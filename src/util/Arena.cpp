@@ -0,0 +1,89 @@
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+#include "Arena.hpp"
+#include "PageAllocator.hpp"
+
+void Arena::Reserve(size_t size) {
+	assert(mData == NULL);
+	mCapacity += GetSlabSize(size);
+}
+
+bool Arena::Allocate() {
+	assert(mData == NULL);
+
+	if (mCapacity == 0) {
+		return true;
+	}
+
+	if ((mData = static_cast<char*>(PageAllocator::Allocate(mCapacity))) == NULL) {
+		printf("[Arena::%s] failed to allocate %lu bytes\n", __FUNCTION__, static_cast<unsigned long>(mCapacity));
+		return false;
+	}
+
+	return true;
+}
+
+void Arena::Release() {
+	PageAllocator::Free(mData, mCapacity);
+
+	mData = NULL;
+	mCapacity = 0;
+	mUsed = 0;
+}
+
+void* Arena::Take(size_t size) {
+	boost::mutex::scoped_lock lock(mMutex);
+
+	const size_t slabSize = GetSlabSize(size);
+
+	if (mData == NULL || (mUsed + slabSize) > mCapacity) {
+		printf("[Arena::%s] no room for %lu bytes (%lu of %lu used)\n", __FUNCTION__, static_cast<unsigned long>(size), static_cast<unsigned long>(mUsed), static_cast<unsigned long>(mCapacity));
+		return NULL;
+	}
+
+	void* slab = mData + mUsed;
+	mUsed += slabSize;
+	return slab;
+}
+
+
+
+void* ArenaBlock::Allocate(size_t size) {
+	if (size == 0) {
+		Free();
+		return NULL;
+	}
+
+	// an unused slab is all zero, a reused one has to be cleared
+	if (mData != NULL && !mOwned && size <= mCapacity) {
+		memset(mData, 0, size);
+		return mData;
+	}
+
+	Free();
+
+	if (mArena != NULL && (mData = mArena->Take(size)) != NULL) {
+		mCapacity = size;
+		mOwned = false;
+		return mData;
+	}
+
+	mData = PageAllocator::Allocate(size);
+	mCapacity = size;
+	mOwned = true;
+	return mData;
+}
+
+void ArenaBlock::Free() {
+	if (!mOwned) {
+		return;
+	}
+
+	PageAllocator::Free(mData, mCapacity);
+
+	mData = NULL;
+	mCapacity = 0;
+	mOwned = false;
+}
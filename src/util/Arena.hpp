@@ -0,0 +1,89 @@
+#ifndef RELAX_ARENA_HDR
+#define RELAX_ARENA_HDR
+
+#include <cstddef>
+
+#include <boost/thread/mutex.hpp>
+
+// one contiguous block of memory (from PageAllocator) that all objects
+// and tables of an experiment are carved from: the sizes of everything
+// it will hold are first added up with Reserve, then the whole block is
+// mapped by a single Allocate, slabs are handed out in order by Take and
+// never returned individually, and Release unmaps everything at once
+//
+// slabs are SLAB_ALIGNMENT-aligned and (as fresh pages) zero-filled
+//
+// NOTE:
+//     objects constructed in an arena (placement new) must have their
+//     destructors called explicitly before the arena is released
+class Arena {
+public:
+	enum {
+		SLAB_ALIGNMENT = 64,
+	};
+
+	Arena(): mData(NULL), mCapacity(0), mUsed(0) {}
+	~Arena() { Release(); }
+
+	// only valid before Allocate
+	void Reserve(size_t size);
+
+	bool Allocate();
+	void Release();
+
+	// thread-safe, returns NULL if the reserved capacity is exhausted
+	void* Take(size_t size);
+
+	size_t GetCapacity() const { return mCapacity; }
+	size_t GetUsed() const { return mUsed; }
+
+private:
+	// non-copyable
+	Arena(const Arena&);
+	Arena& operator = (const Arena&);
+
+	static size_t GetSlabSize(size_t size) { return (((size + SLAB_ALIGNMENT - 1) / SLAB_ALIGNMENT) * SLAB_ALIGNMENT); }
+
+private:
+	char* mData;
+
+	size_t mCapacity;
+	size_t mUsed;
+
+	boost::mutex mMutex;
+};
+
+
+
+// the memory of one table: a slab of an Arena if the table was given
+// one, otherwise pages of its own; the table keeps its slab when it is
+// cleared so a later Allocate of no larger size can reuse it (slabs of
+// an exhausted arena fall back to own pages)
+class ArenaBlock {
+public:
+	ArenaBlock(): mArena(NULL), mData(NULL), mCapacity(0), mOwned(false) {}
+	~ArenaBlock() { Free(); }
+
+	// must precede the first Allocate
+	void SetArena(Arena* arena) { mArena = arena; }
+
+	// returns <size> zero-filled bytes (NULL if <size> is zero)
+	void* Allocate(size_t size);
+	void Free();
+
+private:
+	// non-copyable (each table owns its block)
+	ArenaBlock(const ArenaBlock&);
+	ArenaBlock& operator = (const ArenaBlock&);
+
+private:
+	Arena* mArena;
+
+	void* mData;
+	size_t mCapacity;
+
+	// true if mData are own pages rather than an arena slab
+	bool mOwned;
+};
+
+#endif
@@ -0,0 +1,211 @@
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "BinaryFile.hpp"
+
+static const char* FILE_MAGIC = "RELAXBIN";
+static const uint32_t ENDIAN_TAG = 0x01020304;
+
+static uint64_t AlignUp(uint64_t n, uint64_t alignment) {
+	return (((n + alignment - 1) / alignment) * alignment);
+}
+
+static uint64_t HeaderChecksum(const BinaryFile::Header& header) {
+	return (BinaryFile::Checksum(&header, offsetof(BinaryFile::Header, headerChecksum)));
+}
+
+
+
+void BinaryFile::InitHeader(Header* header, uint32_t contentType, uint32_t dataType, uint32_t layout, const std::string& taskName) {
+	memset(header, 0, sizeof(Header));
+	memcpy(header->magic, FILE_MAGIC, sizeof(header->magic));
+	strncpy(header->taskName, taskName.c_str(), MAX_TASK_NAME - 1);
+
+	header->version = FORMAT_VERSION;
+	header->endianTag = ENDIAN_TAG;
+	header->contentType = contentType;
+	header->dataType = dataType;
+	header->layout = layout;
+}
+
+bool BinaryFile::Write(const std::string& fileName, Header* header, const void* const* sections, const uint64_t* sectionSizes) {
+	assert(header->numSections <= MAX_SECTIONS);
+	assert(sizeof(Header) <= HEADER_SIZE);
+
+	const std::string tmpFileName = fileName + ".tmp";
+
+	uint64_t offset = HEADER_SIZE;
+	uint64_t checksum = Checksum(NULL, 0);
+
+	for (unsigned int n = 0; n < header->numSections; n++) {
+		header->sectionOffsets[n] = offset;
+		header->sectionSizes[n] = sectionSizes[n];
+
+		checksum = Checksum(sections[n], sectionSizes[n], checksum);
+		offset = AlignUp(offset + sectionSizes[n], SECTION_ALIGNMENT);
+	}
+
+	header->payloadChecksum = checksum;
+	header->headerChecksum = HeaderChecksum(*header);
+
+	FILE* file = fopen(tmpFileName.c_str(), "wb");
+
+	if (file == NULL) {
+		printf("[BinaryFile::%s] cannot open \"%s\" for writing\n", __FUNCTION__, tmpFileName.c_str());
+		return false;
+	}
+
+	// header and inter-section padding are written as zeroes
+	static const char zeroes[HEADER_SIZE] = {0};
+
+	bool ok = true;
+
+	ok = ok && (fwrite(header, sizeof(Header), 1, file) == 1);
+	ok = ok && (fwrite(zeroes, HEADER_SIZE - sizeof(Header), 1, file) == 1);
+
+	for (unsigned int n = 0; n < header->numSections && ok; n++) {
+		const uint64_t padding = AlignUp(sectionSizes[n], SECTION_ALIGNMENT) - sectionSizes[n];
+
+		ok = ok && (sectionSizes[n] == 0 || fwrite(sections[n], sectionSizes[n], 1, file) == 1);
+		ok = ok && (padding == 0 || fwrite(zeroes, padding, 1, file) == 1);
+	}
+
+	ok = (fclose(file) == 0) && ok;
+	ok = ok && (rename(tmpFileName.c_str(), fileName.c_str()) == 0);
+
+	if (!ok) {
+		printf("[BinaryFile::%s] failed to write \"%s\"\n", __FUNCTION__, fileName.c_str());
+		remove(tmpFileName.c_str());
+	}
+
+	return ok;
+}
+
+
+
+bool BinaryFile::Map(const std::string& fileName, Header* header, void** data, size_t* size, bool verifyPayload) {
+	const int fd = open(fileName.c_str(), O_RDONLY);
+
+	if (fd < 0) {
+		printf("[BinaryFile::%s] cannot open \"%s\"\n", __FUNCTION__, fileName.c_str());
+		return false;
+	}
+
+	struct stat fileStat;
+
+	if (fstat(fd, &fileStat) != 0 || fileStat.st_size < HEADER_SIZE) {
+		printf("[BinaryFile::%s] \"%s\" is too small to hold a header\n", __FUNCTION__, fileName.c_str());
+		close(fd);
+		return false;
+	}
+
+	// PROT_WRITE with MAP_PRIVATE: pages stay shared with the page
+	// cache (and other processes mapping the same file) until they
+	// are written to, at which point the writer gets a private copy
+	void* mem = mmap(NULL, fileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+	close(fd);
+
+	if (mem == MAP_FAILED) {
+		printf("[BinaryFile::%s] cannot map \"%s\"\n", __FUNCTION__, fileName.c_str());
+		return false;
+	}
+
+	memcpy(header, mem, sizeof(Header));
+
+	const char* error = NULL;
+
+	if (memcmp(header->magic, FILE_MAGIC, sizeof(header->magic)) != 0) {
+		error = "bad magic";
+	} else if (header->endianTag != ENDIAN_TAG) {
+		error = "written with a different byte-order";
+	} else if (header->version != FORMAT_VERSION) {
+		error = "unsupported format version";
+	} else if (header->headerChecksum != HeaderChecksum(*header)) {
+		error = "header checksum mismatch";
+	} else if (header->numSections > MAX_SECTIONS) {
+		error = "bad section count";
+	}
+
+	for (unsigned int n = 0; n < header->numSections && error == NULL; n++) {
+		const uint64_t end = header->sectionOffsets[n] + header->sectionSizes[n];
+
+		if ((header->sectionOffsets[n] % SECTION_ALIGNMENT) != 0 || end < header->sectionOffsets[n] || end > static_cast<uint64_t>(fileStat.st_size)) {
+			error = "section out of bounds";
+		}
+	}
+
+	if (error == NULL && verifyPayload) {
+		uint64_t checksum = Checksum(NULL, 0);
+
+		for (unsigned int n = 0; n < header->numSections; n++) {
+			checksum = Checksum(static_cast<const char*>(mem) + header->sectionOffsets[n], header->sectionSizes[n], checksum);
+		}
+
+		if (checksum != header->payloadChecksum) {
+			error = "payload checksum mismatch";
+		}
+	}
+
+	if (error != NULL) {
+		printf("[BinaryFile::%s] \"%s\": %s\n", __FUNCTION__, fileName.c_str(), error);
+		munmap(mem, fileStat.st_size);
+		return false;
+	}
+
+	*data = mem;
+	*size = fileStat.st_size;
+	return true;
+}
+
+void BinaryFile::Unmap(void* data, size_t size) {
+	munmap(data, size);
+}
+
+bool BinaryFile::CheckContent(const std::string& fileName, const Header& header, uint32_t contentType, uint32_t dataType, uint32_t layout, const std::string& taskName) {
+	const char* error = NULL;
+
+	if (header.contentType != contentType) {
+		error = "unexpected content type";
+	} else if (header.dataType != dataType) {
+		error = "unexpected data type";
+	} else if (header.layout != layout) {
+		error = "unexpected layout";
+	} else if (strncmp(header.taskName, taskName.c_str(), MAX_TASK_NAME) != 0) {
+		error = "written for a different task";
+	}
+
+	if (error != NULL) {
+		printf("[BinaryFile::%s] \"%s\": %s\n", __FUNCTION__, fileName.c_str(), error);
+		return false;
+	}
+
+	return true;
+}
+
+
+
+uint64_t BinaryFile::Checksum(const void* data, size_t size, uint64_t hash) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	const size_t numWords = size / sizeof(uint64_t);
+
+	for (size_t n = 0; n < numWords; n++) {
+		uint64_t word;
+		memcpy(&word, bytes + n * sizeof(uint64_t), sizeof(uint64_t));
+
+		hash ^= word;
+		hash *= 1099511628211ULL;
+	}
+	for (size_t n = numWords * sizeof(uint64_t); n < size; n++) {
+		hash ^= bytes[n];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
@@ -0,0 +1,98 @@
+#ifndef RELAX_BINARYFILE_HDR
+#define RELAX_BINARYFILE_HDR
+
+#include <cstddef>
+#include <string>
+#include <stdint.h>
+
+// on-disk format shared by Q-tables and policies:
+//
+//   [header: HEADER_SIZE bytes][section 0][section 1]...
+//
+// the header is padded to one page and every section starts on a
+// SECTION_ALIGNMENT boundary, so a file mapped through Map can be
+// used in place (zero-copy) by a table that expects aligned rows;
+// all values are stored in host byte-order and files written on a
+// host of the opposite endianness are rejected
+class BinaryFile {
+public:
+	enum {
+		FORMAT_VERSION    = 1,
+		HEADER_SIZE       = 4096,
+		SECTION_ALIGNMENT = 64,
+		MAX_SECTIONS      = 4,
+		MAX_TASK_NAME     = 64,
+	};
+	enum {
+		CONTENT_ACTION_VALUES = 1, // Q-table (section 0: values, section 1: row maxima)
+		CONTENT_STATE_ACTIONS = 2, // policy  (section 0: packed action-ID's)
+		CONTENT_CHECKPOINT    = 3, // learning checkpoint (see Checkpoint)
+		CONTENT_REWARD_TRACES = 4, // reward traces of one shard (see RewardTraces)
+	};
+	enum {
+		DTYPE_FLOAT32  = 1,
+		DTYPE_UINT2    = 2, // packed into 32-bit words, 16 per word
+		DTYPE_UINT4    = 3, // packed into 32-bit words,  8 per word
+		DTYPE_UINT8    = 4, // packed into 32-bit words,  4 per word
+		DTYPE_FLOAT16  = 5, // IEEE half-precision
+		DTYPE_BFLOAT16 = 6, // upper 16 bits of a float32
+		DTYPE_INT16    = 7, // fixed-point, scale stored alongside
+	};
+	enum {
+		LAYOUT_PADDED_ROWS  = 1, // numStates rows of rowStride elements
+		LAYOUT_PACKED_WORDS = 2, // numStates elements, no padding
+		LAYOUT_HASHED_ROWS  = 3, // padded rows of visited states only, plus their state-ID's
+		LAYOUT_POLICY_ROWS  = 4, // one unpadded row per policy
+	};
+
+	struct Header {
+		char magic[8];
+
+		uint32_t version;
+		uint32_t endianTag;
+		uint32_t contentType;
+		uint32_t dataType;
+		uint32_t layout;
+
+		uint32_t numStates;
+		uint32_t numActions;
+		uint32_t rowStride;   // in elements (LAYOUT_PADDED_ROWS only)
+
+		uint32_t numSections;
+		uint32_t reserved;
+
+		uint64_t sectionOffsets[MAX_SECTIONS];
+		uint64_t sectionSizes[MAX_SECTIONS];
+
+		// covers all sections (in order), excluding padding
+		uint64_t payloadChecksum;
+
+		char taskName[MAX_TASK_NAME];
+
+		// covers every header field before this one
+		uint64_t headerChecksum;
+	};
+
+	static void InitHeader(Header* header, uint32_t contentType, uint32_t dataType, uint32_t layout, const std::string& taskName);
+
+	// writes the header and <header->numSections> sections (whose
+	// offsets, sizes and checksums are filled in here) to a temporary
+	// file that is renamed to <fileName> once complete
+	static bool Write(const std::string& fileName, Header* header, const void* const* sections, const uint64_t* sectionSizes);
+
+	// maps <fileName> privately (copy-on-write) into memory and checks
+	// its header; the payload checksum is only verified if requested
+	// since that touches every page; on success the caller owns the
+	// mapping and releases it with Unmap
+	static bool Map(const std::string& fileName, Header* header, void** data, size_t* size, bool verifyPayload);
+	static void Unmap(void* data, size_t size);
+
+	// checks the fields that identify what a file contains (as opposed
+	// to whether it is intact, which Map takes care of)
+	static bool CheckContent(const std::string& fileName, const Header& header, uint32_t contentType, uint32_t dataType, uint32_t layout, const std::string& taskName);
+
+	// 64-bit FNV-1a over <size> bytes, one 8-byte word at a time
+	static uint64_t Checksum(const void* data, size_t size, uint64_t hash = 14695981039346656037ULL);
+};
+
+#endif
@@ -0,0 +1,142 @@
+#include <cstdio>
+#include <cstring>
+
+#include <boost/bind/bind.hpp>
+
+#include "Checkpoint.hpp"
+#include "BinaryFile.hpp"
+
+bool Checkpoint::Save(const std::string& fileName, const std::string& taskName) const {
+	BinaryFile::Header header;
+	BinaryFile::InitHeader(&header, BinaryFile::CONTENT_CHECKPOINT, BinaryFile::DTYPE_FLOAT32, BinaryFile::LAYOUT_PADDED_ROWS, taskName);
+
+	header.numStates = mNumStates;
+	header.numActions = mNumActions;
+	header.numSections = NUM_SECTIONS;
+
+	const void* sections[NUM_SECTIONS];
+	uint64_t sectionSizes[NUM_SECTIONS];
+
+	for (unsigned int n = 0; n < NUM_SECTIONS; n++) {
+		sections[n] = mSections[n].empty()? NULL: &mSections[n][0];
+		sectionSizes[n] = mSections[n].size();
+	}
+
+	return (BinaryFile::Write(fileName, &header, sections, sectionSizes));
+}
+
+bool Checkpoint::Load(const std::string& fileName, const std::string& taskName) {
+	BinaryFile::Header header;
+
+	void* data = NULL;
+	size_t size = 0;
+
+	// checkpoints are read once and copied, so always verify them
+	if (!BinaryFile::Map(fileName, &header, &data, &size, true)) {
+		return false;
+	}
+
+	bool ok = BinaryFile::CheckContent(fileName, header, BinaryFile::CONTENT_CHECKPOINT, BinaryFile::DTYPE_FLOAT32, BinaryFile::LAYOUT_PADDED_ROWS, taskName);
+
+	if (ok && header.numSections != NUM_SECTIONS) {
+		printf("[Checkpoint::%s] \"%s\": unexpected section count\n", __FUNCTION__, fileName.c_str());
+		ok = false;
+	}
+
+	if (ok) {
+		for (unsigned int n = 0; n < NUM_SECTIONS; n++) {
+			const char* section = static_cast<const char*>(data) + header.sectionOffsets[n];
+			mSections[n].assign(section, section + header.sectionSizes[n]);
+		}
+
+		mNumStates = header.numStates;
+		mNumActions = header.numActions;
+	}
+
+	BinaryFile::Unmap(data, size);
+	return ok;
+}
+
+
+
+CheckpointWriter::CheckpointWriter(const std::string& taskName): mTaskName(taskName) {
+	mWriting = false;
+	mStopping = false;
+
+	mNumWritten = 0;
+	mNumDropped = 0;
+
+	mThread = boost::thread(boost::bind(&CheckpointWriter::WriterThread, this));
+}
+
+CheckpointWriter::~CheckpointWriter() {
+	{
+		boost::mutex::scoped_lock lock(mMutex);
+		mStopping = true;
+		mPendingCond.notify_one();
+	}
+
+	// the writer drains mPending before it exits
+	mThread.join();
+}
+
+void CheckpointWriter::Submit(const std::string& fileName, Checkpoint* checkpoint) {
+	boost::mutex::scoped_lock lock(mMutex);
+
+	for (std::list<PendingCheckpoint>::iterator it = mPending.begin(); it != mPending.end(); ++it) {
+		if (it->fileName == fileName) {
+			delete it->checkpoint;
+			it->checkpoint = checkpoint;
+
+			mNumDropped += 1;
+			return;
+		}
+	}
+
+	PendingCheckpoint pending;
+	pending.fileName = fileName;
+	pending.checkpoint = checkpoint;
+
+	mPending.push_back(pending);
+	mPendingCond.notify_one();
+}
+
+void CheckpointWriter::Flush() {
+	boost::mutex::scoped_lock lock(mMutex);
+
+	while (!mPending.empty() || mWriting) {
+		mWrittenCond.wait(lock);
+	}
+}
+
+void CheckpointWriter::WriterThread() {
+	boost::mutex::scoped_lock lock(mMutex);
+
+	while (true) {
+		while (mPending.empty() && !mStopping) {
+			mPendingCond.wait(lock);
+		}
+
+		if (mPending.empty()) {
+			break;
+		}
+
+		PendingCheckpoint pending = mPending.front();
+		mPending.pop_front();
+		mWriting = true;
+
+		// do not hold the lock during I/O, learners keep submitting
+		lock.unlock();
+
+		if (!pending.checkpoint->Save(pending.fileName, mTaskName)) {
+			printf("[CheckpointWriter::%s] failed to write checkpoint \"%s\"\n", __FUNCTION__, pending.fileName.c_str());
+		}
+
+		delete pending.checkpoint;
+		lock.lock();
+
+		mWriting = false;
+		mNumWritten += 1;
+		mWrittenCond.notify_all();
+	}
+}
@@ -0,0 +1,115 @@
+#ifndef RELAX_CHECKPOINT_HDR
+#define RELAX_CHECKPOINT_HDR
+
+#include <cstring>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <boost/static_assert.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/type_traits/has_trivial_copy.hpp>
+
+// snapshot of a (learner, policy) pair in the middle of learning,
+// stored as a BinaryFile with one section per component; the state
+// sections hold the raw bytes of plain value types and are only
+// meant to be read back by the same build that wrote them (Load
+// rejects sections whose size differs from what is expected)
+class Checkpoint {
+public:
+	enum {
+		SECTION_ACTION_VALUES = 0, // padded rows of the Q-table
+		SECTION_ROW_MAXIMA    = 1, // cached row maxima of the Q-table
+		SECTION_LEARNER_STATE = 2, // parameters, RNG and buffered numbers
+		SECTION_POLICY_STATE  = 3, // episode index and reward trace
+		NUM_SECTIONS          = 4,
+	};
+
+	Checkpoint(): mNumStates(0), mNumActions(0) {}
+
+	bool Save(const std::string& fileName, const std::string& taskName) const;
+	bool Load(const std::string& fileName, const std::string& taskName);
+
+	std::vector<char>& GetSection(unsigned int i) { return mSections[i]; }
+	const std::vector<char>& GetSection(unsigned int i) const { return mSections[i]; }
+
+	// T must be a plain value type (no pointers, no user-defined
+	// copying) for its bytes to stand for it
+	template<typename T> void SetSectionValue(unsigned int i, const T& value) {
+		BOOST_STATIC_ASSERT(boost::has_trivial_copy<T>::value);
+
+		mSections[i].resize(sizeof(T));
+		memcpy(&mSections[i][0], &value, sizeof(T));
+	}
+	template<typename T> bool GetSectionValue(unsigned int i, T* value) const {
+		BOOST_STATIC_ASSERT(boost::has_trivial_copy<T>::value);
+
+		if (mSections[i].size() != sizeof(T))
+			return false;
+
+		memcpy(value, &mSections[i][0], sizeof(T));
+		return true;
+	}
+
+	void SetNumStates(unsigned int n) { mNumStates = n; }
+	void SetNumActions(unsigned int n) { mNumActions = n; }
+	unsigned int GetNumStates() const { return mNumStates; }
+	unsigned int GetNumActions() const { return mNumActions; }
+
+private:
+	std::vector<char> mSections[NUM_SECTIONS];
+
+	unsigned int mNumStates;
+	unsigned int mNumActions;
+};
+
+
+
+// writes checkpoints on a background thread so that learning only
+// pays for taking the in-memory snapshot; if a newer checkpoint for
+// the same file is submitted before the previous one was written,
+// the older one is dropped (only the latest state matters)
+class CheckpointWriter {
+public:
+	CheckpointWriter(const std::string& taskName);
+	// blocks until every pending checkpoint has been written
+	~CheckpointWriter();
+
+	// takes ownership of <checkpoint>
+	void Submit(const std::string& fileName, Checkpoint* checkpoint);
+	// blocks until every checkpoint submitted so far has been written
+	void Flush();
+
+	unsigned int GetNumWritten() const { return mNumWritten; }
+	unsigned int GetNumDropped() const { return mNumDropped; }
+
+private:
+	struct PendingCheckpoint {
+		std::string fileName;
+		Checkpoint* checkpoint;
+	};
+
+	void WriterThread();
+
+private:
+	const std::string mTaskName;
+
+	std::list<PendingCheckpoint> mPending;
+
+	boost::mutex mMutex;
+	boost::condition_variable mPendingCond; // signalled on Submit and shutdown
+	boost::condition_variable mWrittenCond; // signalled after each write
+	boost::thread mThread;
+
+	// true while the writer thread is saving a checkpoint it has
+	// already removed from mPending
+	bool mWriting;
+	bool mStopping;
+
+	unsigned int mNumWritten;
+	unsigned int mNumDropped;
+};
+
+#endif
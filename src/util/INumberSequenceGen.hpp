@@ -7,6 +7,49 @@ public:
 
 	virtual unsigned int NextInt() = 0;
 	virtual double NextFlt() = 0;
+
+	// bulk versions: fill <buf> with <num> uniform 32-bit integers,
+	// single-precision floats in [0, 1), or Bernoulli(p) outcomes
+	virtual void FillInts(unsigned int* buf, unsigned int num) {
+		for (unsigned int n = 0; n < num; n++) {
+			buf[n] = NextInt();
+		}
+	}
+	virtual void FillFlts(float* buf, unsigned int num) {
+		for (unsigned int n = 0; n < num; n++) {
+			buf[n] = IntToFlt(NextInt());
+		}
+	}
+	virtual void FillBernoulli(unsigned char* buf, unsigned int num, float p) {
+		for (unsigned int n = 0; n < num; n++) {
+			buf[n] = IntToBernoulli(NextInt(), p);
+		}
+	}
+
+	// conversions shared by all generators' bulk functions: the top
+	// 24 bits of an integer map exactly onto a float in [0, 1)
+	static float IntToFlt(unsigned int x) { return ((x >> 8) * (1.0f / 16777216.0f)); }
+	static unsigned char IntToBernoulli(unsigned int x, float p) { return (IntToFlt(x) < p); }
+};
+
+// exposes any (non-virtual) generator through INumberSequenceGen
+// for code that has to select its RNG at run-time; the learners,
+// policies and tasks take the generator type as template argument
+// instead so that calls to it can be inlined
+template<typename TRNG> class NumberSequenceGenAdapter: public INumberSequenceGen {
+public:
+	NumberSequenceGenAdapter() {}
+	NumberSequenceGenAdapter(unsigned int s): mRNG(s) {}
+
+	unsigned int NextInt() { return mRNG.NextInt(); }
+	double NextFlt() { return mRNG.NextFlt(); }
+
+	void FillInts(unsigned int* buf, unsigned int num) { mRNG.FillInts(buf, num); }
+	void FillFlts(float* buf, unsigned int num) { mRNG.FillFlts(buf, num); }
+	void FillBernoulli(unsigned char* buf, unsigned int num, float p) { mRNG.FillBernoulli(buf, num, p); }
+
+private:
+	TRNG mRNG;
 };
 
 #endif
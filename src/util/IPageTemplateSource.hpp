@@ -0,0 +1,15 @@
+#ifndef RELAX_IPAGETEMPLATESOURCE_HDR
+#define RELAX_IPAGETEMPLATESOURCE_HDR
+
+#include <cstddef>
+
+class IPageTemplateSource {
+public:
+	virtual ~IPageTemplateSource() {}
+
+	// writes the contents of a new template to <data> (<size> bytes,
+	// zero-filled); called at most once per template
+	virtual void Fill(void* data, size_t size) const = 0;
+};
+
+#endif
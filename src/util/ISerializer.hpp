@@ -1,20 +1,17 @@
 #ifndef RELAX_ISERIALIZER_HDR
 #define RELAX_ISERIALIZER_HDR
 
-#include <fstream>
-#include <sstream>
+#include <string>
 
+// implementations store their data as a BinaryFile; each direction
+// is explicit (a missing file is an error for Deserialize rather than
+// a cue to write one) and both return false on failure
 class ISerializer {
 public:
-	virtual ~ISerializer() {
-		mSerializerFileStream.flush();
-		mSerializerFileStream.close();
-	}
+	virtual ~ISerializer() {}
 
-	virtual void Serialize(const std::string& fileName) = 0;
-
-protected:
-	std::fstream mSerializerFileStream;
+	virtual bool Serialize(const std::string& fileName) const = 0;
+	virtual bool Deserialize(const std::string& fileName) = 0;
 };
 
 #endif
@@ -0,0 +1,15 @@
+#ifndef RELAX_ITHREADPOOLJOB_HDR
+#define RELAX_ITHREADPOOLJOB_HDR
+
+class IThreadPoolJob {
+public:
+	virtual ~IThreadPoolJob() {}
+
+	virtual void Execute() = 0;
+
+	// (estimated) amount of work this job represents, in arbitrary
+	// units; only the relative ordering between jobs is meaningful
+	virtual unsigned long GetCost() const = 0;
+};
+
+#endif
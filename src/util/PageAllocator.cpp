@@ -0,0 +1,164 @@
+#include <cstdio>
+#include <fstream>
+
+#include <sys/mman.h>
+
+#include <boost/thread/mutex.hpp>
+
+#include "PageAllocator.hpp"
+
+static const char* HUGE_PAGE_MODE_NAMES[] = {"off", "advise", "explicit"};
+
+static unsigned int gHugePageMode = PageAllocator::HUGE_PAGES_OFF;
+static unsigned int gNumFallbacks = 0;
+
+// tables are allocated from any number of threads (see InitializeJob)
+static boost::mutex gFallbacksMutex;
+
+static size_t AlignUp(size_t n, size_t alignment) {
+	return (((n + alignment - 1) / alignment) * alignment);
+}
+
+static size_t GetMappedSize(size_t size) {
+	return ((size >= PageAllocator::HUGE_PAGE_SIZE)? AlignUp(size, PageAllocator::HUGE_PAGE_SIZE): size);
+}
+
+static void CountFallback() {
+	boost::mutex::scoped_lock lock(gFallbacksMutex);
+	gNumFallbacks += 1;
+}
+
+static void* MapPages(size_t size, int flags) {
+	void* mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+	return ((mem == MAP_FAILED)? NULL: mem);
+}
+
+// maps <size> (a multiple of HUGE_PAGE_SIZE) bytes starting on a huge
+// page boundary by over-mapping and trimming both ends, so the THP code
+// can back every 2MB of the block (rather than all but its edges)
+static void* MapAlignedPages(size_t size) {
+	char* mem = static_cast<char*>(MapPages(size + PageAllocator::HUGE_PAGE_SIZE, 0));
+
+	if (mem == NULL) {
+		return NULL;
+	}
+
+	char* alignedMem = reinterpret_cast<char*>(AlignUp(reinterpret_cast<size_t>(mem), PageAllocator::HUGE_PAGE_SIZE));
+
+	const size_t headSize = alignedMem - mem;
+	const size_t tailSize = PageAllocator::HUGE_PAGE_SIZE - headSize;
+
+	if (headSize != 0) {
+		munmap(mem, headSize);
+	}
+	if (tailSize != 0) {
+		munmap(alignedMem + size, tailSize);
+	}
+
+	return alignedMem;
+}
+
+
+
+void* PageAllocator::Allocate(size_t size) {
+	if (size == 0) {
+		return NULL;
+	}
+
+	const size_t mappedSize = GetMappedSize(size);
+	const unsigned int mode = (size >= HUGE_PAGE_SIZE)? gHugePageMode: static_cast<unsigned int>(HUGE_PAGES_OFF);
+
+	void* mem = NULL;
+
+	if (mode == HUGE_PAGES_EXPLICIT) {
+		#ifdef MAP_HUGETLB
+		if ((mem = MapPages(mappedSize, MAP_HUGETLB)) != NULL) {
+			return mem;
+		}
+		#endif
+
+		CountFallback();
+	}
+
+	if (mode != HUGE_PAGES_OFF) {
+		mem = MapAlignedPages(mappedSize);
+
+		#ifdef MADV_HUGEPAGE
+		const bool advised = (mem != NULL && madvise(mem, mappedSize, MADV_HUGEPAGE) == 0);
+		#else
+		const bool advised = false;
+		#endif
+
+		// without THP support the (regular) pages are still usable
+		if (mem != NULL && !advised) {
+			CountFallback();
+		}
+	} else {
+		mem = MapPages(mappedSize, 0);
+	}
+
+	if (mem == NULL) {
+		printf("[PageAllocator::%s] failed to map %lu bytes\n", __FUNCTION__, static_cast<unsigned long>(size));
+	}
+
+	return mem;
+}
+
+void PageAllocator::Free(void* data, size_t size) {
+	if (data == NULL) {
+		return;
+	}
+
+	munmap(data, GetMappedSize(size));
+}
+
+
+
+void PageAllocator::SetHugePageMode(unsigned int mode) { gHugePageMode = mode; }
+unsigned int PageAllocator::GetHugePageMode() { return gHugePageMode; }
+
+unsigned int PageAllocator::GetNumFallbacks() {
+	boost::mutex::scoped_lock lock(gFallbacksMutex);
+	return gNumFallbacks;
+}
+
+bool PageAllocator::GetResidentMemory(ResidentMemory* memory) {
+	std::ifstream smaps("/proc/self/smaps_rollup");
+	std::string key;
+
+	memory->rssKB = 0;
+	memory->pssKB = 0;
+	memory->anonHugePagesKB = 0;
+
+	if (!smaps.is_open()) {
+		return false;
+	}
+
+	while (smaps >> key) {
+		if (key == "Rss:") {
+			smaps >> memory->rssKB;
+		} else if (key == "Pss:") {
+			smaps >> memory->pssKB;
+		} else if (key == "AnonHugePages:") {
+			smaps >> memory->anonHugePagesKB;
+		}
+
+		smaps.ignore(1024, '\n');
+	}
+
+	return true;
+}
+
+unsigned int PageAllocator::GetHugePageModeFromName(const std::string& name) {
+	for (unsigned int mode = HUGE_PAGES_OFF; mode <= HUGE_PAGES_EXPLICIT; mode++) {
+		if (name == HUGE_PAGE_MODE_NAMES[mode]) {
+			return mode;
+		}
+	}
+
+	return HUGE_PAGES_OFF;
+}
+
+const char* PageAllocator::GetHugePageModeName(unsigned int mode) {
+	return (HUGE_PAGE_MODE_NAMES[(mode <= HUGE_PAGES_EXPLICIT)? mode: static_cast<unsigned int>(HUGE_PAGES_OFF)]);
+}
@@ -0,0 +1,68 @@
+#ifndef RELAX_PAGEALLOCATOR_HDR
+#define RELAX_PAGEALLOCATOR_HDR
+
+#include <cstddef>
+#include <string>
+
+// hands out zero-filled blocks of whole pages, mapped straight from
+// the kernel (anonymous and private); nothing is touched up front, so
+// allocating a table of any size is O(1) and each page is only backed
+// by memory (a fresh zero page) once it is first accessed
+//
+// blocks of at least HUGE_PAGE_SIZE bytes can be backed by 2MB pages
+// (one TLB entry instead of 512) according to the huge-page mode:
+//
+//   HUGE_PAGES_OFF:      regular pages only
+//   HUGE_PAGES_ADVISE:   align the block to 2MB and madvise it to the
+//                        kernel's transparent huge-page (THP) support,
+//                        which fills it with huge pages where it can
+//   HUGE_PAGES_EXPLICIT: map the block from the reserved hugetlbfs
+//                        pool (MAP_HUGETLB) and fall back to advising
+//                        THP when the pool is empty or missing
+//
+// NOTE:
+//     blocks are page-aligned, which covers every alignment our tables
+//     ask for; Free must be given the same size as Allocate was, and
+//     large blocks are always rounded up to whole huge pages (only the
+//     virtual size grows) so that Free does not depend on the mode
+class PageAllocator {
+public:
+	enum {
+		HUGE_PAGES_OFF      = 0,
+		HUGE_PAGES_ADVISE   = 1,
+		HUGE_PAGES_EXPLICIT = 2,
+	};
+	enum {
+		HUGE_PAGE_SIZE = 2 * 1024 * 1024,
+	};
+
+	// memory of the whole process (in kB) that is resident: rssKB
+	// counts a page shared between mappings once per mapping, pssKB
+	// charges each mapping its share of it (so pages of zero-filled or
+	// copy-on-write tables only count once they were copied)
+	struct ResidentMemory {
+		unsigned long rssKB;
+		unsigned long pssKB;
+		unsigned long anonHugePagesKB;
+	};
+
+	// returns NULL if the mapping fails (or if <size> is zero)
+	static void* Allocate(size_t size);
+	static void Free(void* data, size_t size);
+
+	// applies to blocks allocated after the call
+	static void SetHugePageMode(unsigned int mode);
+	static unsigned int GetHugePageMode();
+
+	// number of large blocks that were requested with huge pages but
+	// had to fall back (from MAP_HUGETLB to THP, or from THP to none)
+	static unsigned int GetNumFallbacks();
+
+	// read from /proc/self/smaps_rollup, returns false if unavailable
+	static bool GetResidentMemory(ResidentMemory* memory);
+
+	static unsigned int GetHugePageModeFromName(const std::string& name);
+	static const char* GetHugePageModeName(unsigned int mode);
+};
+
+#endif
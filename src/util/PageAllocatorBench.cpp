@@ -0,0 +1,196 @@
+#include <cstdio>
+#include "../Defines.hpp"
+
+// measures what backing the action-value table by huge pages buys on
+// HillClimber: runs the Q-learning step loop (epsilon-greedy selection,
+// task transition and update, the same as QLearning::ExecuteEpisode)
+// over tables of increasing size for each huge-page mode and reports
+// steps/sec, the dTLB misses per step counted by perf_event_open (if
+// the kernel permits user-space counting) and how much of the process
+// the kernel actually backed by huge pages; build with
+//
+//   g++ -O2 -DRELAX_HUGEPAGE_BENCHMARK -o hugepagebench  util/*.cpp tasks/*.cpp learners/*.cpp  -llua5.1 -lboost_thread -lboost_system -lpthread
+//
+#ifdef RELAX_HUGEPAGE_BENCHMARK
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <lua5.1/lua.hpp>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "LuaParser.hpp"
+#include "PageAllocator.hpp"
+#include "RandomNumberSequenceGen.hpp"
+#include "Timer.hpp"
+#include "../learners/ActionValueStorage.hpp"
+#include "../tasks/HillClimber.hpp"
+
+using namespace RELAX;
+
+typedef Tasks::HillClimber TTask;
+typedef TTask::State TState;
+typedef TTask::Action TAction;
+typedef XS128x4RandomNumberSequenceGen TRNG;
+
+static const unsigned int NUM_STEPS = 20000000;
+static const unsigned int MAX_EPISODE_STEPS = 1000;
+
+// user-space only hardware cache-event counter
+class PerfCounter {
+public:
+	PerfCounter(uint64_t cacheEvent): mFD(-1) {
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HW_CACHE;
+		attr.config = cacheEvent;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+
+		if ((mFD = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0)) < 0) {
+			mError = strerror(errno);
+		}
+	}
+	~PerfCounter() {
+		if (mFD >= 0) {
+			close(mFD);
+		}
+	}
+
+	void Start() {
+		if (mFD >= 0) {
+			ioctl(mFD, PERF_EVENT_IOC_RESET, 0);
+			ioctl(mFD, PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+	uint64_t Stop() {
+		uint64_t count = 0;
+
+		if (mFD >= 0) {
+			ioctl(mFD, PERF_EVENT_IOC_DISABLE, 0);
+
+			if (read(mFD, &count, sizeof(count)) != sizeof(count)) {
+				count = 0;
+			}
+		}
+
+		return count;
+	}
+
+	bool IsAvailable() const { return (mFD >= 0); }
+	const std::string& GetError() const { return mError; }
+
+private:
+	int mFD;
+
+	std::string mError;
+};
+
+static uint64_t GetDTLBEvent(unsigned int op) {
+	return (PERF_COUNT_HW_CACHE_DTLB | (op << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+}
+
+static void BenchSteps(unsigned int hugePageMode) {
+	PageAllocator::SetHugePageMode(hugePageMode);
+
+	Learners::ActionValueStorage q;
+	q.Resize(TState::GetMaxID() + 1, TAction::GetMaxID() + 1);
+	// fault in every page up front (so each mode's pages are in place
+	// before timing starts) with non-uniform values
+	q.Randomize(1234);
+
+	TRNG rng(1234);
+	TState state;
+	state.Randomize(&rng);
+
+	PerfCounter loadMisses(GetDTLBEvent(PERF_COUNT_HW_CACHE_OP_READ));
+	PerfCounter storeMisses(GetDTLBEvent(PERF_COUNT_HW_CACHE_OP_WRITE));
+
+	float sum = 0.0f;
+	Timer timer;
+
+	loadMisses.Start();
+	storeMisses.Start();
+
+	for (unsigned int n = 0, episodeSteps = 0; n < NUM_STEPS; n++, episodeSteps++) {
+		if (state.IsTerminal() || episodeSteps == MAX_EPISODE_STEPS) {
+			state.Randomize(&rng);
+			episodeSteps = 0;
+		}
+
+		unsigned int maxCol = 0;
+		float reward = 0.0f;
+
+		q.GetMaxValue<TAction::NUM_ACTIONS>(state.GetID(), &maxCol);
+
+		const TAction action((rng.NextFlt() >= 0.1f)? maxCol: TAction::GetRandomActionID(rng.NextInt()));
+		const TState sstate = state.ApplyAction(action, &reward);
+
+		unsigned int maxCol2 = 0;
+
+		const float qsa = q.GetValue<TAction::NUM_ACTIONS>(state.GetID(), action.GetID());
+		const float qssa = q.GetMaxValue<TAction::NUM_ACTIONS>(sstate.GetID(), &maxCol2);
+
+		q.SetValue<TAction::NUM_ACTIONS>(state.GetID(), action.GetID(), qsa + 0.1f * (reward + 0.99f * qssa - qsa));
+
+		sum += reward;
+		state = sstate;
+	}
+
+	const uint64_t numLoadMisses = loadMisses.Stop();
+	const uint64_t numStoreMisses = storeMisses.Stop();
+	const double secs = timer.GetElapsedSecs();
+
+	printf("    %-8s %7.2f M steps/sec, ", PageAllocator::GetHugePageModeName(hugePageMode), (NUM_STEPS / secs) * 1e-6);
+
+	if (loadMisses.IsAvailable() && storeMisses.IsAvailable()) {
+		printf("dTLB misses/step: %6.3f loads, %6.3f stores, ", double(numLoadMisses) / NUM_STEPS, double(numStoreMisses) / NUM_STEPS);
+	} else {
+		printf("dTLB counters unavailable (%s), ", (loadMisses.IsAvailable()? storeMisses: loadMisses).GetError().c_str());
+	}
+
+	PageAllocator::ResidentMemory memory;
+	PageAllocator::GetResidentMemory(&memory);
+
+	printf("AnonHugePages %7lu kB (checksum %f)\n", memory.anonHugePagesKB, sum);
+}
+
+// the state-space resolution is fixed once the task is initialized,
+// so each table size is a separate run:
+//
+//   hugepagebench [positionMult velocityMult]
+//
+// (250 25: ~0.4M states, 1000 100: ~6.3M, 2000 200: ~25M)
+int main(int argc, char** argv) {
+	char luaSource[256];
+	snprintf(luaSource, sizeof(luaSource), "return {Terrain = {}, Vehicle = {}, positionMult = %s, velocityMult = %s}", ((argc > 2)? argv[1]: "2000"), ((argc > 2)? argv[2]: "200"));
+
+	lua_State* luaState = lua_open();
+	LuaParser luaParser(luaState);
+
+	if (!luaParser.Execute(luaSource, false)) {
+		printf("[%s] error: %s\n", __FUNCTION__, (luaParser.GetError()).c_str());
+		return 1;
+	}
+
+	TTask::GetInstance().Initialize(luaParser.GetRootTbl());
+
+	printf("[%s] |S| = %u (%.1f MB Q-table)\n", __FUNCTION__, TState::GetMaxID() + 1, Learners::ActionValueTable::CalcSize(TState::GetMaxID() + 1, TAction::GetMaxID() + 1) / (1024.0 * 1024.0));
+
+	BenchSteps(PageAllocator::HUGE_PAGES_OFF);
+	BenchSteps(PageAllocator::HUGE_PAGES_ADVISE);
+	BenchSteps(PageAllocator::HUGE_PAGES_EXPLICIT);
+
+	printf("    (%u allocations fell back to smaller pages)\n", PageAllocator::GetNumFallbacks());
+
+	lua_close(luaState);
+	return 0;
+}
+
+#endif
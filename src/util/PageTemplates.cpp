@@ -0,0 +1,87 @@
+#include <cstdio>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "IPageTemplateSource.hpp"
+#include "PageTemplates.hpp"
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+void* PageTemplates::Map(uint64_t key, size_t size, const IPageTemplateSource& source) {
+	boost::mutex::scoped_lock lock(mMutex);
+
+	std::map<uint64_t, Template>::iterator it = mTemplates.find(key);
+
+	if (it == mTemplates.end()) {
+		Template t;
+		t.fd = CreateFile(size, source);
+		t.size = size;
+
+		if (t.fd < 0) {
+			return NULL;
+		}
+
+		it = mTemplates.insert(std::make_pair(key, t)).first;
+	}
+
+	if ((it->second).size != size) {
+		return NULL;
+	}
+
+	void* data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, (it->second).fd, 0);
+
+	if (data == MAP_FAILED) {
+		printf("[PageTemplates::%s] failed to map template (%lu bytes)\n", __FUNCTION__, static_cast<unsigned long>(size));
+		return NULL;
+	}
+
+	mNumMappings += 1;
+	return data;
+}
+
+void PageTemplates::Clear() {
+	boost::mutex::scoped_lock lock(mMutex);
+
+	for (std::map<uint64_t, Template>::iterator it = mTemplates.begin(); it != mTemplates.end(); ++it) {
+		close((it->second).fd);
+	}
+
+	mTemplates.clear();
+}
+
+
+
+int PageTemplates::CreateFile(size_t size, const IPageTemplateSource& source) {
+	#ifdef SYS_memfd_create
+	const int fd = syscall(SYS_memfd_create, "relax-template", MFD_CLOEXEC);
+	#else
+	const int fd = -1;
+	#endif
+
+	if (fd < 0) {
+		printf("[PageTemplates::%s] memfd_create is not available, tables will not be shared\n", __FUNCTION__);
+		return -1;
+	}
+
+	void* data = MAP_FAILED;
+
+	if (ftruncate(fd, size) == 0) {
+		data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	}
+
+	if (data == MAP_FAILED) {
+		printf("[PageTemplates::%s] failed to create template (%lu bytes)\n", __FUNCTION__, static_cast<unsigned long>(size));
+		close(fd);
+		return -1;
+	}
+
+	// written through a shared mapping so the pages land in the file
+	source.Fill(data, size);
+	munmap(data, size);
+	return fd;
+}
@@ -0,0 +1,64 @@
+#ifndef RELAX_PAGETEMPLATES_HDR
+#define RELAX_PAGETEMPLATES_HDR
+
+#include <cstddef>
+#include <map>
+#include <stdint.h>
+
+#include <boost/thread/mutex.hpp>
+
+class IPageTemplateSource;
+
+// initial contents shared by any number of tables: each template lives
+// in an anonymous in-memory file (memfd) of which every table gets its
+// own private mapping, so all of them share the template's pages until
+// they write to one, at which point the kernel copies just that page;
+// memory use is then proportional to the pages each table has touched
+// rather than to the number of tables
+//
+// templates are looked up by a caller-chosen key (tables derive it from
+// whatever determines their contents, eg. the random key they would be
+// initialized with) and by size
+//
+// NOTE:
+//     templates are created while holding the lock, so concurrent Map
+//     calls for a key that does not exist yet wait until it is filled
+//     (and Map calls for other keys wait as well)
+class PageTemplates {
+public:
+	PageTemplates(): mNumMappings(0) {}
+	~PageTemplates() { Clear(); }
+
+	// returns a private (copy-on-write) mapping of the template <key>,
+	// which is first created and filled by <source> if there is none;
+	// returns NULL if no template can be created or if the one for <key>
+	// is not <size> bytes; the mapping is released by munmap
+	void* Map(uint64_t key, size_t size, const IPageTemplateSource& source);
+
+	// existing mappings stay valid (the files are kept alive by them)
+	void Clear();
+
+	unsigned int GetNumTemplates() const { return (mTemplates.size()); }
+	unsigned int GetNumMappings() const { return mNumMappings; }
+
+private:
+	// non-copyable
+	PageTemplates(const PageTemplates&);
+	PageTemplates& operator = (const PageTemplates&);
+
+	static int CreateFile(size_t size, const IPageTemplateSource& source);
+
+private:
+	struct Template {
+		int fd;
+		size_t size;
+	};
+
+	std::map<uint64_t, Template> mTemplates;
+
+	unsigned int mNumMappings;
+
+	boost::mutex mMutex;
+};
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef RELAX_RANDOM_NUMBER_BUFFER_HDR
+#define RELAX_RANDOM_NUMBER_BUFFER_HDR
+
+#include <cassert>
+#include <cstddef>
+
+// serves random integers and floats from arrays that are refilled
+// in bulk (through TRNG::FillInts and TRNG::FillFlts) whenever they
+// run dry, so per-step consumers such as SelectAction only pay for
+// an index increment; it provides NextInt and NextFlt itself and can
+// be passed anywhere a generator is expected
+template<typename TRNG> class RandomNumberBuffer {
+public:
+	enum {
+		BUFFER_SIZE = 256,
+	};
+
+	// the buffered numbers and read-indices as plain values (what a
+	// checkpoint stores of a buffer; the source is not part of it)
+	struct State {
+		unsigned int ints[BUFFER_SIZE];
+		float flts[BUFFER_SIZE];
+
+		unsigned int intIndex;
+		unsigned int fltIndex;
+	};
+
+	RandomNumberBuffer(TRNG* rng = NULL) { SetSource(rng); }
+
+	void SetSource(TRNG* rng) {
+		mSource = rng;
+
+		// discard anything generated by a previous source
+		mIntIndex = BUFFER_SIZE;
+		mFltIndex = BUFFER_SIZE;
+	}
+
+	TRNG* GetSource() const { return mSource; }
+
+	void GetState(State* state) const {
+		for (unsigned int n = 0; n < BUFFER_SIZE; n++) {
+			state->ints[n] = mInts[n];
+			state->flts[n] = mFlts[n];
+		}
+
+		state->intIndex = mIntIndex;
+		state->fltIndex = mFltIndex;
+	}
+
+	// takes over the buffered numbers and read-indices of <state> but
+	// keeps our own source (used to restore checkpointed buffers)
+	void SetState(const State& state) {
+		for (unsigned int n = 0; n < BUFFER_SIZE; n++) {
+			mInts[n] = state.ints[n];
+			mFlts[n] = state.flts[n];
+		}
+
+		mIntIndex = state.intIndex;
+		mFltIndex = state.fltIndex;
+	}
+
+	unsigned int NextInt() {
+		if (mIntIndex == BUFFER_SIZE) {
+			assert(mSource != NULL);
+			mSource->FillInts(mInts, BUFFER_SIZE);
+			mIntIndex = 0;
+		}
+
+		return mInts[mIntIndex++];
+	}
+
+	double NextFlt() {
+		if (mFltIndex == BUFFER_SIZE) {
+			assert(mSource != NULL);
+			mSource->FillFlts(mFlts, BUFFER_SIZE);
+			mFltIndex = 0;
+		}
+
+		return mFlts[mFltIndex++];
+	}
+
+private:
+	TRNG* mSource;
+
+	unsigned int mInts[BUFFER_SIZE];
+	float mFlts[BUFFER_SIZE];
+
+	unsigned int mIntIndex;
+	unsigned int mFltIndex;
+};
+
+#endif
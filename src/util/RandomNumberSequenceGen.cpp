@@ -1,4 +1,10 @@
+#include <algorithm>
 #include <cstring> // for memset
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #include "RandomNumberSequenceGen.hpp"
 
 void MTRandomNumberSequenceGen::SeedGen(unsigned int s) {
@@ -25,3 +31,146 @@ void MTRandomNumberSequenceGen::GenState() {
 
 	state[N - 1] = state[M - 1] ^ Twiddle(state[N - 1], state[0]);
 }
+
+
+
+void XS128x4RandomNumberSequenceGen::SeedGen(unsigned int s) {
+	// expand the seed with SplitMix64 into 64 bits per state word
+	// pair; a lane can only end up all-zero with probability 2^-128
+	uint64_t z = s;
+
+	for (unsigned int lane = 0; lane < NUM_LANES; lane++) {
+		for (unsigned int k = 0; k < 4; k += 2) {
+			z += 0x9E3779B97F4A7C15ULL;
+
+			uint64_t x = z;
+			x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+			x = (x ^ (x >> 31));
+
+			state[k + 0][lane] = x & 0xFFFFFFFFUL;
+			state[k + 1][lane] = x >> 32;
+		}
+	}
+
+	index = NUM_LANES;
+}
+
+#ifdef __SSE2__
+static inline __m128i RotL32x4(__m128i x, int k) {
+	return (_mm_or_si128(_mm_slli_epi32(x, k), _mm_srli_epi32(x, 32 - k)));
+}
+
+void XS128x4RandomNumberSequenceGen::GenBlocks(unsigned int* buf, unsigned int numBlocks) {
+	__m128i s0 = _mm_load_si128(reinterpret_cast<const __m128i*>(state[0]));
+	__m128i s1 = _mm_load_si128(reinterpret_cast<const __m128i*>(state[1]));
+	__m128i s2 = _mm_load_si128(reinterpret_cast<const __m128i*>(state[2]));
+	__m128i s3 = _mm_load_si128(reinterpret_cast<const __m128i*>(state[3]));
+
+	for (unsigned int n = 0; n < numBlocks; n++) {
+		// r = rotl(s1 * 5, 7) * 9, multiplications as shift-and-add
+		const __m128i s1x5 = _mm_add_epi32(_mm_slli_epi32(s1, 2), s1);
+		const __m128i rotx = RotL32x4(s1x5, 7);
+		const __m128i r = _mm_add_epi32(_mm_slli_epi32(rotx, 3), rotx);
+		const __m128i t = _mm_slli_epi32(s1, 9);
+
+		s2 = _mm_xor_si128(s2, s0);
+		s3 = _mm_xor_si128(s3, s1);
+		s1 = _mm_xor_si128(s1, s2);
+		s0 = _mm_xor_si128(s0, s3);
+		s2 = _mm_xor_si128(s2, t);
+		s3 = RotL32x4(s3, 11);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(buf + n * NUM_LANES), r);
+	}
+
+	_mm_store_si128(reinterpret_cast<__m128i*>(state[0]), s0);
+	_mm_store_si128(reinterpret_cast<__m128i*>(state[1]), s1);
+	_mm_store_si128(reinterpret_cast<__m128i*>(state[2]), s2);
+	_mm_store_si128(reinterpret_cast<__m128i*>(state[3]), s3);
+}
+
+#else
+
+static inline unsigned int RotL32(unsigned int x, int k) {
+	return ((x << k) | (x >> (32 - k)));
+}
+
+void XS128x4RandomNumberSequenceGen::GenBlocks(unsigned int* buf, unsigned int numBlocks) {
+	for (unsigned int n = 0; n < numBlocks; n++) {
+		for (unsigned int lane = 0; lane < NUM_LANES; lane++) {
+			const unsigned int r = RotL32(state[1][lane] * 5, 7) * 9;
+			const unsigned int t = state[1][lane] << 9;
+
+			state[2][lane] ^= state[0][lane];
+			state[3][lane] ^= state[1][lane];
+			state[1][lane] ^= state[2][lane];
+			state[0][lane] ^= state[3][lane];
+			state[2][lane] ^= t;
+			state[3][lane] = RotL32(state[3][lane], 11);
+
+			buf[n * NUM_LANES + lane] = r;
+		}
+	}
+}
+#endif
+
+
+
+void XS128x4RandomNumberSequenceGen::FillInts(unsigned int* buf, unsigned int num) {
+	unsigned int n = 0;
+
+	// drain the current block first so the output sequence does
+	// not depend on how NextInt and Fill* calls are interleaved
+	for (; n < num && index < NUM_LANES; n++) {
+		buf[n] = block[index++];
+	}
+
+	const unsigned int numBlocks = (num - n) / NUM_LANES;
+
+	GenBlocks(buf + n, numBlocks);
+	n += (numBlocks * NUM_LANES);
+
+	for (; n < num; n++) {
+		buf[n] = NextInt();
+	}
+}
+
+void XS128x4RandomNumberSequenceGen::FillFlts(float* buf, unsigned int num) {
+	// generate in place (floats and uints have the same size), then
+	// convert the top 24 bits of each value like IntToFlt does
+	FillInts(reinterpret_cast<unsigned int*>(buf), num);
+
+	unsigned int n = 0;
+
+	#ifdef __SSE2__
+	const __m128 scale = _mm_set1_ps(1.0f / 16777216.0f);
+
+	for (; (n + 4) <= num; n += 4) {
+		const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + n));
+		const __m128 f = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(x, 8)), scale);
+
+		_mm_storeu_ps(buf + n, f);
+	}
+	#endif
+
+	for (; n < num; n++) {
+		unsigned int x = 0;
+		memcpy(&x, buf + n, sizeof(x));
+		buf[n] = INumberSequenceGen::IntToFlt(x);
+	}
+}
+
+void XS128x4RandomNumberSequenceGen::FillBernoulli(unsigned char* buf, unsigned int num, float p) {
+	unsigned int ints[256];
+
+	for (unsigned int n = 0; n < num; n += 256) {
+		const unsigned int k = std::min(num - n, 256U);
+
+		FillInts(ints, k);
+
+		for (unsigned int i = 0; i < k; i++) {
+			buf[n + i] = INumberSequenceGen::IntToBernoulli(ints[i], p);
+		}
+	}
+}
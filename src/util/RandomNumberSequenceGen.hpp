@@ -1,29 +1,52 @@
 #ifndef RELAX_RANDOM_NUMBER_SEQUENCE_GEN_HDR
 #define RELAX_RANDOM_NUMBER_SEQUENCE_GEN_HDR
 
+#include <stdint.h>
 #include "INumberSequenceGen.hpp"
 
+// NOTE:
+//     none of the generators below derive from INumberSequenceGen
+//     so that NextInt and NextFlt are plain inlinable calls; wrap
+//     them in a NumberSequenceGenAdapter where run-time dispatch is
+//     required
+// NOTE:
+//     the bulk Fill* functions of the scalar generators are simple
+//     loops (see FillScalar*); XS128x4RandomNumberSequenceGen is the
+//     vectorized generator meant for bulk use
+
+template<typename TRNG> inline void FillScalarInts(TRNG* rng, unsigned int* buf, unsigned int num) {
+	for (unsigned int n = 0; n < num; n++) {
+		buf[n] = rng->NextInt();
+	}
+}
+template<typename TRNG> inline void FillScalarFlts(TRNG* rng, float* buf, unsigned int num) {
+	for (unsigned int n = 0; n < num; n++) {
+		buf[n] = INumberSequenceGen::IntToFlt(rng->NextInt());
+	}
+}
+template<typename TRNG> inline void FillScalarBernoulli(TRNG* rng, unsigned char* buf, unsigned int num, float p) {
+	for (unsigned int n = 0; n < num; n++) {
+		buf[n] = INumberSequenceGen::IntToBernoulli(rng->NextInt(), p);
+	}
+}
+
+
 // Mersenne-Twister RNG: generates uniformly distributed 32-bit
 // random integers and normalized double-precision floating-point
 // numbers in the half-open interval [0, 1)
-class MTRandomNumberSequenceGen: public INumberSequenceGen {
+class MTRandomNumberSequenceGen {
 public:
 	// default constructor: uses default seed
 	MTRandomNumberSequenceGen() { SeedGen(5489UL); }
 	MTRandomNumberSequenceGen(unsigned int s) { SeedGen(s); }
-	MTRandomNumberSequenceGen(const MTRandomNumberSequenceGen& rng) { *this = rng; }
-
-	MTRandomNumberSequenceGen& operator = (const MTRandomNumberSequenceGen& rng) {
-		for (unsigned int n = 0; n < N; n++) {
-			state[n] = rng.state[n];
-		}
-		index = rng.index;
-		return *this;
-	}
 
 	unsigned int NextInt() { return GenNextValue(); }
 	double NextFlt() { return (GenNextValue() / RNG_MAX_VALUE); }
 
+	void FillInts(unsigned int* buf, unsigned int num) { FillScalarInts(this, buf, num); }
+	void FillFlts(float* buf, unsigned int num) { FillScalarFlts(this, buf, num); }
+	void FillBernoulli(unsigned char* buf, unsigned int num, float p) { FillScalarBernoulli(this, buf, num, p); }
+
 private:
 	unsigned int GenNextValue();
 	unsigned int Twiddle(unsigned int u, unsigned int v) const {
@@ -67,4 +90,141 @@ inline unsigned int MTRandomNumberSequenceGen::GenNextValue() {
 	return (x ^ (x >> 18));
 }
 
+
+
+// xoshiro256** RNG (Blackman & Vigna): 32 bytes of state, passes
+// BigCrush; the upper 32 bits of each 64-bit output are returned
+// by NextInt, the upper 53 bits are used to generate NextFlt
+class XS256RandomNumberSequenceGen {
+public:
+	XS256RandomNumberSequenceGen() { SeedGen(5489UL); }
+	XS256RandomNumberSequenceGen(unsigned int s) { SeedGen(s); }
+
+	unsigned int NextInt() { return (GenNextValue() >> 32); }
+	double NextFlt() { return ((GenNextValue() >> 11) * (1.0 / 9007199254740992.0)); }
+
+	void FillInts(unsigned int* buf, unsigned int num) { FillScalarInts(this, buf, num); }
+	void FillFlts(float* buf, unsigned int num) { FillScalarFlts(this, buf, num); }
+	void FillBernoulli(unsigned char* buf, unsigned int num, float p) { FillScalarBernoulli(this, buf, num, p); }
+
+private:
+	static uint64_t RotL(uint64_t x, unsigned int k) { return ((x << k) | (x >> (64 - k))); }
+
+	void SeedGen(unsigned int s) {
+		// expand the 32-bit seed with SplitMix64, which cannot
+		// produce the (forbidden) all-zero xoshiro state
+		uint64_t z = s;
+
+		for (unsigned int n = 0; n < 4; n++) {
+			z += 0x9E3779B97F4A7C15ULL;
+
+			uint64_t x = z;
+			x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+			state[n] = x ^ (x >> 31);
+		}
+	}
+
+	uint64_t GenNextValue() {
+		const uint64_t r = RotL(state[1] * 5, 7) * 9;
+		const uint64_t t = state[1] << 17;
+
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= t;
+		state[3] = RotL(state[3], 45);
+
+		return r;
+	}
+
+private:
+	uint64_t state[4];
+};
+
+
+
+// PCG32 RNG (O'Neill, XSH-RR variant): 16 bytes of state, one
+// 64-bit LCG step plus a permutation of the old state per value
+class PCGRandomNumberSequenceGen {
+public:
+	PCGRandomNumberSequenceGen() { SeedGen(5489UL); }
+	PCGRandomNumberSequenceGen(unsigned int s) { SeedGen(s); }
+
+	unsigned int NextInt() { return GenNextValue(); }
+	double NextFlt() { return (GenNextValue() * (1.0 / 4294967296.0)); }
+
+	void FillInts(unsigned int* buf, unsigned int num) { FillScalarInts(this, buf, num); }
+	void FillFlts(float* buf, unsigned int num) { FillScalarFlts(this, buf, num); }
+	void FillBernoulli(unsigned char* buf, unsigned int num, float p) { FillScalarBernoulli(this, buf, num, p); }
+
+private:
+	void SeedGen(unsigned int s) {
+		state = 0;
+		incr = (static_cast<uint64_t>(s) << 1) | 1; // stream, must be odd
+
+		GenNextValue();
+		state += 0x853C49E6748FEA9BULL;
+		GenNextValue();
+	}
+
+	unsigned int GenNextValue() {
+		const uint64_t oldState = state;
+		const unsigned int xorShifted = ((oldState >> 18) ^ oldState) >> 27;
+		const unsigned int rotation = oldState >> 59;
+
+		state = oldState * 6364136223846793005ULL + incr;
+		return ((xorShifted >> rotation) | (xorShifted << ((-rotation) & 31)));
+	}
+
+private:
+	uint64_t state;
+	uint64_t incr;
+};
+
+
+
+// NUM_LANES interleaved xoshiro128** generators advanced in lock-step
+// (with SSE2 if available, otherwise by a scalar loop that produces
+// the same values); every step yields a block of NUM_LANES values in
+// lane-order, which the Fill* functions write directly into the user
+// buffer so bulk requests cost a fraction of a cycle per value
+class XS128x4RandomNumberSequenceGen {
+public:
+	enum {
+		NUM_LANES = 4,
+	};
+
+	XS128x4RandomNumberSequenceGen() { SeedGen(5489UL); }
+	XS128x4RandomNumberSequenceGen(unsigned int s) { SeedGen(s); }
+
+	unsigned int NextInt() {
+		if (index == NUM_LANES) {
+			GenBlocks(block, 1);
+			index = 0;
+		}
+
+		return block[index++];
+	}
+	double NextFlt() { return (NextInt() * (1.0 / 4294967296.0)); }
+
+	void FillInts(unsigned int* buf, unsigned int num);
+	void FillFlts(float* buf, unsigned int num);
+	void FillBernoulli(unsigned char* buf, unsigned int num, float p);
+
+private:
+	void SeedGen(unsigned int);
+	// writes <numBlocks> * NUM_LANES values to <buf>
+	void GenBlocks(unsigned int* buf, unsigned int numBlocks);
+
+private:
+	// state words of each lane, stored as state[word][lane]
+	unsigned int state[4][NUM_LANES] __attribute__((aligned(16)));
+
+	// current (partially consumed) block and read-index into it
+	unsigned int block[NUM_LANES];
+	unsigned int index;
+};
+
 #endif
@@ -0,0 +1,161 @@
+#include <cstdio>
+#include "../Defines.hpp"
+
+// compares the cost of drawing random numbers through the virtual
+// INumberSequenceGen interface with that of the concrete generators
+// (one at a time, in bulk, and inside the QLearning episode loop
+// where they are consumed through a RandomNumberBuffer); build with
+//
+//   g++ -O2 -DRELAX_RNG_BENCHMARK -o rngbench  util/*.cpp tasks/*.cpp learners/*.cpp  -llua5.1 ...
+//
+#ifdef RELAX_RNG_BENCHMARK
+#include <lua5.1/lua.hpp>
+
+#include "LuaParser.hpp"
+#include "RandomNumberSequenceGen.hpp"
+#include "Timer.hpp"
+#include "../learners/QLearning.hpp"
+#include "../tasks/SingleCorridorMaze.hpp"
+
+using namespace RELAX;
+
+typedef Tasks::SingleCorridorMaze TTask;
+typedef TTask::Action TAction;
+
+static const unsigned int NUM_RNG_VALUES = 100000000;
+static const unsigned int NUM_EPISODES = 20000;
+
+static unsigned long gNumSteps = 0;
+
+// the task's state, counting every action applied to it; rewards are
+// not uniform (moving up or down a row costs more than moving along
+// it), so the number of steps cannot be derived from episode rewards
+struct TState: public TTask::State {
+public:
+	TState() {}
+	TState(const TTask::State& state): TTask::State(state) {}
+
+	TState ApplyAction(const TAction& action, float* reward) {
+		gNumSteps += 1;
+		return (TTask::State::ApplyAction(action, reward));
+	}
+};
+
+template<typename TRNG> void BenchGenerator(const char* name, TRNG* rng) {
+	Timer timer;
+	unsigned int sum = 0;
+
+	for (unsigned int n = 0; n < NUM_RNG_VALUES; n++) {
+		sum += rng->NextInt();
+	}
+
+	const double secs = timer.GetElapsedSecs();
+	printf("[%s] %-28s %8.2f M values/sec (checksum %u)\n", __FUNCTION__, name, (NUM_RNG_VALUES / secs) * 1e-6, sum);
+}
+
+template<typename TRNG> void BenchGeneratorBulk(const char* name, TRNG* rng) {
+	static unsigned int ints[1024];
+	static float flts[1024];
+
+	Timer timer;
+	unsigned int sum = 0;
+
+	for (unsigned int n = 0; n < NUM_RNG_VALUES; n += 1024) {
+		rng->FillInts(ints, 1024);
+		sum += ints[n & 1023];
+	}
+
+	const double intSecs = timer.GetElapsedSecs();
+	timer.Reset();
+
+	for (unsigned int n = 0; n < NUM_RNG_VALUES; n += 1024) {
+		rng->FillFlts(flts, 1024);
+		sum += (flts[n & 1023] >= 0.5f);
+	}
+
+	const double fltSecs = timer.GetElapsedSecs();
+	printf("[%s] %-28s %8.2f M ints/sec, %8.2f M floats/sec (checksum %u)\n", __FUNCTION__, name, (NUM_RNG_VALUES / intSecs) * 1e-6, (NUM_RNG_VALUES / fltSecs) * 1e-6, sum);
+}
+
+template<typename TRNG> void BenchLearner(const char* name, TRNG* rng, const Learners::TDLearnerParameters& params) {
+	Learners::QLearning<TState, TAction, TRNG> learner(params);
+
+	learner.SetInitialState(TState());
+	learner.SetNumberSequenceGen(rng);
+	learner.Initialize(rng, false);
+
+	gNumSteps = 0;
+
+	Timer timer;
+
+	for (unsigned int n = 0; n < NUM_EPISODES; n++) {
+		learner.ExecuteEpisode(NULL);
+	}
+
+	const double secs = timer.GetElapsedSecs();
+	const unsigned long numSteps = gNumSteps;
+
+	printf("[%s] %-28s %8.2f M steps/sec\n", __FUNCTION__, name, (numSteps / secs) * 1e-6);
+}
+
+int main() {
+	lua_State* luaState = lua_open();
+	LuaParser luaParser(luaState);
+
+	if (!luaParser.Execute("return {numRows = 1, numCols = 100000}", false)) {
+		printf("[%s] error: %s\n", __FUNCTION__, (luaParser.GetError()).c_str());
+		return 1;
+	}
+
+	TTask::GetInstance().Initialize(luaParser.GetRootTbl());
+
+	Learners::TDLearnerParameters params;
+	params.SetMaxActions(1000);
+	params.SetAlpha(0.1f);
+	params.SetGamma(0.99f);
+	params.SetEpsilon(0.333f);
+	params.SetAlphaDecay(1.0f);
+	params.SetEpsilonDecay(1.0f);
+	params.SetRandomizeInitialStates(true);
+
+	{
+		NumberSequenceGenAdapter<MTRandomNumberSequenceGen> mtv(1234);
+		NumberSequenceGenAdapter<XS256RandomNumberSequenceGen> xsv(1234);
+		MTRandomNumberSequenceGen mt(1234);
+		XS256RandomNumberSequenceGen xs(1234);
+		PCGRandomNumberSequenceGen pcg(1234);
+		XS128x4RandomNumberSequenceGen xs4(1234);
+
+		BenchGenerator<INumberSequenceGen>("MT19937 (virtual)", &mtv);
+		BenchGenerator<INumberSequenceGen>("xoshiro256** (virtual)", &xsv);
+		BenchGenerator("MT19937", &mt);
+		BenchGenerator("xoshiro256**", &xs);
+		BenchGenerator("PCG32", &pcg);
+		BenchGenerator("xoshiro128**x4", &xs4);
+
+		BenchGeneratorBulk("MT19937", &mt);
+		BenchGeneratorBulk("xoshiro256**", &xs);
+		BenchGeneratorBulk("PCG32", &pcg);
+		BenchGeneratorBulk("xoshiro128**x4", &xs4);
+	}
+	{
+		NumberSequenceGenAdapter<MTRandomNumberSequenceGen> mtv(1234);
+		NumberSequenceGenAdapter<XS256RandomNumberSequenceGen> xsv(1234);
+		MTRandomNumberSequenceGen mt(1234);
+		XS256RandomNumberSequenceGen xs(1234);
+		PCGRandomNumberSequenceGen pcg(1234);
+		XS128x4RandomNumberSequenceGen xs4(1234);
+
+		BenchLearner<INumberSequenceGen>("MT19937 (virtual)", &mtv, params);
+		BenchLearner<INumberSequenceGen>("xoshiro256** (virtual)", &xsv, params);
+		BenchLearner("MT19937", &mt, params);
+		BenchLearner("xoshiro256**", &xs, params);
+		BenchLearner("PCG32", &pcg, params);
+		BenchLearner("xoshiro128**x4", &xs4, params);
+	}
+
+	lua_close(luaState);
+	return 0;
+}
+
+#endif
@@ -0,0 +1,11 @@
+#include "RandomNumberStreams.hpp"
+
+unsigned int RandomNumberStreams::GetStreamSeed(unsigned int group, unsigned int index, unsigned int role) const {
+	// pack the stream coordinates into one counter value (the
+	// master seed is the key) and take the top 32 bits of its
+	// hash; group and role are small, the index gets 32 bits
+	const uint64_t streamKey = static_cast<uint64_t>(mMasterSeed);
+	const uint64_t streamCtr = (static_cast<uint64_t>(group & 0xFFFF) << 48) | (static_cast<uint64_t>(role & 0xFFFF) << 32) | index;
+
+	return (CBRandomNumberSequenceGen::Hash(streamKey, streamCtr) >> 32);
+}
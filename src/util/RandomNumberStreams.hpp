@@ -0,0 +1,63 @@
+#ifndef RELAX_RANDOM_NUMBER_STREAMS_HDR
+#define RELAX_RANDOM_NUMBER_STREAMS_HDR
+
+#include <stdint.h>
+#include "INumberSequenceGen.hpp"
+
+// counter-based RNG: the n-th value of the stream identified by
+// <key> is a pure function of (key, n), so any number of streams
+// can be created (and consumed) in any order without affecting
+// each other
+class CBRandomNumberSequenceGen: public INumberSequenceGen {
+public:
+	CBRandomNumberSequenceGen(uint64_t key = 0): mKey(key), mCounter(0) {}
+
+	unsigned int NextInt() { return (Hash(mKey, mCounter++) >> 32); }
+	double NextFlt() { return (NextInt() / 4294967296.0); }
+
+	// 64-bit finalizer (SplitMix64) applied to a key-offset counter
+	static uint64_t Hash(uint64_t key, uint64_t ctr) {
+		uint64_t z = key + (ctr + 1) * 0x9E3779B97F4A7C15ULL;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return (z ^ (z >> 31));
+	}
+
+private:
+	uint64_t mKey;
+	uint64_t mCounter;
+};
+
+
+
+// derives the seeds for all RNG's used in an experiment from one
+// master seed, such that the stream handed to (group, index, role)
+// never depends on how many other streams exist or in which order
+// they are requested (or on which thread they are later consumed)
+class RandomNumberStreams {
+public:
+	enum {
+		STREAM_GROUP_TASK   = 0, // task-level randomness (eg. chosen states)
+		STREAM_GROUP_RANDOM = 1, // RANDOM policies and their learners
+		STREAM_GROUP_CHOSEN = 2, // CHOSEN policies and their learners
+	};
+	enum {
+		STREAM_ROLE_INIT = 0, // initializes Q, PI and the initial learner state
+		STREAM_ROLE_EVAL = 1, // drives learning episodes and evaluation trials
+	};
+
+	RandomNumberStreams(unsigned int masterSeed): mMasterSeed(masterSeed) {}
+
+	unsigned int GetMasterSeed() const { return mMasterSeed; }
+	unsigned int GetStreamSeed(unsigned int group, unsigned int index, unsigned int role) const;
+
+	// caller owns the returned generator
+	template<typename TRNG> TRNG* NewStreamGen(unsigned int group, unsigned int index, unsigned int role) const {
+		return (new TRNG(GetStreamSeed(group, index, role)));
+	}
+
+private:
+	unsigned int mMasterSeed;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#include <cstdio>
+
+#include "RewardTraces.hpp"
+#include "BinaryFile.hpp"
+
+bool RewardTraces::Save(const std::string& fileName, const std::string& taskName) const {
+	BinaryFile::Header header;
+	BinaryFile::InitHeader(&header, BinaryFile::CONTENT_REWARD_TRACES, BinaryFile::DTYPE_FLOAT32, BinaryFile::LAYOUT_POLICY_ROWS, taskName);
+
+	header.numStates = mInfo.numShardRandomPolicies + mInfo.numShardChosenPolicies;
+	header.numActions = GetTraceLength();
+	header.numSections = NUM_SECTIONS;
+
+	const void* sections[NUM_SECTIONS] = {
+		&mInfo,
+		mRandomTraces.empty()? NULL: &mRandomTraces[0],
+		mChosenTraces.empty()? NULL: &mChosenTraces[0],
+	};
+	const uint64_t sectionSizes[NUM_SECTIONS] = {
+		sizeof(Info),
+		mRandomTraces.size() * sizeof(float),
+		mChosenTraces.size() * sizeof(float),
+	};
+
+	return (BinaryFile::Write(fileName, &header, sections, sectionSizes));
+}
+
+bool RewardTraces::Load(const std::string& fileName, const std::string& taskName) {
+	BinaryFile::Header header;
+
+	void* data = NULL;
+	size_t size = 0;
+
+	// traces are read once and copied, so always verify them
+	if (!BinaryFile::Map(fileName, &header, &data, &size, true)) {
+		return false;
+	}
+
+	bool ok = BinaryFile::CheckContent(fileName, header, BinaryFile::CONTENT_REWARD_TRACES, BinaryFile::DTYPE_FLOAT32, BinaryFile::LAYOUT_POLICY_ROWS, taskName);
+
+	if (ok && (header.numSections != NUM_SECTIONS || header.sectionSizes[SECTION_INFO] != sizeof(Info))) {
+		printf("[RewardTraces::%s] \"%s\": unexpected sections\n", __FUNCTION__, fileName.c_str());
+		ok = false;
+	}
+
+	if (ok) {
+		memcpy(&mInfo, static_cast<const char*>(data) + header.sectionOffsets[SECTION_INFO], sizeof(Info));
+		Resize();
+
+		if (header.sectionSizes[SECTION_RANDOM_TRACES] != (mRandomTraces.size() * sizeof(float)) || header.sectionSizes[SECTION_CHOSEN_TRACES] != (mChosenTraces.size() * sizeof(float))) {
+			printf("[RewardTraces::%s] \"%s\": trace sizes do not match\n", __FUNCTION__, fileName.c_str());
+			ok = false;
+		}
+	}
+
+	if (ok) {
+		if (!mRandomTraces.empty()) { memcpy(&mRandomTraces[0], static_cast<const char*>(data) + header.sectionOffsets[SECTION_RANDOM_TRACES], mRandomTraces.size() * sizeof(float)); }
+		if (!mChosenTraces.empty()) { memcpy(&mChosenTraces[0], static_cast<const char*>(data) + header.sectionOffsets[SECTION_CHOSEN_TRACES], mChosenTraces.size() * sizeof(float)); }
+	}
+
+	BinaryFile::Unmap(data, size);
+	return ok;
+}
+
+void RewardTraces::Resize() {
+	mRandomTraces.assign(mInfo.numShardRandomPolicies * GetTraceLength(), 0.0f);
+	mChosenTraces.assign(mInfo.numShardChosenPolicies * GetTraceLength(), 0.0f);
+}
@@ -0,0 +1,82 @@
+#ifndef RELAX_REWARDTRACES_HDR
+#define RELAX_REWARDTRACES_HDR
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// the reward traces of the policies one shard of a sharded experiment
+// learned and evaluated (see Main): per policy, the reward of every
+// learning episode followed by the reward of every evaluation trial,
+// plus which policies (out of how many) the shard ran, so that shards
+// can be merged in any order; stored as a BinaryFile with one section
+// for the Info and one per kind of policy
+class RewardTraces {
+public:
+	enum {
+		SECTION_INFO          = 0,
+		SECTION_RANDOM_TRACES = 1,
+		SECTION_CHOSEN_TRACES = 2,
+		NUM_SECTIONS          = 3,
+	};
+
+	struct Info {
+		uint32_t shardIdx;
+		uint32_t numShards;
+
+		// in the whole experiment
+		uint32_t numRandomPolicies;
+		uint32_t numChosenPolicies;
+
+		// run by this shard
+		uint32_t firstRandomPolicy;
+		uint32_t numShardRandomPolicies;
+		uint32_t firstChosenPolicy;
+		uint32_t numShardChosenPolicies;
+
+		uint32_t numLearningEpisodes;
+		uint32_t numEvaluationTrials;
+
+		uint32_t weakBaseLine;
+
+		// every shard of one experiment must have been run with the same
+		// master seed and parameters (see MergeBaseLineTestShards)
+		uint32_t masterRNGSeed;
+		uint64_t parametersHash;
+
+		// as planned under the shard's memory budget (see Main)
+		uint32_t pruneStates;
+		uint32_t storageMode;
+		uint32_t quantizedRounding;
+		uint32_t reserved;
+	};
+
+	RewardTraces() { memset(&mInfo, 0, sizeof(mInfo)); }
+
+	bool Save(const std::string& fileName, const std::string& taskName) const;
+	bool Load(const std::string& fileName, const std::string& taskName);
+
+	// sizes the traces for the policies and lengths set in the Info
+	void Resize();
+
+	Info& GetInfo() { return mInfo; }
+	const Info& GetInfo() const { return mInfo; }
+
+	// trace of the <n>-th random (chosen) policy of this shard, which
+	// is policy firstRandomPolicy + n (firstChosenPolicy + n) overall
+	float* GetRandomTrace(unsigned int n) { return &mRandomTraces[n * GetTraceLength()]; }
+	float* GetChosenTrace(unsigned int n) { return &mChosenTraces[n * GetTraceLength()]; }
+	const float* GetRandomTrace(unsigned int n) const { return &mRandomTraces[n * GetTraceLength()]; }
+	const float* GetChosenTrace(unsigned int n) const { return &mChosenTraces[n * GetTraceLength()]; }
+
+	unsigned int GetTraceLength() const { return (mInfo.numLearningEpisodes + mInfo.numEvaluationTrials); }
+
+private:
+	Info mInfo;
+
+	std::vector<float> mRandomTraces;
+	std::vector<float> mChosenTraces;
+};
+
+#endif
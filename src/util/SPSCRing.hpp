@@ -0,0 +1,90 @@
+#ifndef RELAX_SPSC_RING_HDR
+#define RELAX_SPSC_RING_HDR
+
+#include <algorithm>
+#include <vector>
+
+// bounded queue between exactly one producer thread (Push) and one
+// consumer thread (Pop); neither side locks or waits, a full (empty)
+// ring simply makes Push (Pop) fail, leaving it to the caller to try
+// again; the capacity is rounded up to a power of two
+//
+// the read- and write-positions only ever grow (wrapping around as
+// unsigned integers) and each is written by one side only, so a
+// release-store of one paired with an acquire-load by the other side
+// is all the synchronization needed
+template<typename T> class SPSCRing {
+public:
+	SPSCRing(unsigned int capacity = 1024): mHead(0), mTail(0) {
+		unsigned int size = 1;
+
+		while (size < capacity) {
+			size <<= 1;
+		}
+
+		mItems.resize(size);
+		mMask = size - 1;
+	}
+
+	// producer only; returns false if the ring is full
+	bool Push(const T& item) {
+		const unsigned int tail = mTail;
+		const unsigned int head = __atomic_load_n(&mHead, __ATOMIC_ACQUIRE);
+
+		if ((tail - head) > mMask)
+			return false;
+
+		mItems[tail & mMask] = item;
+
+		__atomic_store_n(&mTail, tail + 1, __ATOMIC_RELEASE);
+		return true;
+	}
+
+	// consumer only; moves up to <maxItems> items to <items> and
+	// returns how many it moved (zero if the ring is empty)
+	unsigned int Pop(T* items, unsigned int maxItems) {
+		const unsigned int head = mHead;
+		const unsigned int tail = __atomic_load_n(&mTail, __ATOMIC_ACQUIRE);
+		const unsigned int numItems = std::min(tail - head, maxItems);
+
+		for (unsigned int n = 0; n < numItems; n++) {
+			items[n] = mItems[(head + n) & mMask];
+		}
+
+		__atomic_store_n(&mHead, head + numItems, __ATOMIC_RELEASE);
+		return numItems;
+	}
+
+	// exact only when called from either side while the other is idle,
+	// otherwise a snapshot that may already be out of date
+	unsigned int GetSize() const {
+		const unsigned int head = __atomic_load_n(&mHead, __ATOMIC_ACQUIRE);
+		const unsigned int tail = __atomic_load_n(&mTail, __ATOMIC_ACQUIRE);
+
+		return (tail - head);
+	}
+	unsigned int GetCapacity() const { return (mMask + 1); }
+
+private:
+	// non-copyable, the positions are shared between two threads
+	SPSCRing(const SPSCRing&);
+	SPSCRing& operator = (const SPSCRing&);
+
+private:
+	enum {
+		CACHE_LINE_SIZE = 64,
+	};
+
+	// the consumer writes mHead and the producer mTail, so each gets
+	// its own cache-line to keep the two sides from sharing one
+	unsigned int mHead;
+	char mHeadPadding[CACHE_LINE_SIZE - sizeof(unsigned int)];
+	unsigned int mTail;
+	char mTailPadding[CACHE_LINE_SIZE - sizeof(unsigned int)];
+
+	unsigned int mMask;
+
+	std::vector<T> mItems;
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define RELAX_STATESPACEGRAPH_HDR
 
 #include <cassert>
+#include <cstddef>
 #include <list>
 #include <map>
 #include <vector>
@@ -42,6 +43,16 @@ namespace RELAX {
 			}
 
 
+			// approximate size in bytes of a graph of the task (a map node
+			// per state plus one edge per action of each state, terminal
+			// states have none but are counted as well)
+			static size_t EstimateSize() {
+				const size_t numStates = TState::GetMaxID() + 1;
+				const size_t numActions = TAction::GetMaxID() + 1;
+
+				return (numStates * (sizeof(typename EdgeMap::value_type) + 4 * sizeof(void*) + numActions * sizeof(unsigned int)));
+			}
+
 			void Initialize() {
 				const unsigned int numStates = TState::GetMaxID() + 1;
 				const unsigned int numActions = TAction::GetMaxID() + 1;
@@ -153,6 +164,50 @@ namespace RELAX {
 				}
 			}
 
+			// marks (in <states>, indexed by state ID) every non-terminal
+			// state reachable through zero or more actions from any of the
+			// states in <startIDs>; states are expanded from the edges of
+			// their ID's representative (see Initialize), which is exact
+			// for discrete tasks and an approximation for tasks with a
+			// continuous state discretized into IDs
+			unsigned int GetReachableStates(const std::vector<unsigned int>& startIDs, std::vector<bool>& states) const {
+				std::vector<unsigned int> stateIDQueue;
+				unsigned int numStates = 0;
+
+				states.clear();
+				states.resize(TState::GetMaxID() + 1, false);
+
+				for (unsigned int n = 0; n < startIDs.size(); n++) {
+					stateIDQueue.push_back(startIDs[n]);
+				}
+
+				// depth-first, the order does not matter
+				while (!stateIDQueue.empty()) {
+					const unsigned int stateID = stateIDQueue.back();
+					const EdgeMap::const_iterator edgesIt = mEdgeMap.find(stateID);
+
+					stateIDQueue.pop_back();
+
+					assert(edgesIt != mEdgeMap.end());
+
+					// terminal states have no outgoing edges
+					if (states[stateID] || (edgesIt->second).empty()) {
+						continue;
+					}
+
+					states[stateID] = true;
+					numStates += 1;
+
+					for (unsigned int n = 0; n < (edgesIt->second).size(); n++) {
+						if (!states[(edgesIt->second)[n]]) {
+							stateIDQueue.push_back((edgesIt->second)[n]);
+						}
+					}
+				}
+
+				return numStates;
+			}
+
 			float GetAverageDensity(const float maxDistance) {
 				const unsigned int numStates = TState::GetMaxID() + 1;
 
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <cassert>
+
+#include <boost/bind/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "ThreadPool.hpp"
+#include "IThreadPoolJob.hpp"
+
+static bool CompareJobCosts(const IThreadPoolJob* a, const IThreadPoolJob* b) {
+	return (a->GetCost() > b->GetCost());
+}
+
+
+
+ThreadPool::ThreadPool(unsigned int numThreads) {
+	mNumThreads = std::max(numThreads, 1U);
+	mNumStolenJobs = 0;
+
+	for (unsigned int n = 0; n < mNumThreads; n++) {
+		mWorkerQueues.push_back(new WorkerQueue());
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	for (unsigned int n = 0; n < mWorkerQueues.size(); n++) {
+		delete mWorkerQueues[n];
+	}
+
+	mWorkerQueues.clear();
+	mPendingJobs.clear();
+}
+
+unsigned int ThreadPool::GetDefaultNumThreads() {
+	return (std::max(boost::thread::hardware_concurrency(), 1U));
+}
+
+
+
+void ThreadPool::Execute() {
+	// longest-processing-time-first: after a stable sort on cost,
+	// deal the jobs out round-robin so that every worker starts
+	// with (one of) the longest remaining jobs and the short ones
+	// are left at the back of each queue as stealing material
+	std::stable_sort(mPendingJobs.begin(), mPendingJobs.end(), CompareJobCosts);
+
+	for (unsigned int n = 0; n < mPendingJobs.size(); n++) {
+		mWorkerQueues[n % mNumThreads]->jobs.push_back(mPendingJobs[n]);
+	}
+
+	mPendingJobs.clear();
+
+	if (mNumThreads == 1) {
+		WorkerThread(0);
+		return;
+	}
+
+	boost::thread_group workers;
+
+	for (unsigned int n = 1; n < mNumThreads; n++) {
+		workers.create_thread(boost::bind(&ThreadPool::WorkerThread, this, n));
+	}
+
+	WorkerThread(0);
+	workers.join_all();
+}
+
+void ThreadPool::WorkerThread(unsigned int workerIdx) {
+	IThreadPoolJob* job = NULL;
+
+	// NOTE:
+	//     no new jobs can be added during Execute, so once our
+	//     own queue is empty and every steal attempt fails all
+	//     remaining work is already claimed and we can exit
+	while ((job = PopJob(workerIdx)) != NULL || (job = StealJob(workerIdx)) != NULL) {
+		job->Execute();
+	}
+}
+
+
+
+IThreadPoolJob* ThreadPool::PopJob(unsigned int workerIdx) {
+	WorkerQueue* queue = mWorkerQueues[workerIdx];
+	IThreadPoolJob* job = NULL;
+
+	boost::mutex::scoped_lock lock(queue->mutex);
+
+	if (!queue->jobs.empty()) {
+		job = queue->jobs.front();
+		queue->jobs.pop_front();
+	}
+
+	return job;
+}
+
+IThreadPoolJob* ThreadPool::StealJob(unsigned int workerIdx) {
+	IThreadPoolJob* job = NULL;
+
+	// visit the other workers in a fixed order starting from
+	// our right-hand neighbor, take from the back of a queue
+	// (the owner keeps consuming from the front)
+	for (unsigned int n = 1; n < mNumThreads && job == NULL; n++) {
+		WorkerQueue* queue = mWorkerQueues[(workerIdx + n) % mNumThreads];
+
+		boost::mutex::scoped_lock lock(queue->mutex);
+
+		if (!queue->jobs.empty()) {
+			job = queue->jobs.back();
+			queue->jobs.pop_back();
+		}
+	}
+
+	if (job != NULL) {
+		boost::mutex::scoped_lock lock(mStealCountMutex);
+		mNumStolenJobs += 1;
+	}
+
+	return job;
+}
@@ -0,0 +1,54 @@
+#ifndef RELAX_THREADPOOL_HDR
+#define RELAX_THREADPOOL_HDR
+
+#include <deque>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+class IThreadPoolJob;
+
+// executes a batch of independent jobs on a fixed number of
+// worker threads; jobs are handed out longest-first and any
+// worker that runs out of its own jobs steals from the others
+//
+// NOTE: the calling thread acts as worker 0, so with only one
+// thread every job is executed serially (and in cost-order)
+class ThreadPool {
+public:
+	ThreadPool(unsigned int numThreads);
+	~ThreadPool();
+
+	// jobs are not owned by the pool (caller must free them)
+	void AddJob(IThreadPoolJob* job) { mPendingJobs.push_back(job); }
+	// runs all jobs added so far, blocks until all are done
+	void Execute();
+
+	unsigned int GetNumThreads() const { return mNumThreads; }
+	unsigned int GetNumStolenJobs() const { return mNumStolenJobs; }
+
+	// number of threads to use if the user did not specify any
+	static unsigned int GetDefaultNumThreads();
+
+private:
+	struct WorkerQueue {
+		boost::mutex mutex;
+		std::deque<IThreadPoolJob*> jobs;
+	};
+
+	void WorkerThread(unsigned int workerIdx);
+
+	IThreadPoolJob* PopJob(unsigned int workerIdx);
+	IThreadPoolJob* StealJob(unsigned int workerIdx);
+
+private:
+	std::vector<IThreadPoolJob*> mPendingJobs;
+	std::vector<WorkerQueue*> mWorkerQueues;
+
+	boost::mutex mStealCountMutex;
+
+	unsigned int mNumThreads;
+	unsigned int mNumStolenJobs;
+};
+
+#endif
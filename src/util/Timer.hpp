@@ -0,0 +1,24 @@
+#ifndef RELAX_TIMER_HDR
+#define RELAX_TIMER_HDR
+
+#include <time.h>
+
+// wall-clock stopwatch based on the monotonic system clock
+class Timer {
+public:
+	Timer() { Reset(); }
+
+	void Reset() { clock_gettime(CLOCK_MONOTONIC, &mStartTime); }
+
+	double GetElapsedSecs() const {
+		struct timespec currTime;
+		clock_gettime(CLOCK_MONOTONIC, &currTime);
+
+		return ((currTime.tv_sec - mStartTime.tv_sec) + (currTime.tv_nsec - mStartTime.tv_nsec) * 1e-9);
+	}
+
+private:
+	struct timespec mStartTime;
+};
+
+#endif